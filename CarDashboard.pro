@@ -34,9 +34,19 @@ SOURCES += main.cpp \
     rowdata.cpp \
     orientation.cpp\
     radialbar.cpp \
-    bluetoothmodule.cpp
+    bluetoothmodule.cpp \
+    connectionsupervisor.cpp \
+    src/adapter_caps.c \
+    src/obd2_core.c
 OTHER_FILES += qml/*.qml
 
+# The channel template parser maps files and uses memmem; other targets
+# poll the built-in PID list
+unix {
+    SOURCES += src/log_template.c
+    DEFINES += HAVE_LOG_TEMPLATE
+}
+
 android {
     ANDROID_PACKAGE_SOURCE_DIR = $$PWD/android
     OTHER_FILES += android/AndroidManifest.xml       android/build.gradle
@@ -66,7 +76,10 @@ HEADERS += \
     rowdata.h \
     orientation.h\
     radialbar.h \
-    bluetoothmodule.h
+    bluetoothmodule.h \
+    connectionsupervisor.h
+
+INCLUDEPATH += $$PWD/include
 
 #INCLUDEPATH += $$PWD/Serial
 #include(Serial/Serial.pri)
@@ -699,9 +699,19 @@ void BluetoothModule::onStart()
 
     startDiscovery();
 
-    pidList
-            <<"33 46 49 0C 3C"
-           <<"0D 04 05 0F 13 2F ";
+    pidList = ConnectionSupervisor::templatePidList("logger.a2l");
+    if (pidList.isEmpty())
+        pidList
+                <<"33 46 49 0C 3C"
+               <<"0D 04 05 0F 13 2F ";
+
+    supervisor = new ConnectionSupervisor("bluetooth", this);
+    connect(supervisor, SIGNAL(connectRequested()), this, SLOT(openSocket()));
+    connect(supervisor, SIGNAL(disconnectRequested()), this, SLOT(closeSocket()));
+    connect(supervisor, SIGNAL(writeCommand(QString)), this, SLOT(writeCommand(QString)));
+    connect(supervisor, SIGNAL(initialized()), timer, SLOT(start()));
+    connect(supervisor, SIGNAL(linkStatus(bool)), this, SIGNAL(linkStatus(bool)));
+    connect(supervisor, SIGNAL(outageReported(qint64)), this, SIGNAL(outageReported(qint64)));
 
 
 
@@ -758,29 +768,75 @@ void BluetoothModule::deviceSelected(int i)
 {
     QBluetoothDeviceInfo selectedDevice = listOfDevices.at(i);
 
-    socket = new QBluetoothSocket(QBluetoothServiceInfo::RfcommProtocol, this);
+    deviceAddress = selectedDevice.address();
+    supervisor->start();
+}
 
-    socket->connectToService(QBluetoothAddress(selectedDevice.address()),
-                             QBluetoothUuid(QBluetoothUuid::SerialPort));
+void BluetoothModule::openSocket()
+{
+    closeSocket();
+
+    supervisor->setAdapter(deviceAddress.toString());
+
+    socket = new QBluetoothSocket(QBluetoothServiceInfo::RfcommProtocol, this);
 
-    //connect(socket, SIGNAL(error(QBluetoothSocket::SocketError)),this, SLOT(socketError(QBluetoothSocket::SocketError)));
+    connect(socket, SIGNAL(error(QBluetoothSocket::SocketError)),this, SLOT(socketError(QBluetoothSocket::SocketError)));
     connect(socket, SIGNAL(connected()), this, SLOT(socketConnected()));
-    //connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
     connect(socket, SIGNAL(readyRead()), this, SLOT(readyReadBluetoothModule()));
+
+    socket->connectToService(deviceAddress,
+                             QBluetoothUuid(QBluetoothUuid::SerialPort));
 }
+
+void BluetoothModule::closeSocket()
+{
+    timer->stop();
+    rxBuffer.clear(); // drop the half-received reply, keep everything already emitted
+
+    if(socket)
+    {
+        disconnect(socket, nullptr, this, nullptr);
+        socket->abort();
+        socket->deleteLater();
+        socket = nullptr;
+    }
+}
+
+void BluetoothModule::writeCommand(QString command)
+{
+    if(socket)
+        socket->write(command.toLatin1()+endOfRequest);
+}
+
 void BluetoothModule::readyReadBluetoothModule()
 {
 
-    QString data = socket->readAll();
-    qDebug()<<"readyReadBluetoothModule(): "+data;
-    data.remove("00D \r0: ");
-    data.remove("\r1: ");
-    emit BluetoothModuleReply(data);
+    QByteArray chunk = socket->readAll();
+    supervisor->onDataReceived(chunk);
+    if(!supervisor->isConnected())
+        return; // init sequence replies
+
+    // Replies are framed by the ELM '>' prompt
+    rxBuffer.append(chunk);
+    int end;
+    while((end = rxBuffer.indexOf('>')) >= 0)
+    {
+        QString data = QString::fromLatin1(rxBuffer.left(end)).trimmed();
+        rxBuffer.remove(0, end + 1);
+        qDebug()<<"readyReadBluetoothModule(): "+data;
+        data.remove("00D \r0: ");
+        data.remove("\r1: ");
+        emit BluetoothModuleReply(data);
+    }
 
 }
 
 void BluetoothModule::sendToOBD()
 {
+    if(!socket || !supervisor->isConnected())
+        return;
+
     QString pid="01 "+pidList.at(index);
 
 
@@ -794,36 +850,28 @@ void BluetoothModule::sendToOBD()
         index=0;
 
 }
-//void BluetoothModule::socketError(QBluetoothSocket::SocketError)
-//{
-
-//}
+void BluetoothModule::socketError(QBluetoothSocket::SocketError)
+{
+    supervisor->onTransportLost(socket ? socket->errorString() : QString("socket error"));
+}
 
 void BluetoothModule::socketConnected()
 {
 
-    socket->write(QString("AT E0").toLatin1()+endOfRequest); // Echo Off
-    QThread::msleep(400);
-    socket->write(QString("AT L0").toLatin1()+endOfRequest); // Linefeeds Off
-    QThread::msleep(400);
-    socket->write(QString("AT ST 00").toLatin1()+endOfRequest); // Set Timeout to hh x 4 msec ... timeout = 0
-    QThread::msleep(400);
-    socket->write(QString("AT SP 00").toLatin1()+endOfRequest); // set Protocol to Auto and Save it
-    timer->start();
-
-
+    supervisor->onTransportConnected();
 
 }
 
-//void BluetoothModule::socketDisconnected()
-//{
-
-//}
+void BluetoothModule::socketDisconnected()
+{
+    supervisor->onTransportLost("socket disconnected");
+}
 
 
 void BluetoothModule::onTimerIntervalChanged(int msec)
 {
     timer->setInterval(msec);
+    supervisor->setWatchdogInterval(qMax(2000, msec * 5));
 }
 
 
@@ -686,6 +686,7 @@ Public License instead of this License.  But first, please read
 #include <QTimer>
 #include <QThread>
 #include <QMutex>
+#include "connectionsupervisor.h"
 
 
 class BluetoothModule : public QObject
@@ -699,6 +700,8 @@ public:
 signals:
     void BluetoothModuleReply(QString);
     void sendToOBD(QString);
+    void linkStatus(bool);
+    void outageReported(qint64);
 public slots:
     void onStart();
     void onTimerIntervalChanged(int msec);
@@ -706,22 +709,28 @@ private slots:
     void deviceSelected(int);
     void deviceDiscoverFinished();
     void startDiscovery();
-    //void socketError(QBluetoothSocket::SocketError);
+    void socketError(QBluetoothSocket::SocketError);
     void socketConnected();
 
-    //void socketDisconnected();
+    void socketDisconnected();
     void readyReadBluetoothModule();
     void sendToOBD();
+    void openSocket();
+    void closeSocket();
+    void writeCommand(QString);
 
 private:
     QTimer *timer ;
     QStringList pidList;
     char endOfRequest = 13;
-    int index;
+    int index = 0;
     QBluetoothLocalDevice *localDevice;
     QBluetoothDeviceDiscoveryAgent *discoveryAgent;
-    QBluetoothSocket *socket;
+    QBluetoothSocket *socket = nullptr;
     QList<QBluetoothDeviceInfo> listOfDevices;
+    QBluetoothAddress deviceAddress;
+    QByteArray rxBuffer;
+    ConnectionSupervisor *supervisor = nullptr;
 
 
 };
@@ -778,6 +778,11 @@ void handler::timerUDP_QML(bool state)
 {
     emit timerUDP(state);
 }
+void handler::onObdLinkStatus(bool status)
+{
+    isConnected=status;
+    emit connectionStatus(isConnected);
+}
 
 void handler::startRenderThread()
 {
@@ -798,6 +803,8 @@ void handler::startSerialThread()
     connect(this,SIGNAL(setObdTimerInterval(int)),sPort,SLOT(onTimerIntervalChanged(int)));
     connect(sPort,SIGNAL(serialReply(QString)),rData,SLOT(onObdReply(QString)));
     connect(this,SIGNAL(toSerial(QString)),sPort,SLOT(connector(QString)));
+    connect(sPort,SIGNAL(linkStatus(bool)),this,SLOT(onObdLinkStatus(bool)));
+    connect(sPort,SIGNAL(outageReported(qint64)),this,SIGNAL(obdOutage(qint64)));
     sPort->moveToThread(obd_thread);
     QStringList listPorts ;
     const auto infos = QSerialPortInfo::availablePorts();
@@ -809,8 +816,7 @@ void handler::startSerialThread()
         if(info.vendorIdentifier()== 0 && info.productIdentifier() == 0 )//TODO: change values in the condition
         {
             obd_thread->start();
-            emit toSerial(info.portName());
-            isConnected=true;
+            emit toSerial(info.portName()); // the supervisor keeps retrying this port
             break;
         }
     }
@@ -822,6 +828,8 @@ void handler::startBluetoothThread()
     connect(obd_thread, SIGNAL(started()), &bluetoothModule, SLOT(onStart()));
     connect(this,SIGNAL(setObdTimerInterval(int)),&bluetoothModule,SLOT(onTimerIntervalChanged(int)));
     connect(&bluetoothModule,SIGNAL( BluetoothModuleReply(QString)),rData,SLOT(onObdReply(QString)));
+    connect(&bluetoothModule,SIGNAL(linkStatus(bool)),this,SLOT(onObdLinkStatus(bool)));
+    connect(&bluetoothModule,SIGNAL(outageReported(qint64)),this,SIGNAL(obdOutage(qint64)));
 
 
     bluetoothModule.moveToThread(obd_thread);
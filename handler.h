@@ -708,6 +708,7 @@ signals:
     void demoStatus(bool);
     void networkSendingStatus(bool);
     void timerUDP(bool);
+    void obdOutage(qint64);
 
 public slots:
     void on_connect_clicked(QString,QString);
@@ -717,6 +718,7 @@ public slots:
     void startDemo(bool);
     void startSending(bool);
     void timerUDP_QML(bool);
+    void onObdLinkStatus(bool);
 
 
 
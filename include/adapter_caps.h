@@ -0,0 +1,22 @@
+#ifndef ADAPTER_CAPS_H
+#define ADAPTER_CAPS_H
+
+#include "device_adapter.h"
+
+#define ADAPTER_CAPS_DEFAULT_PATH "adapter_caps.txt"
+#define ADAPTER_CAPS_MAX_ENTRIES  32
+
+/* Registry persistence */
+int adapter_caps_load(const char* path);
+int adapter_caps_save(const char* path);
+
+/* Registry access */
+int adapter_caps_lookup(const char* adapter_id, AdapterCapabilities* caps);
+int adapter_caps_store(const AdapterCapabilities* caps);
+int adapter_caps_forget(const char* adapter_id);
+
+/* Cached capabilities for the adapter behind device, probing only if unknown */
+int adapter_caps_resolve(DeviceInterface* device, const char* adapter_id,
+                         AdapterCapabilities* caps);
+
+#endif /* ADAPTER_CAPS_H */
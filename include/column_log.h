@@ -0,0 +1,147 @@
+#ifndef COLUMN_LOG_H
+#define COLUMN_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "timebase.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Columnar session log
+ *
+ * Rows are buffered and written in chunks. Each chunk holds a timestamp
+ * column followed by one typed block per channel, and ends in a footer
+ * with the chunk's time range and per-channel min/max/count. A schema
+ * header names the channels, and each sync or close appends a sparse
+ * time index with each chunk's offset and time range, so a reader maps
+ * the file and opens it without parsing anything but the index, and a
+ * seek is a binary search of the index plus one chunk. Reading one channel touches only that
+ * channel's blocks. A file that was never closed is recovered up to its
+ * last complete chunk.
+ *
+ * Layout is little-endian and every block is 8-byte aligned, so columns
+ * are used in place from the mapping. With compression on, each block
+ * of a chunk is encoded with the ts_codec codec that suits it and is
+ * decoded on read instead.
+ */
+#define COLUMN_LOG_VERSION      1
+#define COLUMN_LOG_MAX_CHANNELS 256
+#define COLUMN_LOG_DEFAULT_ROWS 4096     // Rows per chunk
+
+/* Column types. Values are appended as float; integer columns store
+ * missing (NaN) values as 0 and leave them out of the chunk count. */
+#define COLUMN_TYPE_F32 0
+#define COLUMN_TYPE_F64 1
+#define COLUMN_TYPE_I32 2
+#define COLUMN_TYPE_U8  3
+
+/* Schema entry, stored as-is in the file header */
+typedef struct {
+    char name[32];
+    char unit[16];
+    uint8_t type;              // COLUMN_TYPE_*
+    uint8_t reserved[15];
+} ColumnLogChannel;
+
+/* Queued row layout for log_sink consumers: a uint64_t timebase timestamp
+ * followed by one float per channel */
+#define COLUMN_LOG_ROW_SIZE(channels) (sizeof(uint64_t) + (size_t)(channels) * sizeof(float))
+
+typedef struct {
+    uint32_t rows;
+    uint64_t t_min;            // Timebase microseconds of the first row
+    uint64_t t_max;            // Timebase microseconds of the last row
+} ColumnChunkInfo;
+
+typedef struct {
+    double min;                // NaN when the chunk has no values
+    double max;
+    uint32_t count;            // Non-missing values in the chunk
+} ColumnChunkStats;
+
+/* Writer. Not thread safe; one thread appends. */
+typedef struct ColumnLog ColumnLog;
+
+ColumnLog* column_log_create(const char* path, const ColumnLogChannel* channels,
+                             size_t channel_count, uint32_t chunk_rows);
+int column_log_set_compression(ColumnLog* log, int enabled);
+int column_log_set_anchor(ColumnLog* log, const TimebaseAnchor* anchor);
+int column_log_append(ColumnLog* log, uint64_t timestamp, const float* values);
+int column_log_flush(ColumnLog* log);
+int column_log_sync(ColumnLog* log);
+int column_log_close(ColumnLog* log);
+
+/* Round trip, and appends to a full device failing without overrunning
+ * the chunk buffers */
+int column_log_self_test(void);
+
+/* Loggers keep writing text when the configured path ends in ".csv" */
+int column_log_is_csv_path(const char* path);
+
+/* log_sink consumer over a ColumnLog context: takes COLUMN_LOG_ROW_SIZE
+ * records, a NULL record writes out the partial chunk and syncs */
+size_t column_log_consume(void* context, const void* record);
+
+/* Reader over a read-only mapping */
+typedef struct ColumnLogReader ColumnLogReader;
+
+ColumnLogReader* column_log_open(const char* path);
+void column_log_reader_close(ColumnLogReader* reader);
+size_t column_log_channel_count(const ColumnLogReader* reader);
+const ColumnLogChannel* column_log_channel(const ColumnLogReader* reader, size_t channel);
+int column_log_find_channel(const ColumnLogReader* reader, const char* name);
+int column_log_get_anchor(const ColumnLogReader* reader, TimebaseAnchor* anchor);
+size_t column_log_chunk_count(const ColumnLogReader* reader);
+int column_log_chunk_info(const ColumnLogReader* reader, size_t chunk, ColumnChunkInfo* info);
+int column_log_chunk_stats(const ColumnLogReader* reader, size_t chunk, size_t channel,
+                           ColumnChunkStats* stats);
+
+/* Zero-copy column access, valid until the reader is closed. The column
+ * pointer has the channel's type; rows is set to the chunk's row count.
+ * NULL for blocks stored compressed, which the read functions decode. */
+const uint64_t* column_log_timestamps(const ColumnLogReader* reader, size_t chunk, size_t* rows);
+const void* column_log_column(const ColumnLogReader* reader, size_t chunk, size_t channel,
+                              size_t* rows);
+
+/* Decoded copies; max_rows must hold the whole chunk. Return rows copied,
+ * 0 on error. */
+size_t column_log_read_timestamps(const ColumnLogReader* reader, size_t chunk,
+                                  uint64_t* out, size_t max_rows);
+size_t column_log_read_floats(const ColumnLogReader* reader, size_t chunk, size_t channel,
+                              float* out, size_t max_rows);
+
+/* Time access. Rows are in timestamp order, as the samplers append them. */
+typedef struct {
+    size_t chunk;
+    size_t row;
+} ColumnLogPosition;
+
+/* First row at or after t; -1 when every row is earlier */
+int column_log_seek(const ColumnLogReader* reader, uint64_t t, ColumnLogPosition* position);
+
+/* Walks the rows of [t_start, t_end] a chunk at a time, holding one
+ * chunk of each selected channel whatever the length of the log */
+typedef struct ColumnLogIterator ColumnLogIterator;
+
+ColumnLogIterator* column_log_iter_open(const ColumnLogReader* reader, uint64_t t_start,
+                                        uint64_t t_end, const size_t* channels,
+                                        size_t channel_count);
+/* Next run of rows. timestamps, and columns[i] holding channels[i] as
+ * float, stay valid until the next call. Returns rows, 0 at the end. */
+size_t column_log_iter_next(ColumnLogIterator* iter, const uint64_t** timestamps,
+                            const float* const** columns);
+void column_log_iter_close(ColumnLogIterator* iter);
+
+/* Copies the rows of [t_start, t_end], up to max_rows, into columns[i]
+ * for channels[i]; timestamps may be NULL. Returns rows copied. */
+size_t column_log_read_range(const ColumnLogReader* reader, uint64_t t_start, uint64_t t_end,
+                             const size_t* channels, size_t channel_count,
+                             uint64_t* timestamps, float* const* columns, size_t max_rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* COLUMN_LOG_H */
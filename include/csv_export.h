@@ -0,0 +1,46 @@
+#ifndef CSV_EXPORT_H
+#define CSV_EXPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CSV output without printf
+ *
+ * Numbers are formatted with fixed precision straight into the caller's
+ * buffer: no locale, no format parsing, and the same digits "%.*f" gives
+ * (including round-half-even on exact ties, which fall back to snprintf).
+ * Session export formats log chunks on several threads into per-thread
+ * line buffers and writes them in file order as large blocks.
+ */
+#define CSV_NUMBER_MAX         32   // Longest formatted number, with terminator
+#define CSV_DEFAULT_DECIMALS   2    // Matches the loggers' "%0.2f"
+#define CSV_MAX_DECIMALS       9
+#define CSV_EXPORT_MAX_THREADS 8
+
+/* Both return the length written; out is NUL-terminated. NaN is empty. */
+size_t csv_format_float(double value, int decimals, char* out);
+size_t csv_format_int(int64_t value, char* out);
+
+typedef struct {
+    int decimals;              // Digits after the point, CSV_DEFAULT_DECIMALS if 0
+    size_t threads;            // Formatting threads, 0 = one per CPU
+} CsvExportOptions;
+
+/* Columnar session log to CSV: Timestamp (wall µs) then one column per
+ * channel, the layout the loggers write when given a .csv path. NULL
+ * options take the defaults. */
+int csv_export_log(const char* input_path, const char* output_path,
+                   const CsvExportOptions* options);
+
+/* printf against csv_format_float, then a full export, over synthetic data */
+int csv_export_benchmark(size_t rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSV_EXPORT_H */
@@ -0,0 +1,69 @@
+#ifndef CSV_IMPORT_H
+#define CSV_IMPORT_H
+
+#include "column_log.h"
+#include "timebase.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Parallel CSV log import
+ *
+ * The file is mapped and cut into one span per thread on record
+ * boundaries. Quote parity is counted first, so a quoted field with a
+ * newline in it never splits. Rows are counted, the columns allocated
+ * once, and every thread then parses its span straight into place.
+ * Numbers are parsed without strtod or the locale, except the few whose
+ * digits do not fit a double exactly.
+ *
+ * Known header layouts get their timestamp decoded and unused columns
+ * dropped; any other header with a time column first imports
+ * generically. The delimiter is detected from the header line.
+ */
+#define CSV_DIALECT_GENERIC     0   // First column is time, as a number
+#define CSV_DIALECT_PERFORMANCE 1   // performance_calc logs: wall µs, then 10 channels
+#define CSV_DIALECT_TELEMETRY   2   // telemetry_handler logs: timebase µs, then 17 channels
+#define CSV_DIALECT_MAUI        3   // MAUI LogExportService: ISO 8601 time, "Name (unit)" headers
+
+#define CSV_IMPORT_MAX_THREADS  8
+
+typedef struct {
+    size_t threads;            // Parsing threads, 0 = one per CPU
+} CsvImportOptions;
+
+/* Imported session, shaped like a column log: timestamps in µs on a
+ * timebase described by anchor, one float column per channel. Cells
+ * that are empty or not numeric are NaN; True/False read as 1/0. */
+typedef struct {
+    int dialect;               // CSV_DIALECT_*
+    char delimiter;
+    uint8_t wall_clock;        // Whether anchor.wall_us is known
+    TimebaseAnchor anchor;
+    size_t rows;
+    size_t channel_count;
+    ColumnLogChannel* channels;
+    uint64_t* timestamps;
+    float** columns;           // columns[channel][row]
+} CsvImport;
+
+CsvImport* csv_import(const char* path, const CsvImportOptions* options);
+void csv_import_free(CsvImport* import);
+
+/* Writes the import as a column log for replay, conversion and analysis */
+int csv_import_to_column_log(const CsvImport* import, const char* path, int compress);
+
+/* Decimal text to double, the parser the importer uses. Returns the end
+ * of the number, NULL if text does not start with one. */
+const char* csv_parse_double(const char* text, const char* end, double* value);
+
+/* Import throughput and parse accuracy against strtod */
+int csv_import_benchmark(size_t rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSV_IMPORT_H */
@@ -2,6 +2,7 @@
 #define DEVICE_ADAPTER_H
 
 #include "obd2_core.h"
+#include "performance_calc.h"
 
 /* Device Types */
 typedef enum {
@@ -10,7 +11,9 @@ typedef enum {
     DEVICE_ARDUINO,
     DEVICE_ESP32,
     DEVICE_SCT,      // Added SCT device support
-    DEVICE_SIMULATOR // Added simulator for demo mode
+    DEVICE_SIMULATOR, // Added simulator for demo mode
+    DEVICE_PLUGIN,   // Backend loaded from a shared object
+    DEVICE_REPLAY    // Recorded session played back (session_replay)
 } DeviceType;
 
 /* Connection Types */
@@ -115,6 +118,7 @@ typedef struct {
 /* Device Configuration */
 typedef struct {
     DeviceType type;
+    char plugin_name[32];    // Backend name when type is DEVICE_PLUGIN
     ConnectionType conn_type;
     ConnectionConfig conn_config;
     
@@ -154,6 +158,36 @@ typedef struct {
     } device_config;
 } DeviceConfig;
 
+/* Adapter Capabilities, probed once per adapter and cached in the registry */
+typedef struct {
+    char adapter_id[64];          // Serial port path or Bluetooth address
+    char identity[48];            // Chip identification (ATI/STI)
+    uint32_t default_baudrate;    // Power-on UART baud rate
+    uint32_t max_baudrate;        // Highest negotiated UART baud rate
+    uint8_t max_pids_per_request; // 1 = no multi-PID support
+    bool monitor_mode;            // Passive bus monitor (ATMA) available
+    uint8_t periodic_slots;       // Periodic message slots, 0 = none
+    bool can_fd;                  // CAN FD capable
+    uint8_t protocol;             // Detected vehicle protocol, 0 = unknown
+    uint32_t probed_at;           // Unix time of the probe
+} AdapterCapabilities;
+
+/* Batched PID Access */
+#define DEVICE_MAX_BATCH 32      // Maximum queries per read_pids call
+
+typedef struct {
+    uint8_t mode;          // OBD mode, or UDS service 0x22 for DIDs
+    uint16_t pid;          // PID, or 16-bit DID when mode is 0x22
+    uint8_t length;        // Expected data bytes, 0 = standard PID length
+} PIDQuery;
+
+typedef struct {
+    int status;            // 0 on success, -1 if no valid response
+    uint8_t length;        // Number of valid bytes in data
+    uint8_t data[8];       // Response payload without mode/PID echo
+    uint64_t timestamp_us; // Timebase time the response arrived at the transport
+} PIDResult;
+
 /* Device Interface */
 typedef struct {
     int (*init)(const DeviceConfig* config);
@@ -164,6 +198,16 @@ typedef struct {
     int (*set_protocol)(uint8_t protocol);
     int (*get_voltage)(float* voltage);
     int (*get_status)(uint8_t* status);
+    int (*send_command)(const char* command, char* response, size_t size);
+
+    // PID access; read_pids lets a backend coalesce a whole sample tick
+    int (*read_pid)(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length);
+    int (*write_pid)(uint8_t mode, uint8_t pid, const uint8_t* data, size_t length);
+    int (*read_pids)(const PIDQuery* queries, PIDResult* results, size_t count);
+
+    // Capability handling: probe is run once per adapter, apply on every connect
+    int (*probe_capabilities)(AdapterCapabilities* caps);
+    int (*apply_capabilities)(const AdapterCapabilities* caps);
     
     // Performance monitoring functions
     int (*start_performance_logging)(void);
@@ -182,7 +226,14 @@ typedef struct {
 /* Function Declarations */
 int device_init(const DeviceConfig* config);
 DeviceInterface* device_get_interface(DeviceType type);
+DeviceInterface* device_get_active(void);
+int device_serial_open(const char* port, uint32_t baudrate);
+int device_read_pids(DeviceInterface* device, const PIDQuery* queries,
+                     PIDResult* results, size_t count);
 int device_set_real_time_monitoring(uint8_t enabled);
 int device_read_dtc_codes(DTCInfo* dtcs, size_t* count);
 
+/* Parses captured ELM327 batch replies and checks the decoded PIDs */
+int device_batch_self_test(void);
+
 #endif /* DEVICE_ADAPTER_H */
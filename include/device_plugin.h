@@ -0,0 +1,59 @@
+#ifndef DEVICE_PLUGIN_H
+#define DEVICE_PLUGIN_H
+
+#include "device_adapter.h"
+
+/* Plugin ABI
+ *
+ * A device backend plugin is a shared object named obd2dev_<name>.so
+ * (obd2dev_<name>.dll on Windows) exporting one DevicePluginDescriptor
+ * under the symbol DEVICE_PLUGIN_SYMBOL:
+ *
+ *     DEVICE_PLUGIN_EXPORT("vendorcan", "Vendor CAN dongle", vendorcan_get_interface);
+ *
+ * The major ABI version must match the core's. interface_size lets a
+ * plugin built against an older DeviceInterface keep loading: the fields
+ * it doesn't know about are left NULL. Changes to the structs the
+ * interface passes (PIDQuery, PIDResult, ...) need a new major version.
+ *
+ * 2: PIDResult gained timestamp_us
+ */
+#define DEVICE_PLUGIN_ABI_VERSION  2
+#define DEVICE_PLUGIN_SYMBOL       "obd2_device_plugin"
+#define DEVICE_PLUGIN_PREFIX       "obd2dev_"
+#define DEVICE_PLUGIN_DEFAULT_DIR  "plugins"
+#define DEVICE_PLUGIN_MAX          16
+
+#ifdef _WIN32
+#define DEVICE_PLUGIN_SUFFIX ".dll"
+#else
+#define DEVICE_PLUGIN_SUFFIX ".so"
+#endif
+
+typedef struct {
+    uint32_t abi_version;                  // DEVICE_PLUGIN_ABI_VERSION at build time
+    uint32_t interface_size;               // sizeof(DeviceInterface) at build time
+    const char* name;                      // Backend name, matches the file name
+    const char* description;               // Human readable description
+    DeviceInterface* (*get_interface)(void);
+} DevicePluginDescriptor;
+
+#define DEVICE_PLUGIN_EXPORT(plugin_name, plugin_description, getter) \
+    const DevicePluginDescriptor obd2_device_plugin = {               \
+        DEVICE_PLUGIN_ABI_VERSION,                                    \
+        sizeof(DeviceInterface),                                      \
+        plugin_name,                                                  \
+        plugin_description,                                           \
+        getter                                                        \
+    }
+
+/* Discovery only lists files; nothing is loaded until selected */
+int device_plugin_scan(const char* directory);
+size_t device_plugin_count(void);
+const char* device_plugin_name(size_t index);
+
+/* Load on first use and return the plugin's interface */
+DeviceInterface* device_plugin_get_interface(const char* name);
+void device_plugin_unload_all(void);
+
+#endif /* DEVICE_PLUGIN_H */
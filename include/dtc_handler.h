@@ -2,6 +2,7 @@
 #define DTC_HANDLER_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 
 #define MAX_DTC_COUNT 20
@@ -0,0 +1,46 @@
+#ifndef EXPR_ENGINE_H
+#define EXPR_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Expression engine for derived channels
+ *
+ * Channels are either inputs filled by the caller or derived from a
+ * formula over other channels, e.g. "(map - baro) * 0.145038".
+ * expr_compile parses every formula once into stack bytecode and orders
+ * the derived channels by their dependencies. expr_evaluate_block then
+ * runs the programs column-wise over a block of samples, so interpreter
+ * overhead is paid per block rather than per sample.
+ *
+ * Syntax: numbers, channel names, + - * / ^, unary -, comparisons
+ * (< > <= >= == != yielding 1 or 0), parentheses and the functions
+ * abs, sqrt, min, max, clamp, sin, cos, exp, log. Inside a formula, x
+ * refers to the channel's own source input when one was given.
+ */
+#define EXPR_MAX_CHANNELS   128
+#define EXPR_MAX_NAME       32
+#define EXPR_MAX_FORMULA    256
+#define EXPR_MAX_CODE       128    // Instructions per formula
+#define EXPR_MAX_STACK      16
+#define EXPR_BLOCK_SIZE     256    // Samples per evaluation pass
+
+void expr_reset(void);
+/* Changes on every reset, so owners of registered channels can tell when
+ * someone else (the benchmark) has cleared them */
+uint32_t expr_generation(void);
+int expr_add_input(const char* name);
+int expr_add_channel(const char* name, const char* formula, int source);
+int expr_channel_index(const char* name);
+size_t expr_channel_count(void);
+const char* expr_channel_name(size_t index);
+
+int expr_compile(void);
+
+/* columns[i] holds count samples of channel i; derived columns are written */
+int expr_evaluate_block(float* const* columns, size_t count);
+
+/* Diagnostics */
+int expr_benchmark(size_t formulas, size_t samples);
+
+#endif /* EXPR_ENGINE_H */
@@ -5,6 +5,24 @@
 #include <stdint.h>
 #include <time.h>
 
+/* Template-described record logs
+ *
+ * The XDF and A2L writers parse their template once and lay out a fixed
+ * record from its measurements: a uint64_t wall clock microsecond
+ * timestamp, then each measurement packed in its template datatype,
+ * integers clamped to the template range. The file starts with a header
+ * and a copy of the template, so the log describes itself; records
+ * follow back to back, and are written through one bounded buffer.
+ *
+ * The converters take a columnar or CSV session log. Columnar logs are
+ * converted by several threads, a chunk at a time: with a fixed record
+ * size, every chunk's output offset is known up front.
+ */
+#define LOG_FORMAT_VERSION       1
+#define LOG_FORMAT_MAX_FIELDS    64
+#define LOG_FORMAT_XDF_TEMPLATE  "logger.xdf"   // Used by the converters, see log_template_path
+#define LOG_FORMAT_A2L_TEMPLATE  "logger.a2l"
+
 /* XDF Format Handler */
 typedef struct {
     const char* template_path;
@@ -13,7 +31,7 @@ typedef struct {
     struct {
         uint32_t record_count;
         uint64_t start_time;
-        uint32_t buffer_size;
+        uint32_t buffer_size;    // Records per write, 0 = template <BUFFERSIZE>
     } xdf_state;
 } XDFHandler;
 
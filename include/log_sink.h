@@ -0,0 +1,58 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Asynchronous log sink
+ *
+ * Producers append fixed size binary records without locking or touching
+ * the disk. A background writer thread formats them, writes whole
+ * chunks and fsyncs on an interval, so disk stalls never reach the
+ * sampling threads. A full queue drops the record and counts it.
+ */
+#define LOG_SINK_DEFAULT_CAPACITY   4096       // Records
+#define LOG_SINK_DEFAULT_CHUNK      (64 * 1024) // Bytes per write
+#define LOG_SINK_MAX_LINE           1024       // Longest formatted record
+
+/* Formats one record as text, returns the number of bytes written */
+typedef size_t (*LogSinkFormatter)(const void* record, char* out, size_t size);
+
+/* Takes each record on the writer thread in place of the file output, for
+ * writers with their own file layout. A NULL record asks it to write out
+ * and sync what it holds; that happens on fsync_interval_ms, flush and
+ * close, max_latency_ms does not apply. Returns the bytes it wrote. */
+typedef size_t (*LogSinkConsumer)(void* context, const void* record);
+
+typedef struct {
+    const char* path;             // Output file, truncated on open; unused with consume
+    size_t record_size;           // Size of one binary record
+    uint32_t capacity;            // Queued records, rounded up to a power of two
+    uint32_t chunk_size;          // Write size, rounded up to 4 KiB
+    uint32_t fsync_interval_ms;   // 0 = leave flushing to the OS
+    uint32_t max_latency_ms;      // Longest a record waits in a partial chunk, 0 = 100 ms
+    LogSinkFormatter format;      // NULL writes records raw
+    const char* header;           // Optional text written first
+    LogSinkConsumer consume;      // Replaces path/format/header when set
+    void* consume_context;
+} LogSinkConfig;
+
+typedef struct {
+    uint32_t queue_depth;         // Records waiting for the writer
+    uint32_t queue_high_water;    // Deepest the queue has been
+    uint64_t records_written;
+    uint64_t records_dropped;     // Appends refused because the queue was full
+    uint64_t bytes_written;
+    uint64_t fsyncs;
+    uint64_t write_errors;
+} LogSinkStats;
+
+typedef struct LogSink LogSink;
+
+LogSink* log_sink_open(const LogSinkConfig* config);
+int log_sink_append(LogSink* sink, const void* record);
+int log_sink_flush(LogSink* sink);
+int log_sink_get_stats(LogSink* sink, LogSinkStats* stats);
+int log_sink_close(LogSink* sink);
+
+#endif /* LOG_SINK_H */
@@ -0,0 +1,97 @@
+#ifndef LOG_TEMPLATE_H
+#define LOG_TEMPLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A2L and XDF channel templates
+ *
+ * Turns a measurement description into channel descriptors: storage
+ * type, linear scaling, limits, target sample rate and, for channels
+ * read over OBD-II, the mode 01 PID. The file is mapped and lexed in
+ * place; only the descriptors are allocated.
+ *
+ * A2L: MEASUREMENT blocks, with conversions resolved through LINEAR and
+ * linear RAT_FUNC COMPU_METHODs. Two keywords are added to ASAP2 for
+ * this project's templates: SAMPLED <hz> and OBD_PID <pid>.
+ * XDF: MEASUREMENT elements with DATATYPE, UNIT, MIN, MAX, SAMPLERATE,
+ * FACTOR, OFFSET and PID (hex).
+ */
+#define LOG_TEMPLATE_XDF 0
+#define LOG_TEMPLATE_A2L 1
+
+/* Storage types */
+#define CHANNEL_TYPE_U8  0
+#define CHANNEL_TYPE_S8  1
+#define CHANNEL_TYPE_U16 2
+#define CHANNEL_TYPE_S16 3
+#define CHANNEL_TYPE_U32 4
+#define CHANNEL_TYPE_S32 5
+#define CHANNEL_TYPE_F32 6
+#define CHANNEL_TYPE_F64 7
+
+#define CHANNEL_NO_PID (-1)
+
+typedef struct {
+    char name[32];             // Truncated if longer
+    char unit[16];
+    uint8_t type;              // CHANNEL_TYPE_*
+    double factor;             // Physical = raw * factor + offset
+    double offset;
+    double min;                // Physical limits, equal when not given
+    double max;
+    float rate_hz;             // Target sample rate, 0 when not given
+    int16_t pid;               // OBD-II mode 01 PID, CHANNEL_NO_PID if none
+} ChannelDescriptor;
+
+typedef struct {
+    int format;                // LOG_TEMPLATE_XDF or LOG_TEMPLATE_A2L
+    ChannelDescriptor* channels;
+    size_t channel_count;
+    char project[32];          // A2L PROJECT name
+    uint32_t characteristics;  // A2L CHARACTERISTIC blocks
+    uint32_t buffer_records;   // XDF <LOGGING><BUFFERSIZE>, 0 if not given
+    const char* text;          // Template source, valid until freed
+    size_t text_size;
+    size_t mapped_size;        // Mapping behind text, 0 when caller owned
+} LogTemplate;
+
+/* Format is taken from the content: XML is XDF, anything else A2L */
+LogTemplate* log_template_load(const char* path);
+
+/* Parse text the caller keeps alive for the template's lifetime */
+LogTemplate* log_template_parse(const char* text, size_t size, int format);
+void log_template_free(LogTemplate* tmpl);
+
+size_t log_template_channel_size(uint8_t type);
+
+/* Stores a physical value as the channel's raw type: clamped to its
+ * limits, scaled back through factor and offset, rounded for integers.
+ * Integer channels have no missing value and store NaN as 0. */
+void log_template_encode(const ChannelDescriptor* channel, double value, uint8_t* out);
+int log_template_find(const LogTemplate* tmpl, const char* name);
+
+/* Mode 01 PIDs in template order, with the period their rate asks for
+ * (0 when the template gives none). Returns the number stored. */
+size_t log_template_pids(const LogTemplate* tmpl, uint8_t* pids, uint32_t* period_ms,
+                         size_t max);
+
+/* Bundled templates: $LOG_TEMPLATE_DIR_ENV when set, else the templates
+ * directory next to the executable or one level up from it (install
+ * prefix, bin/ and build trees), else ./templates. Writes the first
+ * readable candidate to path; returns -1 if none is. */
+#define LOG_TEMPLATE_DIR_ENV "OBD2_TEMPLATE_DIR"
+int log_template_path(const char* name, char* path, size_t size);
+
+/* Parse time over a synthetic A2L of the given size */
+int log_template_benchmark(size_t measurements);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOG_TEMPLATE_H */
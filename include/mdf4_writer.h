@@ -0,0 +1,54 @@
+#ifndef MDF4_WRITER_H
+#define MDF4_WRITER_H
+
+#include "log_template.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ASAM MDF 4.1 streaming export
+ *
+ * Channels sharing a sample rate form one sorted data group: a single
+ * channel group with a time master and no record IDs. A record is
+ * written to a group only when one of its channels has a value, and a
+ * channel without one gets its invalidation bit set. Records are
+ * buffered per group and written as DT blocks, or as DZ blocks (deflate
+ * over transposed records) when compression is on; a group with more
+ * than one block gets a DL list when the file is closed. Raw values use
+ * the descriptor's type and carry a linear conversion back to physical.
+ *
+ * The file is marked unfinalized until mdf4_writer_close succeeds.
+ * DZ needs zlib: build with HAVE_ZLIB.
+ */
+#define MDF4_MAX_GROUPS       16                 // Distinct sample rates
+#define MDF4_BLOCK_SIZE       (4 * 1024 * 1024)  // Uncompressed bytes per data block
+#define MDF4_COMPRESS_DEFAULT 1                  // Deflate level for DZ blocks, speed first
+
+typedef struct Mdf4Writer Mdf4Writer;
+
+/* Channels are copied. start_wall_us is the time of the first record. */
+Mdf4Writer* mdf4_writer_create(const char* path, const ChannelDescriptor* channels,
+                               size_t count, int64_t start_wall_us);
+/* Deflate level 1-9 for DZ blocks, 0 for plain DT. Before the first append. */
+int mdf4_writer_set_compression(Mdf4Writer* writer, int level);
+/* One value per channel, NaN where it was not sampled */
+int mdf4_writer_append(Mdf4Writer* writer, int64_t wall_us, const float* values);
+int mdf4_writer_close(Mdf4Writer* writer);
+
+/* Session log (.clog) to MDF4 in one pass, holding a chunk at a time.
+ * Log channels named in the template (may be NULL) take its type,
+ * scaling, limits and rate; the rest are stored as float. */
+int mdf4_export_log(const char* input_path, const char* output_path,
+                    const char* template_path, int compression);
+
+/* Export throughput against CSV over a synthetic session */
+int mdf4_benchmark(size_t rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MDF4_WRITER_H */
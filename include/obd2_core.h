@@ -2,6 +2,8 @@
 #define OBD2_CORE_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
 #include <time.h>
 
 /* Debug configuration */
@@ -30,7 +32,7 @@ typedef struct {
 } PID_Response;
 
 typedef struct {
-    uint32_t timestamp;
+    uint64_t timestamp;        // Timebase microseconds (timebase.h)
     uint16_t pid;
     uint8_t dataLength;
     uint8_t data[8];
@@ -108,6 +110,7 @@ float calculate_maf(uint8_t msb, uint8_t lsb);
 float calculate_throttle_pos(uint8_t raw_value);
 float calculate_o2_voltage(uint8_t raw_value);
 float calculate_fuel_level(uint8_t raw_value);
+uint8_t obd2_pid_data_length(uint8_t pid);
 
 /* Protocol Functions */
 int obd2_protocol_init(void);
@@ -139,6 +142,7 @@ int can_receive_frame(CANFrame* frame, uint32_t timeout_ms);
 int can_set_filter(uint32_t id, uint32_t mask, uint8_t extended);
 int can_check_bus_status(void);
 int can_iso_tp_send(uint32_t id, const uint8_t* data, size_t length);
+int can_iso_tp_receive(uint32_t fc_id, uint8_t* data, size_t* length, uint32_t timeout_ms);
 
 /* Advanced Diagnostic Functions */
 typedef struct {
@@ -2,17 +2,43 @@
 #define PERFORMANCE_CALC_H
 
 #include "obd2_core.h"
+#include "log_sink.h"
+#include "safety_rules.h"
+#include "stream_stats.h"
 #include <stdint.h>
 #include <time.h>
 
 #define MAX_DATALOG_OVERLAY 10  // Maximum number of logs to overlay
 
+/* Channels with running statistics, in log column order */
+enum {
+    PERFORMANCE_STAT_RPM,
+    PERFORMANCE_STAT_SPEED,
+    PERFORMANCE_STAT_VE,
+    PERFORMANCE_STAT_MAF,
+    PERFORMANCE_STAT_TORQUE,
+    PERFORMANCE_STAT_BOOST,
+    PERFORMANCE_STAT_AFR,
+    PERFORMANCE_STAT_IAT,
+    PERFORMANCE_STAT_TPS,
+    PERFORMANCE_STAT_ACCEL,
+    PERFORMANCE_STAT_CHANNELS
+};
+
 #define SAFETY_CHECK_INTERVAL_MS 100
 #define MAX_SAFE_RPM 8000
 #define MAX_SAFE_BOOST 30.0
 #define MAX_SAFE_EGT 1600.0
 #define MAX_SAFE_COOLANT_TEMP 230.0
 #define MIN_SAFE_OIL_PRESSURE 10.0
+#define SAFETY_HYSTERESIS 0.03f  // Clear 3% back from a limit
+
+/* Safety warning flags (safety_status.warning_flags) */
+#define SAFETY_FLAG_RPM          0x01
+#define SAFETY_FLAG_BOOST        0x02
+#define SAFETY_FLAG_EGT          0x04
+#define SAFETY_FLAG_COOLANT      0x08
+#define SAFETY_FLAG_OIL_PRESSURE 0x10
 
 /* Advanced Performance Metrics */
 typedef struct {
@@ -88,7 +114,7 @@ typedef struct {
     float engine_rpm;            // Current RPM
     float vehicle_speed;         // Speed in MPH
     float acceleration;          // G-force
-    time_t timestamp;            // Timestamp of reading
+    time_t timestamp;            // Wall clock seconds, for display only
 
     // Additional sensors
     float knock_voltage;       // Knock sensor voltage
@@ -111,7 +137,7 @@ typedef struct {
     float trap_speed_proj;     // Projected trap speed
 
     // Timing data
-    uint64_t timestamp_us;     // Microsecond timestamp
+    uint64_t timestamp_us;     // Timebase microseconds of the reading
     float interval_ms;         // Actual sampling interval
 
     // Additional safety monitoring
@@ -282,6 +308,11 @@ typedef struct {
         float average_values[MAX_DATALOG_OVERLAY];
         float variance_values[MAX_DATALOG_OVERLAY];
     } comparative_data;
+    struct {
+        float peak_values[PERFORMANCE_STAT_CHANNELS];     // Indexed by PERFORMANCE_STAT_*
+        float average_values[PERFORMANCE_STAT_CHANNELS];
+        float variance_values[PERFORMANCE_STAT_CHANNELS];
+    } channel_data;
 } AnalysisResults;
 
 /* Performance Calculator Interface */
@@ -306,17 +337,29 @@ typedef struct {
 /* Function Declarations */
 PerformanceInterface* performance_get_interface(void);
 int performance_init_logging(const char* log_path);
+int performance_close_logging(void);
 int performance_set_log_interval(uint32_t interval_ms);
 int performance_init_safety_monitor(SafetyMonitor* config);
 int performance_set_passive_mode(bool enabled);
 int performance_configure_logging(const LogConfig* config);
+int performance_get_log_stats(LogSinkStats* stats);
 int performance_export_to_csv(const char* session_id, const char* filepath);
 int performance_validate_command(const char* command, bool* is_safe);
 int performance_check_safety_limits(const PerformanceData* data, char* warning_msg);
+int performance_add_safety_rule(const SafetyRule* rule);
 int performance_init_simulation(SimulationConfig* config);
 int performance_set_overlay_config(OverlayConfig* config);
+int performance_set_stats_window(uint32_t window_ms);
+int performance_new_lap(void);
+int performance_get_channel_stats(size_t channel, StatsWindow window, ChannelStats* stats);
+int performance_get_analysis(StatsWindow window, AnalysisResults* results);
 int performance_flash_sct_firmware(const char* firmware_path, SCTFlashConfig* config);
 int performance_add_custom_parameter(CustomParameter* param);
+int performance_get_channel_index(const char* name);
+size_t performance_get_channel_count(void);
+int performance_evaluate_channels(float* const* columns, size_t count);
+int performance_update_channels(const uint8_t* pids, const float* values, size_t count);
+int performance_get_channel_value(size_t channel, float* value);
 int performance_start_simulation(void);
 int performance_stop_simulation(void);
 int performance_verify_firmware(const char* firmware_path, char* signature);
@@ -3,24 +3,101 @@
 
 #include "obd2_core.h"
 #include "device_adapter.h"
+#include "safety_rules.h"
+
+/* Sample status */
+#define MONITOR_STATUS_INVALID 0   // No data
+#define MONITOR_STATUS_FRESH   1   // Sampled in this tick
+#define MONITOR_STATUS_HELD    2   // Last value from an earlier tick
+
+/* Triggered captures */
+#define MONITOR_MAX_TRIGGERS 8     // Triggers that can be armed at once
+#define MONITOR_MAX_CAPTURES 4     // Captures being written concurrently
+
+/* DTC watch */
+#define MONITOR_MAX_DTCS   32      // Codes tracked per mode
+#define MONITOR_DTC_EVENTS 64      // Change events kept for readers
 
 /* Monitoring parameters */
 typedef struct {
-    uint32_t sample_rate_ms;    // How often to sample
+    uint32_t sample_rate_ms;    // Default sampling period per PID
     uint32_t buffer_size;       // How many samples to keep
     uint8_t pids[32];          // PIDs to monitor
     size_t pid_count;          // Number of PIDs
+    uint32_t pid_rate_ms[32];  // Per-PID period, 0 = sample_rate_ms
+    uint32_t event_buffer_size; // Events to keep, 0 = buffer_size * pid_count
     uint8_t log_to_file;       // Whether to log to file
     char log_file[256];        // Log file path
+    uint8_t realtime_priority; // SCHED_FIFO priority for the sampler, 0 = normal
+    uint8_t pin_to_cpu;        // Whether to pin the sampler to cpu_index
+    uint8_t cpu_index;         // CPU for the sampling thread
+    uint32_t log_fsync_ms;     // Log fsync interval, 0 = leave to the OS
+    uint32_t dtc_interval_ms;  // Background DTC poll period per mode, 0 = off
+    uint32_t log_interval_ms;  // Minimum spacing of logged rows per PID, 0 = every sample
+    uint8_t compress_log;      // Encode columnar log and capture chunks
+    char capture_dir[256];     // Directory for triggered captures, empty = current
+    char channel_template[256]; // A2L/XDF file giving PIDs, rates and log channels, empty = pids[]
+    uint8_t free_run;          // Sample back to back while the device has data, e.g. a fast replay
 } MonitorConfig;
 
 /* Sample data */
 typedef struct {
-    uint32_t timestamp;
+    uint64_t timestamp;        // Timebase microseconds of the newest response
     float values[32];          // Values for each PID
     uint8_t status[32];        // Status for each value
+    uint32_t warning_flags;    // Safety rules active after this sample
 } MonitorSample;
 
+/* Sparse sample event, one per PID actually sampled */
+typedef struct {
+    uint64_t timestamp;        // Timebase microseconds the response was received
+    uint8_t channel;           // Index into MonitorConfig.pids
+    uint8_t status;            // MONITOR_STATUS_*
+    float value;
+} MonitorEvent;
+
+/* DTC change, published only when a code appears or disappears */
+typedef struct {
+    uint64_t timestamp;        // Timebase microseconds
+    uint8_t mode;              // 0x03 stored, 0x07 pending, 0x0A permanent
+    uint8_t set;               // 1 = newly reported, 0 = no longer reported
+    uint16_t raw_code;
+    char code[6];
+} MonitorDTCEvent;
+
+/* Trigger for a full-rate capture window. The event ring must hold at
+ * least pre_ms of events for the pre-trigger part to be complete. */
+typedef struct {
+    char name[32];             // Used in the capture file name
+    bool use_condition;        // Fire when condition raises
+    SafetyRule condition;      // Threshold over a monitor channel; callback is ignored
+    uint32_t safety_mask;      // Fire when any of these warning_flags come on
+    uint32_t pre_ms;           // History before the trigger to include
+    uint32_t post_ms;          // Capture after the trigger
+} MonitorTrigger;
+
+/* Sampling thread statistics */
+typedef struct {
+    uint64_t ticks;            // Completed sampling ticks
+    uint64_t overruns;         // Deadlines skipped because a tick ran long
+    uint32_t jitter_last_us;   // Wake-up lateness of the last tick
+    uint32_t jitter_max_us;    // Worst wake-up lateness
+    double jitter_mean_us;     // Mean wake-up lateness
+    uint32_t tick_last_us;     // Collection time of the last tick
+    uint32_t tick_max_us;      // Worst collection time
+    uint8_t realtime;          // SCHED_FIFO was granted
+    uint32_t log_queue_depth;  // Log rows waiting for the writer thread
+    uint64_t log_dropped;      // Log rows dropped because the queue was full
+    uint32_t safety_last_ns;   // Rule evaluation time of the last tick
+    uint32_t safety_max_ns;    // Worst rule evaluation time
+    uint64_t dtc_polls;        // Background DTC reads completed
+    uint64_t dtc_deferred;     // DTC polls postponed for lack of slack
+    uint32_t dtc_cost_us;      // Estimated duration of one DTC read
+    uint64_t captures_started; // Triggers that opened a capture
+    uint64_t captures_written; // Capture files completed
+    uint64_t capture_lost;     // Events overwritten before a capture copied them
+} MonitorStats;
+
 /* Monitor interface */
 int monitor_init(const MonitorConfig* config);
 int monitor_start(void);
@@ -28,9 +105,28 @@ int monitor_stop(void);
 int monitor_get_latest(MonitorSample* sample);
 int monitor_get_history(MonitorSample* samples, size_t* count);
 int monitor_clear_history(void);
+int monitor_get_stats(MonitorStats* stats);
+
+/* Safety rules over monitor channels (rule.channel indexes MonitorConfig.pids),
+ * evaluated in the sampling thread as each tick completes. Set while stopped. */
+int monitor_set_safety_rules(const SafetyRule* rules, size_t count);
+
+/* Triggered captures: each firing writes pre_ms before and post_ms after
+ * the trigger, at full rate, to its own file in capture_dir while the
+ * regular log continues. Set while stopped; fire may be called anytime. */
+int monitor_set_triggers(const MonitorTrigger* triggers, size_t count);
+int monitor_fire_trigger(size_t index);
+
+/* Sparse access: event stream read through a caller-held cursor, and the
+ * last value seen on each channel */
+int monitor_get_events(uint64_t* cursor, MonitorEvent* events, size_t* count);
+int monitor_get_channel(size_t channel, MonitorEvent* latest);
 
-/* DTC monitoring */
+/* DTC monitoring. With dtc_interval_ms set, the sampling thread polls
+ * Mode 03/07/0A in the slack after its ticks and reports changes only. */
 int monitor_check_dtc(void);
+int monitor_get_dtc_events(uint64_t* cursor, MonitorDTCEvent* events, size_t* count);
+int monitor_get_dtcs(uint8_t mode, uint16_t* codes, size_t* count);
 int monitor_get_dtc_description(const char* code, char* desc, size_t size);
 int monitor_clear_dtc(void);
 
@@ -0,0 +1,65 @@
+#ifndef SAFETY_RULES_H
+#define SAFETY_RULES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Safety rule engine
+ *
+ * Threshold rules with hysteresis, checked against a vector of channel
+ * values every time a sample arrives. A rule raises its warning after
+ * debounce consecutive samples past trip, and clears it once the value
+ * comes back past clear. Callbacks fire on those transitions only, from
+ * the evaluating thread, so they must not block. A NaN value (no data)
+ * neither raises nor clears a rule.
+ */
+#define SAFETY_MAX_RULES 128
+
+typedef enum {
+    SAFETY_ABOVE,              // Warn when the value rises above trip
+    SAFETY_BELOW               // Warn when the value falls below trip
+} SafetyDirection;
+
+typedef struct SafetyRule SafetyRule;
+
+typedef void (*SafetyCallback)(const SafetyRule* rule, float value, bool active,
+                               uint64_t timestamp, void* user_data);
+
+struct SafetyRule {
+    char name[32];
+    uint8_t channel;           // Index into the evaluated value vector
+    SafetyDirection direction;
+    float trip;                // Warning raised past this value
+    float clear;               // Warning cleared back past this value
+    uint16_t debounce;         // Consecutive samples past trip, 0 = 1
+    uint32_t flag;             // Bits set in warning_flags while active
+    SafetyCallback callback;   // Optional, called on raise and on clear
+    void* user_data;
+};
+
+/* Rules are stored sign-normalised so every check is "value > trip" */
+typedef struct {
+    SafetyRule rules[SAFETY_MAX_RULES];
+    size_t count;
+    uint8_t channel[SAFETY_MAX_RULES];
+    float sign[SAFETY_MAX_RULES];
+    float trip[SAFETY_MAX_RULES];
+    float clear[SAFETY_MAX_RULES];
+    uint16_t debounce[SAFETY_MAX_RULES];
+    uint16_t pending[SAFETY_MAX_RULES];  // Consecutive samples past trip so far
+    uint8_t active[SAFETY_MAX_RULES];
+    uint32_t flags;            // OR of the flags of all active rules
+    uint64_t transitions;      // Raises and clears since init
+} SafetyRuleSet;
+
+void safety_rules_init(SafetyRuleSet* set);
+int safety_rules_add(SafetyRuleSet* set, const SafetyRule* rule);
+void safety_rules_reset(SafetyRuleSet* set);
+uint32_t safety_rules_evaluate(SafetyRuleSet* set, const float* values, uint64_t timestamp);
+size_t safety_rules_describe(const SafetyRuleSet* set, char* out, size_t size);
+
+/* Diagnostics */
+int safety_rules_benchmark(size_t rule_count, size_t samples);
+
+#endif /* SAFETY_RULES_H */
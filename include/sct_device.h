@@ -3,6 +3,40 @@
 
 #include "device_adapter.h"
 #include <stdint.h>
+#include <stddef.h>
+
+/* SCT wire protocol (docs/SCTDeviceUpdater.md), little-endian */
+#define SCT_PROTOCOL_VERSION   0x01
+#define SCT_MAX_PAYLOAD        1024
+
+#define SCT_CMD_HANDSHAKE      0x01
+#define SCT_CMD_READ_TUNE      0x02
+#define SCT_CMD_WRITE_TUNE     0x03
+#define SCT_CMD_READ_PARAMS    0x04
+#define SCT_CMD_WRITE_PARAMS   0x05
+#define SCT_CMD_START_LOGGING  0x06
+#define SCT_CMD_STOP_LOGGING   0x07
+#define SCT_CMD_FLASH_FIRMWARE 0x08
+
+#define SCT_FLAG_RESPONSE      0x01  // Reply to the request with the same sequence
+#define SCT_FLAG_STREAM        0x02  // Unsolicited logging frame of SCTSample records
+#define SCT_FLAG_ERROR         0x04  // Request rejected by the device
+
+/* READ_PARAMS / WRITE_PARAMS page selector, first payload byte */
+#define SCT_PAGE_LIVE          0x00  // SCTParameters
+#define SCT_PAGE_SAFETY_LIMITS 0x01  // Opaque safety limit block
+#define SCT_PAGE_SAFETY_STATUS 0x02  // u8 status, u32 pending event id
+
+#define SCT_MIN_FIRMWARE_MAJOR 2
+#define SCT_MIN_FIRMWARE_MINOR 9
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;       // SCT_PROTOCOL_VERSION
+    uint8_t command;       // SCT_CMD_*
+    uint16_t length;       // Payload bytes following the header
+    uint32_t sequence;     // Echoed in the response
+    uint8_t flags;         // SCT_FLAG_*
+} SCTPacketHeader;
 
 /* SCT device parameters */
 typedef struct {
@@ -17,6 +51,24 @@ typedef struct {
     uint16_t fuelPressure;
 } SCTParameters;
 
+/* One logging sample, laid out exactly as it travels on the wire so
+ * stream payloads can be read straight into ring slots */
+typedef struct {
+    uint32_t timestamp_us;   // Device clock
+    uint16_t flags;          // Device status bits at sample time
+    SCTParameters params;
+} SCTSample;
+
+/* Caller-owned sample ring filled by get_monitoring_data.
+ * head and tail are free-running; capacity must be a power of two. */
+typedef struct {
+    SCTSample* slots;
+    uint32_t capacity;
+    uint32_t head;           // Advanced by get_monitoring_data
+    uint32_t tail;           // Advanced by the consumer
+    uint32_t dropped;        // Samples discarded because the ring was full
+} SCTSampleRing;
+
 /* Advanced tuning parameters */
 typedef struct {
     struct {
@@ -65,7 +117,7 @@ typedef struct {
     /* Real-time monitoring */
     int (*start_monitoring)(uint16_t sample_rate);
     int (*stop_monitoring)(void);
-    int (*get_monitoring_data)(void* data, size_t* size);
+    int (*get_monitoring_data)(void* data, size_t* size);  // data is an SCTSampleRing, size returns samples added
     
     /* Safety systems */
     int (*get_safety_limits)(void* limits, size_t* size);
@@ -79,6 +131,10 @@ typedef struct {
     int (*verify_firmware)(void);
 } SCTDeviceInterface;
 
+/* Backend access */
+SCTDeviceInterface* get_sct_interface(void);
+DeviceInterface* sct_get_device_interface(void);
+
 /* SCT device diagnostic functions */
 int sct_run_diagnostics(void);
 int sct_check_compatibility(void);
@@ -0,0 +1,17 @@
+#ifndef SCT_EMULATOR_H
+#define SCT_EMULATOR_H
+
+#include "sct_device.h"
+
+/* In-process SCT device speaking the documented framing over a
+ * socketpair. Used for CONN_DEMO and for checking the SCT backend
+ * without hardware. */
+#define SCT_EMULATOR_FIRMWARE "2.9.4"
+
+int sct_emulator_start(int* host_fd);
+void sct_emulator_stop(void);
+
+/* Streams at sample_rate for duration_ms and checks count and continuity */
+int sct_emulator_self_test(uint16_t sample_rate, uint32_t duration_ms);
+
+#endif /* SCT_EMULATOR_H */
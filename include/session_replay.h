@@ -0,0 +1,71 @@
+#ifndef SESSION_REPLAY_H
+#define SESSION_REPLAY_H
+
+#include "device_adapter.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Recorded session replay
+ *
+ * Plays a session log (.clog, or any CSV layout csv_import knows) back
+ * as a device: DEVICE_REPLAY answers PID reads with the recorded values
+ * encoded as mode 01 responses, so the monitor's decoder, safety rules,
+ * logs and captures, and everything reading the monitor, run exactly as
+ * they do live. get_performance_data gives the same values as a
+ * PerformanceData for the performance and telemetry paths.
+ *
+ * Channels are matched to PIDs by template (when given), by the monitor's
+ * PID_XX names, or by the names the loggers in this tree write; mph, °F
+ * and psi gauge boost are converted to the PID units.
+ *
+ * Timing follows the recording scaled by speed: reads return the values
+ * recorded at the replay position, which advances with the timebase. At
+ * SESSION_REPLAY_FASTEST each batch read returns the next recorded row,
+ * and a monitor with free_run set then takes rows as fast as the whole
+ * pipeline can. Responses are stamped on the recording's own spacing,
+ * starting from when the replay (or the last seek) began.
+ */
+#define SESSION_REPLAY_MAX_CHANNELS 32     // As many as the monitor samples
+#define SESSION_REPLAY_FASTEST      0.0f   // Speed: no pacing, one row per read
+
+typedef struct {
+    float speed;               // 1 = recorded timing, 2 = twice as fast, SESSION_REPLAY_FASTEST
+    const char* channel_template; // A2L/XDF giving channel PIDs, may be NULL
+} SessionReplayOptions;
+
+typedef struct {
+    uint64_t duration_us;      // Recorded length
+    uint64_t position_us;      // Replay position from the start of the recording
+    uint64_t rows;             // Rows replayed since open
+    float speed;
+    uint8_t finished;          // Past the last row
+    size_t pid_count;          // PIDs the replay answers, in log channel order
+    uint8_t pids[SESSION_REPLAY_MAX_CHANNELS];
+} SessionReplayStatus;
+
+/* One replay at a time; opening another closes the first */
+int session_replay_open(const char* path, const SessionReplayOptions* options);
+void session_replay_close(void);
+
+/* Position from the start of the recording. Values held from before the
+ * seek are dropped; each channel returns with its next recorded value. */
+int session_replay_seek(uint64_t position_us);
+int session_replay_set_speed(float speed);
+int session_replay_get_status(SessionReplayStatus* status);
+
+DeviceInterface* session_replay_get_device_interface(void);
+
+/* End-to-end throughput: a synthetic session replayed at full speed
+ * through the monitor with logging and safety rules, then paced and
+ * seek checks */
+int session_replay_benchmark(size_t rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SESSION_REPLAY_H */
@@ -0,0 +1,65 @@
+#ifndef SESSION_WAL_H
+#define SESSION_WAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Write-ahead session log
+ *
+ * Append-only segment files of checksummed records. Appends are buffered
+ * and written together with one fdatasync per commit, so a power cut
+ * loses at most the records since the last commit and never corrupts
+ * the ones before it. On the next start, recovery replays every intact
+ * record and truncates the log at the first torn or corrupt one.
+ *
+ * The writer is single-threaded. Run it behind a log_sink with
+ * session_wal_consume and fsync_interval_ms set to the commit interval
+ * to get group commit off the producer threads.
+ */
+#define SESSION_WAL_DEFAULT_SEGMENT (8 * 1024 * 1024)  // Bytes per segment file
+#define SESSION_WAL_MAX_RECORD      (64 * 1024)
+
+typedef struct {
+    const char* directory;     // Where segments live, created if missing
+    const char* name;          // Segment prefix: <name>-<sequence>.wal
+    uint32_t segment_size;     // Roll to a new segment past this, 0 = default
+    uint32_t buffer_size;      // Bytes buffered between commits, 0 = 64 KiB
+    size_t record_size;        // Payload size taken by session_wal_consume
+} SessionWalConfig;
+
+typedef struct {
+    uint32_t segments;         // Segment files found
+    uint64_t records;          // Intact records replayed
+    uint64_t bytes;            // Payload bytes replayed
+    uint64_t truncated_bytes;  // Torn or corrupt tail cut off
+    uint32_t removed_segments; // Segments deleted as empty or after the damage
+} SessionWalRecovery;
+
+/* Called for each intact record in log order; non-zero stops the replay */
+typedef int (*SessionWalReplay)(void* context, uint64_t lsn, const void* payload, size_t length);
+
+typedef struct SessionWal SessionWal;
+
+SessionWal* session_wal_open(const SessionWalConfig* config);
+int session_wal_append(SessionWal* wal, const void* payload, size_t length);
+int session_wal_commit(SessionWal* wal);
+uint64_t session_wal_last_lsn(const SessionWal* wal);
+int session_wal_close(SessionWal* wal, int remove_segments);
+
+/* log_sink consumer over a SessionWal context: appends fixed-size records,
+ * a NULL record commits */
+size_t session_wal_consume(void* context, const void* record);
+
+int session_wal_recover(const char* directory, const char* name, SessionWalReplay replay,
+                        void* context, SessionWalRecovery* result);
+int session_wal_remove(const char* directory, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SESSION_WAL_H */
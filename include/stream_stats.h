@@ -0,0 +1,68 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Incremental per-channel statistics
+ *
+ * Each sample updates a running summary in constant time: Welford mean
+ * and variance, min/max, and a log-bucketed quantile sketch whose
+ * percentiles are within STATS_SKETCH_ACCURACY relative error. Summaries
+ * merge exactly, which is how the recent window is assembled from
+ * fixed-length panes and how logs can be combined.
+ */
+#define STATS_SKETCH_ACCURACY  0.02f   // Relative error of quantiles
+#define STATS_SKETCH_BUCKETS   512     // Per sign, covers 1e-3 to ~8e5
+#define STATS_WINDOW_PANES     10      // Recent window resolution
+#define STATS_DEFAULT_WINDOW_MS 30000
+
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;                 // Sum of squared deviations from the mean
+    float min;
+    float max;
+    uint32_t zero_count;       // Magnitudes below the sketch range
+    uint32_t positive[STATS_SKETCH_BUCKETS];
+    uint32_t negative[STATS_SKETCH_BUCKETS];
+} StatSummary;
+
+void stats_summary_reset(StatSummary* summary);
+void stats_summary_add(StatSummary* summary, float value);
+void stats_summary_merge(StatSummary* into, const StatSummary* from);
+float stats_summary_variance(const StatSummary* summary);
+float stats_summary_quantile(const StatSummary* summary, float q);
+
+/* Windows kept for every channel */
+typedef enum {
+    STATS_WINDOW_SESSION,      // Since creation or the last reset
+    STATS_WINDOW_LAP,          // Since the last stream_stats_new_lap
+    STATS_WINDOW_RECENT,       // Roughly the last window_ms of samples
+    STATS_WINDOW_COUNT
+} StatsWindow;
+
+typedef struct {
+    uint64_t count;
+    float min;
+    float max;
+    float mean;
+    float variance;
+    float stddev;
+    float p50;
+    float p90;
+    float p99;
+} ChannelStats;
+
+typedef struct StreamStats StreamStats;
+
+StreamStats* stream_stats_create(size_t channels, uint32_t window_ms);
+void stream_stats_destroy(StreamStats* stats);
+int stream_stats_add(StreamStats* stats, const float* values, uint64_t timestamp_ms);
+int stream_stats_new_lap(StreamStats* stats);
+int stream_stats_reset(StreamStats* stats);
+int stream_stats_get(StreamStats* stats, size_t channel, StatsWindow window, ChannelStats* out);
+int stream_stats_get_summary(StreamStats* stats, size_t channel, StatsWindow window,
+                             StatSummary* out);
+
+#endif /* STREAM_STATS_H */
@@ -0,0 +1,33 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Timebase
+ *
+ * All sample, event and log timestamps are CLOCK_MONOTONIC microseconds,
+ * so ordering and intervals are exact and never jump with NTP or DST.
+ * Each session records an anchor pairing a monotonic instant with the
+ * wall clock, which maps timestamps to absolute time for display and
+ * for log files.
+ */
+typedef struct {
+    uint64_t monotonic_us;     // timebase_now_us() at the anchor
+    int64_t wall_us;           // Microseconds since the Unix epoch at the same instant
+} TimebaseAnchor;
+
+uint64_t timebase_now_us(void);
+void timebase_start_session(TimebaseAnchor* anchor);
+int timebase_get_anchor(TimebaseAnchor* anchor);
+int64_t timebase_to_wall_us(uint64_t timestamp_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMEBASE_H */
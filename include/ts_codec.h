@@ -0,0 +1,63 @@
+#ifndef TS_CODEC_H
+#define TS_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Time-series codecs for log column blocks
+ *
+ * DOD:  delta-of-delta, zigzag varint per value. Timestamps on a steady
+ *       sample grid cost about one byte each, integer channels likewise.
+ * XOR:  Gorilla-style float encoding. Each value is XORed with the one
+ *       before; repeats cost one bit and slowly moving values only the
+ *       bits that changed.
+ * RLE:  runs of bit-identical values, for slow channels.
+ *
+ * Encoders return the encoded size, or 0 when the result would not fit
+ * in capacity; callers pass the raw block size and store raw on 0.
+ */
+#define TS_CODEC_RAW 0
+#define TS_CODEC_DOD 1
+#define TS_CODEC_XOR 2
+#define TS_CODEC_RLE 3
+
+/* Value types of a block */
+#define TS_TYPE_F32 0
+#define TS_TYPE_F64 1
+#define TS_TYPE_I32 2
+#define TS_TYPE_U8  3
+#define TS_TYPE_U64 4
+
+size_t ts_type_size(uint8_t type);
+
+size_t ts_encode_dod(const uint64_t* values, size_t count, uint8_t* out, size_t capacity);
+int ts_decode_dod(const uint8_t* in, size_t size, uint64_t* values, size_t count);
+
+/* width is 32 or 64; values hold the float bit patterns */
+size_t ts_encode_xor(const void* values, size_t count, unsigned width,
+                     uint8_t* out, size_t capacity);
+int ts_decode_xor(const uint8_t* in, size_t size, unsigned width, void* values, size_t count);
+
+size_t ts_encode_rle(const void* values, size_t count, size_t value_size,
+                     uint8_t* out, size_t capacity);
+int ts_decode_rle(const uint8_t* in, size_t size, size_t value_size, void* values, size_t count);
+
+/* Encode a block with the codec that suits its type and content. Sets
+ * codec to TS_CODEC_RAW and returns 0 when nothing beats raw. */
+size_t ts_encode_block(const void* values, size_t count, uint8_t type,
+                       uint8_t* out, size_t capacity, uint8_t* codec);
+int ts_decode_block(uint8_t codec, uint8_t type, const uint8_t* in, size_t size,
+                    void* values, size_t count);
+
+/* Encode/decode throughput and ratio over synthetic sensor channels */
+int ts_codec_benchmark(size_t samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TS_CODEC_H */
@@ -678,6 +678,9 @@ Public License instead of this License.  But first, please read
 */
 #include "serial.h"
 #include <QSerialPortInfo>
+extern "C" {
+#include "adapter_caps.h"
+}
 
 void serial::onStart()
 {
@@ -688,11 +691,19 @@ void serial::onStart()
     connect(timer, SIGNAL(timeout()), this, SLOT(sendToOBD()),Qt::DirectConnection);
 
 
-    pidList
-            <<"33 46 49 0C 3C"
-           <<"0D 04 05 0F 13 2F ";
-
+    pidList = ConnectionSupervisor::templatePidList("logger.a2l");
+    if (pidList.isEmpty())
+        pidList
+                <<"33 46 49 0C 3C"
+               <<"0D 04 05 0F 13 2F ";
 
+    supervisor = new ConnectionSupervisor("serial", this);
+    connect(supervisor, SIGNAL(connectRequested()), this, SLOT(openPort()));
+    connect(supervisor, SIGNAL(disconnectRequested()), this, SLOT(closePort()));
+    connect(supervisor, SIGNAL(writeCommand(QString)), this, SLOT(writeCommand(QString)));
+    connect(supervisor, SIGNAL(initialized()), timer, SLOT(start()));
+    connect(supervisor, SIGNAL(linkStatus(bool)), this, SIGNAL(linkStatus(bool)));
+    connect(supervisor, SIGNAL(outageReported(qint64)), this, SIGNAL(outageReported(qint64)));
 
 
 }
@@ -700,9 +711,25 @@ void serial::onStart()
 
 void serial::connector(QString port)
 {
+    portName = port;
+    supervisor->start();
+}
+
+void serial::openPort()
+{
+    closePort();
+
+    // Registry hit: open at the adapter's real power-on rate instead of guessing
+    QString adapterId = ConnectionSupervisor::serialAdapterId(portName);
+    qint32 baud = QSerialPort::Baud9600;
+    AdapterCapabilities caps;
+    if(adapter_caps_lookup(adapterId.toLatin1().constData(), &caps) == 0 && caps.default_baudrate)
+        baud = caps.default_baudrate;
+    supervisor->setAdapter(adapterId, quint32(baud));
+
     sPort = new QSerialPort(this);
-    sPort->setPortName(port);
-    sPort->setBaudRate(QSerialPort::Baud9600);
+    sPort->setPortName(portName);
+    sPort->setBaudRate(baud);
     sPort->setDataBits(QSerialPort::Data8) ;
     sPort->setParity(QSerialPort::NoParity);
     sPort->setStopBits(QSerialPort::OneStop) ;
@@ -710,43 +737,82 @@ void serial::connector(QString port)
 
 
 
-    if(sPort->open(QIODevice::ReadWrite)) //initiallisation de l'obd it's ugly i know
+    if(sPort->open(QIODevice::ReadWrite))
     {
         qDebug() << "nice opened"  ;
 
-
         connect(sPort, SIGNAL(readyRead()), this, SLOT(readyReadSerial())); // obd kiyarsalek text cette method tt'executa
-        sPort->write(QString("AT E0").toLatin1()+endOfRequest); // Echo Off
-        QThread::msleep(400);
-        sPort->write(QString("AT L0").toLatin1()+endOfRequest); // Linefeeds Off
-        QThread::msleep(400);
-        sPort->write(QString("AT ST 00").toLatin1()+endOfRequest); // Set Timeout to hh x 4 msec ... timeout = 0
-        QThread::msleep(400);
-        sPort->write(QString("AT SP 00").toLatin1()+endOfRequest); // set Protocol to Auto and Save it
-        timer->start();
-
+        connect(sPort, SIGNAL(errorOccurred(QSerialPort::SerialPortError)),
+                this, SLOT(onSerialError(QSerialPort::SerialPortError)));
+        supervisor->onTransportConnected();
     }
     else
     {
-        qDebug() << "there is a problem " << sPort->errorString();
-
+        QString reason = sPort->errorString();
+        qDebug() << "there is a problem " << reason;
+        supervisor->onTransportLost(reason);
     }
 
 
 
 }
+
+void serial::closePort()
+{
+    timer->stop();
+    rxBuffer.clear(); // drop the half-received reply, keep everything already emitted
+
+    if(sPort)
+    {
+        disconnect(sPort, nullptr, this, nullptr);
+        sPort->close();
+        sPort->deleteLater();
+        sPort = nullptr;
+    }
+}
+
+void serial::writeCommand(QString command)
+{
+    if(sPort)
+        sPort->write(command.toLatin1()+endOfRequest);
+}
+
+void serial::onSerialError(QSerialPort::SerialPortError error)
+{
+    // ResourceError is what an unplugged adapter reports
+    if(error == QSerialPort::ResourceError ||
+       error == QSerialPort::ReadError ||
+       error == QSerialPort::WriteError)
+        supervisor->onTransportLost(sPort ? sPort->errorString() : QString("port error"));
+}
+
 void serial::readyReadSerial()
 {
 
-    QString data = sPort->readAll();
-    qDebug()<<"readyReadSerial(): "+data;
-    data.remove("00D \r0: ");
-    data.remove("\r1: ");
-    emit serialReply(data);
+    QByteArray chunk = sPort->readAll();
+    supervisor->onDataReceived(chunk);
+    if(!supervisor->isConnected())
+        return; // init sequence replies
+
+    // Replies are framed by the ELM '>' prompt
+    rxBuffer.append(chunk);
+    int end;
+    while((end = rxBuffer.indexOf('>')) >= 0)
+    {
+        QString data = QString::fromLatin1(rxBuffer.left(end)).trimmed();
+        rxBuffer.remove(0, end + 1);
+        qDebug()<<"readyReadSerial(): "+data;
+        data.remove("00D \r0: ");
+        data.remove("\r1: ");
+        emit serialReply(data);
+    }
 }
 
 void serial::sendToOBD()
 {
+    if(!sPort || !supervisor->isConnected())
+        return;
+
     QString pid="01 "+pidList.at(index);
 
     sPort->write(pid.toLatin1()+endOfRequest);
@@ -762,6 +828,7 @@ void serial::sendToOBD()
 void serial::onTimerIntervalChanged(int msec)
 {
     timer->setInterval(msec);
+    supervisor->setWatchdogInterval(qMax(2000, msec * 5));
 }
 
 
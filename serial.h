@@ -685,6 +685,7 @@ Public License instead of this License.  But first, please read
 #include <QDateTime>
 #include <QSerialPort>
 #include <QThread>
+#include "connectionsupervisor.h"
 
 
 
@@ -697,6 +698,8 @@ public:
 signals:
     void serialReply(QString);
     void sendToOBD(QString data);
+    void linkStatus(bool);
+    void outageReported(qint64);
 public slots:
     void onStart();
     void connector(QString);
@@ -704,13 +707,20 @@ public slots:
 private slots:
     void readyReadSerial();
     void sendToOBD();
+    void openPort();
+    void closePort();
+    void writeCommand(QString);
+    void onSerialError(QSerialPort::SerialPortError);
 
 private:
     QSerialPort *sPort = nullptr;
     QTimer *timer ;
     QStringList pidList;
     char endOfRequest = 13;
-    int index;
+    int index = 0;
+    QString portName;
+    QByteArray rxBuffer;
+    ConnectionSupervisor *supervisor = nullptr;
 };
 
 #endif // SERIAL_H
@@ -0,0 +1,191 @@
+#include "adapter_caps.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Registry state */
+static struct {
+    AdapterCapabilities entries[ADAPTER_CAPS_MAX_ENTRIES];
+    size_t count;
+    uint8_t loaded;
+    char path[256];
+} caps_registry = {0};
+
+static AdapterCapabilities* caps_find(const char* adapter_id) {
+    for (size_t i = 0; i < caps_registry.count; i++) {
+        if (strcmp(caps_registry.entries[i].adapter_id, adapter_id) == 0) {
+            return &caps_registry.entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void caps_ensure_loaded(void) {
+    if (!caps_registry.loaded) {
+        adapter_caps_load(caps_registry.path[0] ? caps_registry.path
+                                                : ADAPTER_CAPS_DEFAULT_PATH);
+    }
+}
+
+/* Load registry. One adapter per line, same '|' layout as the DTC database:
+ * id|identity|default_baud|max_baud|max_pids|monitor|periodic|can_fd|protocol|probed_at */
+int adapter_caps_load(const char* path) {
+    if (!path) return -1;
+    
+    snprintf(caps_registry.path, sizeof(caps_registry.path), "%s", path);
+    caps_registry.count = 0;
+    caps_registry.loaded = 1;
+    
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        DEBUG_PRINT(DEBUG_LEVEL_DEBUG, "No adapter capability registry at %s", path);
+        return 0;   // Empty registry is not an error
+    }
+    
+    char line[512];
+    while (fgets(line, sizeof(line), fp) && caps_registry.count < ADAPTER_CAPS_MAX_ENTRIES) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        
+        AdapterCapabilities caps;
+        memset(&caps, 0, sizeof(caps));
+        
+        char* fields[10];
+        size_t n = 0;
+        char* cursor = line;
+        while (n < 10) {
+            fields[n++] = cursor;
+            char* sep = strchr(cursor, '|');
+            if (!sep) break;
+            *sep = '\0';
+            cursor = sep + 1;
+        }
+        if (n != 10) continue;
+        
+        snprintf(caps.adapter_id, sizeof(caps.adapter_id), "%s", fields[0]);
+        snprintf(caps.identity, sizeof(caps.identity), "%s", fields[1]);
+        caps.default_baudrate = (uint32_t)strtoul(fields[2], NULL, 10);
+        caps.max_baudrate = (uint32_t)strtoul(fields[3], NULL, 10);
+        caps.max_pids_per_request = (uint8_t)atoi(fields[4]);
+        caps.monitor_mode = atoi(fields[5]) != 0;
+        caps.periodic_slots = (uint8_t)atoi(fields[6]);
+        caps.can_fd = atoi(fields[7]) != 0;
+        caps.protocol = (uint8_t)atoi(fields[8]);
+        caps.probed_at = (uint32_t)strtoul(fields[9], NULL, 10);
+        
+        caps_registry.entries[caps_registry.count++] = caps;
+    }
+    
+    fclose(fp);
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Loaded %zu adapter capability entries", caps_registry.count);
+    return 0;
+}
+
+int adapter_caps_save(const char* path) {
+    if (!path) path = caps_registry.path[0] ? caps_registry.path : ADAPTER_CAPS_DEFAULT_PATH;
+    
+    // Write to a temporary file and rename so a crash never leaves a torn registry
+    char tmp_path[280];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    
+    FILE* fp = fopen(tmp_path, "w");
+    if (!fp) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to write adapter registry: %s", tmp_path);
+        return -1;
+    }
+    
+    fprintf(fp, "# id|identity|default_baud|max_baud|max_pids|monitor|periodic|can_fd|protocol|probed_at\n");
+    for (size_t i = 0; i < caps_registry.count; i++) {
+        const AdapterCapabilities* caps = &caps_registry.entries[i];
+        fprintf(fp, "%s|%s|%u|%u|%u|%d|%u|%d|%u|%u\n",
+                caps->adapter_id, caps->identity,
+                caps->default_baudrate, caps->max_baudrate,
+                caps->max_pids_per_request, caps->monitor_mode ? 1 : 0,
+                caps->periodic_slots, caps->can_fd ? 1 : 0,
+                caps->protocol, caps->probed_at);
+    }
+    
+    if (fclose(fp) != 0 || rename(tmp_path, path) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to commit adapter registry: %s", path);
+        remove(tmp_path);
+        return -1;
+    }
+    
+    return 0;
+}
+
+int adapter_caps_lookup(const char* adapter_id, AdapterCapabilities* caps) {
+    if (!adapter_id || !caps) return -1;
+    
+    caps_ensure_loaded();
+    
+    AdapterCapabilities* entry = caps_find(adapter_id);
+    if (!entry) return -1;
+    
+    *caps = *entry;
+    return 0;
+}
+
+int adapter_caps_store(const AdapterCapabilities* caps) {
+    if (!caps || !caps->adapter_id[0]) return -1;
+    
+    caps_ensure_loaded();
+    
+    AdapterCapabilities* entry = caps_find(caps->adapter_id);
+    if (!entry) {
+        if (caps_registry.count >= ADAPTER_CAPS_MAX_ENTRIES) {
+            // Evict the oldest probe
+            size_t oldest = 0;
+            for (size_t i = 1; i < caps_registry.count; i++) {
+                if (caps_registry.entries[i].probed_at < caps_registry.entries[oldest].probed_at) {
+                    oldest = i;
+                }
+            }
+            entry = &caps_registry.entries[oldest];
+        } else {
+            entry = &caps_registry.entries[caps_registry.count++];
+        }
+    }
+    
+    *entry = *caps;
+    return 0;
+}
+
+int adapter_caps_forget(const char* adapter_id) {
+    if (!adapter_id) return -1;
+    
+    caps_ensure_loaded();
+    
+    AdapterCapabilities* entry = caps_find(adapter_id);
+    if (!entry) return -1;
+    
+    *entry = caps_registry.entries[--caps_registry.count];
+    return adapter_caps_save(NULL);
+}
+
+int adapter_caps_resolve(DeviceInterface* device, const char* adapter_id,
+                         AdapterCapabilities* caps) {
+    if (!device || !adapter_id || !caps) return -1;
+    
+    if (adapter_caps_lookup(adapter_id, caps) != 0) {
+        if (!device->probe_capabilities) return -1;
+        
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Probing capabilities of adapter %s", adapter_id);
+        
+        memset(caps, 0, sizeof(*caps));
+        snprintf(caps->adapter_id, sizeof(caps->adapter_id), "%s", adapter_id);
+        if (device->probe_capabilities(caps) != 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Capability probe failed for %s", adapter_id);
+            return -1;
+        }
+        
+        caps->probed_at = (uint32_t)time(NULL);
+        adapter_caps_store(caps);
+        adapter_caps_save(NULL);
+    }
+    
+    if (device->apply_capabilities) {
+        return device->apply_capabilities(caps);
+    }
+    return 0;
+}
@@ -0,0 +1,1059 @@
+#include "column_log.h"
+#include "ts_codec.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#define COLUMN_LOG_MAGIC     "OBDCLOG"
+#define COLUMN_CHUNK_MAGIC   0x4B4E4843u   // "CHNK"
+#define COLUMN_CHUNK_PACKED  0x5A4E4843u   // "CHNZ", blocks encoded by ts_codec
+#define COLUMN_CHUNK_END     0x444E4543u   // "CEND"
+#define COLUMN_INDEX_MAGIC   0x58495443u   // "CTIX"
+
+/* On-disk structures. All sizes are multiples of 8 so every block that
+ * follows stays aligned. */
+typedef struct {
+    char magic[8];             // "OBDCLOG\0"
+    uint32_t version;
+    uint32_t channel_count;
+    uint32_t chunk_rows;       // Rows per full chunk
+    uint32_t header_size;      // Header plus schema, offset of the first chunk
+    int64_t anchor_wall_us;    // Timebase anchor of the session
+    uint64_t anchor_monotonic_us;
+    uint8_t reserved[24];
+} ColumnFileHeader;
+
+typedef struct {
+    uint32_t magic;            // COLUMN_CHUNK_MAGIC
+    uint32_t rows;
+    uint64_t size;             // Whole chunk including header and footer
+} ColumnChunkHeader;
+
+/* Packed chunks list their blocks after the header: timestamps first,
+ * then one entry per channel */
+typedef struct {
+    uint32_t size;             // Encoded bytes, before padding to 8
+    uint8_t codec;             // TS_CODEC_*
+    uint8_t reserved[3];
+} ColumnBlockEntry;
+
+typedef struct {
+    double min;
+    double max;
+    uint32_t count;
+    uint32_t reserved;
+} ColumnChunkStat;
+
+typedef struct {
+    uint64_t t_min;
+    uint64_t t_max;
+    uint32_t magic;            // COLUMN_CHUNK_END
+    uint32_t rows;
+    uint64_t offset;           // File offset of this chunk's header
+} ColumnChunkTrailer;
+
+/* Sparse time index, one entry per chunk in time order. Seeks search
+ * this alone and touch a single chunk. */
+typedef struct {
+    uint64_t t_min;
+    uint64_t t_max;
+    uint64_t offset;           // File offset of the chunk header
+} ColumnIndexEntry;
+
+typedef struct {
+    uint64_t index_offset;     // Array of chunk_count ColumnIndexEntry
+    uint64_t chunk_count;
+    uint32_t magic;            // COLUMN_INDEX_MAGIC
+    uint32_t reserved;
+} ColumnFileTrailer;
+
+_Static_assert(sizeof(ColumnFileHeader) == 64, "file header layout");
+_Static_assert(sizeof(ColumnLogChannel) == 64, "schema entry layout");
+_Static_assert(COLUMN_TYPE_F32 == TS_TYPE_F32 && COLUMN_TYPE_F64 == TS_TYPE_F64 &&
+               COLUMN_TYPE_I32 == TS_TYPE_I32 && COLUMN_TYPE_U8 == TS_TYPE_U8,
+               "column types are passed to ts_codec as-is");
+
+static const uint8_t column_padding[8];
+
+static size_t column_block_size(uint8_t type, size_t rows) {
+    return (ts_type_size(type) * rows + 7) & ~(size_t)7;
+}
+
+/* Writer */
+struct ColumnLog {
+    int fd;
+    char path[256];
+    ColumnFileHeader header;
+    ColumnLogChannel* channels;
+    size_t channel_count;
+    
+    /* Current chunk, one buffer per column */
+    uint32_t rows;
+    uint64_t* timestamps;
+    uint8_t** columns;
+    ColumnChunkStat* stats;
+    struct iovec* iov;
+    
+    /* Compression, per block of each chunk */
+    int compress;
+    uint8_t** encoded;         // Encoded output per block, raw block size
+    ColumnBlockEntry* directory;
+    
+    uint64_t offset;           // File offset of the next chunk
+    int header_written;        // Header goes out with the first chunk
+    int anchor_set;            // Anchor given by the caller, not the timebase
+    ColumnIndexEntry* index;   // Chunks written so far
+    size_t chunk_count;
+    size_t index_capacity;
+    int failed;
+};
+
+static void column_reset_stats(ColumnLog* log) {
+    for (size_t c = 0; c < log->channel_count; c++) {
+        log->stats[c].min = INFINITY;
+        log->stats[c].max = -INFINITY;
+        log->stats[c].count = 0;
+        log->stats[c].reserved = 0;
+    }
+}
+
+static int column_writev(ColumnLog* log, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(log->fd, iov, count);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Column log write to %s failed: %s",
+                        log->path, strerror(errno));
+            log->failed = 1;
+            return -1;
+        }
+        log->offset += (uint64_t)n;
+    
+        // Skip what went out, resume mid-vector after a short write
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+ColumnLog* column_log_create(const char* path, const ColumnLogChannel* channels,
+                             size_t channel_count, uint32_t chunk_rows) {
+    if (!path || (channel_count && !channels) || channel_count > COLUMN_LOG_MAX_CHANNELS) {
+        return NULL;
+    }
+    
+    ColumnLog* log = calloc(1, sizeof(ColumnLog));
+    if (!log) return NULL;
+    
+    snprintf(log->path, sizeof(log->path), "%s", path);
+    log->channel_count = channel_count;
+    chunk_rows = chunk_rows ? chunk_rows : COLUMN_LOG_DEFAULT_ROWS;
+    
+    log->channels = calloc(channel_count ? channel_count : 1, sizeof(ColumnLogChannel));
+    log->columns = calloc(channel_count ? channel_count : 1, sizeof(uint8_t*));
+    log->stats = calloc(channel_count ? channel_count : 1, sizeof(ColumnChunkStat));
+    log->iov = calloc(2 * channel_count + 8, sizeof(struct iovec));
+    log->timestamps = malloc(chunk_rows * sizeof(uint64_t));
+    int ok = log->channels && log->columns && log->stats && log->iov && log->timestamps;
+    for (size_t c = 0; ok && c < channel_count; c++) {
+        log->channels[c] = channels[c];
+        log->channels[c].name[sizeof(log->channels[c].name) - 1] = '\0';
+        log->channels[c].unit[sizeof(log->channels[c].unit) - 1] = '\0';
+        if (log->channels[c].type > COLUMN_TYPE_U8) log->channels[c].type = COLUMN_TYPE_F32;
+        log->columns[c] = malloc(column_block_size(log->channels[c].type, chunk_rows));
+        ok = log->columns[c] != NULL;
+    }
+    
+    log->fd = ok ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (log->fd < 0) {
+        if (ok) DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create column log %s: %s",
+                            path, strerror(errno));
+        log->fd = -1;
+        column_log_close(log);
+        return NULL;
+    }
+    
+    memcpy(log->header.magic, COLUMN_LOG_MAGIC, sizeof(COLUMN_LOG_MAGIC));
+    log->header.version = COLUMN_LOG_VERSION;
+    log->header.channel_count = (uint32_t)channel_count;
+    log->header.chunk_rows = chunk_rows;
+    log->header.header_size = (uint32_t)(sizeof(ColumnFileHeader) +
+                                         channel_count * sizeof(ColumnLogChannel));
+    column_reset_stats(log);
+    return log;
+}
+
+/* Encode the blocks of chunks written from here on */
+int column_log_set_compression(ColumnLog* log, int enabled) {
+    if (!log) return -1;
+    
+    if (enabled && !log->encoded) {
+        uint8_t** encoded = calloc(log->channel_count + 1, sizeof(uint8_t*));
+        int ok = encoded != NULL;
+        
+        for (size_t b = 0; ok && b <= log->channel_count; b++) {
+            uint8_t type = b ? log->channels[b - 1].type : TS_TYPE_U64;
+            encoded[b] = malloc(ts_type_size(type) * log->header.chunk_rows);
+            ok = encoded[b] != NULL;
+        }
+        if (ok && !log->directory) {
+            log->directory = calloc(log->channel_count + 1, sizeof(ColumnBlockEntry));
+        }
+        if (!ok || !log->directory) {
+            for (size_t b = 0; encoded && b <= log->channel_count; b++) free(encoded[b]);
+            free(encoded);
+            return -1;
+        }
+        log->encoded = encoded;
+    }
+    log->compress = enabled;
+    return 0;
+}
+
+/* For rows timed by another session's clock, e.g. replayed data; must be
+ * set before the first chunk is written */
+int column_log_set_anchor(ColumnLog* log, const TimebaseAnchor* anchor) {
+    if (!log || !anchor || log->header_written) return -1;
+    
+    log->header.anchor_wall_us = anchor->wall_us;
+    log->header.anchor_monotonic_us = anchor->monotonic_us;
+    log->anchor_set = 1;
+    return 0;
+}
+
+int column_log_append(ColumnLog* log, uint64_t timestamp, const float* values) {
+    if (!log || (!values && log->channel_count)) return -1;
+    if (log->failed || log->rows >= log->header.chunk_rows) return -1;
+    
+    uint32_t row = log->rows;
+    log->timestamps[row] = timestamp;
+    
+    for (size_t c = 0; c < log->channel_count; c++) {
+        float value = values[c];
+        int present = !isnan(value);
+    
+        switch (log->channels[c].type) {
+            case COLUMN_TYPE_F64:
+                ((double*)log->columns[c])[row] = value;
+                break;
+            case COLUMN_TYPE_I32:
+                ((int32_t*)log->columns[c])[row] = present ? (int32_t)lrintf(value) : 0;
+                break;
+            case COLUMN_TYPE_U8:
+                ((uint8_t*)log->columns[c])[row] = !present || value <= 0.0f ? 0 :
+                                                   value >= 255.0f ? 255 : (uint8_t)lrintf(value);
+                break;
+            default:
+                ((float*)log->columns[c])[row] = value;
+                break;
+        }
+    
+        if (present) {
+            ColumnChunkStat* stat = &log->stats[c];
+            if (value < stat->min) stat->min = value;
+            if (value > stat->max) stat->max = value;
+            stat->count++;
+        }
+    }
+    
+    if (++log->rows == log->header.chunk_rows) {
+        return column_log_flush(log);
+    }
+    return 0;
+}
+
+/* A chunk that could not be written is lost; the buffers start over so
+ * appends never run past them */
+static void column_drop_chunk(ColumnLog* log) {
+    DEBUG_PRINT(DEBUG_LEVEL_WARN, "Column log %s dropped a chunk of %u rows",
+                log->path, (unsigned)log->rows);
+    log->rows = 0;
+    column_reset_stats(log);
+}
+
+/* Write the buffered rows as one chunk, partial or full, in a single writev */
+int column_log_flush(ColumnLog* log) {
+    if (!log) return -1;
+    if (log->failed) return -1;
+    if (log->rows == 0 && log->header_written) return 0;
+    
+    struct iovec* iov = log->iov;
+    int count = 0;
+    
+    // The anchor is taken when data first goes out, after the session started
+    if (!log->header_written) {
+        if (!log->anchor_set) {
+            TimebaseAnchor anchor;
+            timebase_get_anchor(&anchor);
+            log->header.anchor_wall_us = anchor.wall_us;
+            log->header.anchor_monotonic_us = anchor.monotonic_us;
+        }
+    
+        iov[count++] = (struct iovec){ &log->header, sizeof(log->header) };
+        if (log->channel_count) {
+            iov[count++] = (struct iovec){ log->channels,
+                                           log->channel_count * sizeof(ColumnLogChannel) };
+        }
+        if (column_writev(log, iov, count) != 0) return -1;
+        log->header_written = 1;
+        count = 0;
+        if (log->rows == 0) return 0;
+    }
+    
+    size_t rows = log->rows;
+    ColumnChunkHeader chunk = { log->compress ? COLUMN_CHUNK_PACKED : COLUMN_CHUNK_MAGIC,
+                                log->rows, sizeof(ColumnChunkHeader) };
+    ColumnChunkTrailer trailer = {
+        .t_min = log->timestamps[0],
+        .t_max = log->timestamps[rows - 1],
+        .magic = COLUMN_CHUNK_END,
+        .rows = log->rows,
+        .offset = log->offset
+    };
+    
+    iov[count++] = (struct iovec){ &chunk, sizeof(chunk) };
+    if (log->compress) {
+        iov[count++] = (struct iovec){ log->directory,
+                                       (log->channel_count + 1) * sizeof(ColumnBlockEntry) };
+        chunk.size += (log->channel_count + 1) * sizeof(ColumnBlockEntry);
+    }
+    
+    // Block 0 is the timestamps, block c + 1 channel c
+    for (size_t b = 0; b <= log->channel_count; b++) {
+        const void* data = b ? (const void*)log->columns[b - 1] : (const void*)log->timestamps;
+        uint8_t type = b ? log->channels[b - 1].type : TS_TYPE_U64;
+        size_t used = ts_type_size(type) * rows;
+        
+        if (log->compress) {
+            uint8_t codec;
+            size_t packed = ts_encode_block(data, rows, type, log->encoded[b], used, &codec);
+            if (codec != TS_CODEC_RAW) {
+                data = log->encoded[b];
+                used = packed;
+            }
+            log->directory[b] = (ColumnBlockEntry){ (uint32_t)used, codec, {0} };
+        }
+        
+        size_t block = (used + 7) & ~(size_t)7;
+        iov[count++] = (struct iovec){ (void*)data, used };
+        if (block > used) iov[count++] = (struct iovec){ (void*)column_padding, block - used };
+        chunk.size += block;
+    }
+    
+    for (size_t c = 0; c < log->channel_count; c++) {
+        if (log->stats[c].count == 0) {
+            log->stats[c].min = NAN;
+            log->stats[c].max = NAN;
+        }
+    }
+    if (log->channel_count) {
+        iov[count++] = (struct iovec){ log->stats, log->channel_count * sizeof(ColumnChunkStat) };
+    }
+    iov[count++] = (struct iovec){ &trailer, sizeof(trailer) };
+    chunk.size += log->channel_count * sizeof(ColumnChunkStat) + sizeof(trailer);
+    
+    if (log->chunk_count == log->index_capacity) {
+        size_t capacity = log->index_capacity ? log->index_capacity * 2 : 64;
+        ColumnIndexEntry* index = realloc(log->index, capacity * sizeof(ColumnIndexEntry));
+        if (!index) {
+            column_drop_chunk(log);
+            return -1;
+        }
+        log->index = index;
+        log->index_capacity = capacity;
+    }
+    log->index[log->chunk_count] = (ColumnIndexEntry){ trailer.t_min, trailer.t_max,
+                                                       trailer.offset };
+    
+    if (column_writev(log, iov, count) != 0) {
+        column_drop_chunk(log);
+        return -1;
+    }
+    
+    log->chunk_count++;
+    log->rows = 0;
+    column_reset_stats(log);
+    return 0;
+}
+
+static int column_pwrite_all(ColumnLog* log, const void* data, size_t length, uint64_t offset) {
+    const uint8_t* bytes = data;
+    
+    while (length > 0) {
+        ssize_t n = pwrite(log->fd, bytes, length, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Column log write to %s failed: %s",
+                        log->path, strerror(errno));
+            log->failed = 1;
+            return -1;
+        }
+        bytes += n;
+        length -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+/* Put the chunk index and trailer after the last chunk without moving the
+ * write position, so the next chunk overwrites them. A file synced this
+ * way opens from the index even if it is never closed. */
+static int column_write_index(ColumnLog* log) {
+    ColumnFileTrailer trailer = {
+        .index_offset = log->offset,
+        .chunk_count = log->chunk_count,
+        .magic = COLUMN_INDEX_MAGIC
+    };
+    size_t index_size = log->chunk_count * sizeof(ColumnIndexEntry);
+    
+    if (column_pwrite_all(log, log->index, index_size, log->offset) != 0 ||
+        column_pwrite_all(log, &trailer, sizeof(trailer), log->offset + index_size) != 0) {
+        return -1;
+    }
+    // Drop whatever an earlier, longer index left behind
+    return ftruncate(log->fd, (off_t)(log->offset + index_size + sizeof(trailer)));
+}
+
+int column_log_sync(ColumnLog* log) {
+    if (column_log_flush(log) != 0 || column_write_index(log) != 0) return -1;
+    return fdatasync(log->fd) == 0 ? 0 : -1;
+}
+
+/* Writes the last chunk and the chunk index; the file is complete and
+ * opens without a scan afterwards */
+int column_log_close(ColumnLog* log) {
+    if (!log) return -1;
+    
+    int status = 0;
+    if (log->fd >= 0) {
+        status = column_log_flush(log);
+        if (status == 0) status = column_write_index(log);
+        if (fdatasync(log->fd) != 0) status = -1;
+        if (close(log->fd) != 0) status = -1;
+    }
+    
+    for (size_t c = 0; log->columns && c < log->channel_count; c++) {
+        free(log->columns[c]);
+    }
+    for (size_t b = 0; log->encoded && b <= log->channel_count; b++) {
+        free(log->encoded[b]);
+    }
+    free(log->encoded);
+    free(log->directory);
+    free(log->columns);
+    free(log->channels);
+    free(log->stats);
+    free(log->iov);
+    free(log->timestamps);
+    free(log->index);
+    free(log);
+    return status;
+}
+
+int column_log_is_csv_path(const char* path) {
+    size_t length = path ? strlen(path) : 0;
+    return length >= 4 && strcasecmp(path + length - 4, ".csv") == 0;
+}
+
+size_t column_log_consume(void* context, const void* record) {
+    ColumnLog* log = context;
+    uint64_t before = log->offset;
+    
+    if (record) {
+        uint64_t timestamp;
+        memcpy(&timestamp, record, sizeof(timestamp));
+        column_log_append(log, timestamp, (const float*)((const uint8_t*)record + sizeof(uint64_t)));
+    } else {
+        column_log_sync(log);
+    }
+    return (size_t)(log->offset - before);
+}
+
+/* Reader */
+struct ColumnLogReader {
+    const uint8_t* base;
+    size_t size;
+    const ColumnFileHeader* header;
+    const ColumnLogChannel* channels;
+    size_t channel_count;
+    const ColumnIndexEntry* index;  // Into the mapping or owned
+    ColumnIndexEntry* owned;   // Index rebuilt by scanning
+    size_t chunk_count;
+};
+
+static const ColumnChunkHeader* column_chunk_at(const ColumnLogReader* reader, uint64_t offset) {
+    if (offset % 8 || offset + sizeof(ColumnChunkHeader) > reader->size) return NULL;
+    
+    const ColumnChunkHeader* chunk = (const ColumnChunkHeader*)(reader->base + offset);
+    if (chunk->rows == 0 || chunk->rows > reader->header->chunk_rows) return NULL;
+    
+    size_t expected = sizeof(ColumnChunkHeader) + reader->channel_count * sizeof(ColumnChunkStat) +
+                      sizeof(ColumnChunkTrailer);
+    if (chunk->magic == COLUMN_CHUNK_PACKED) {
+        size_t directory = (reader->channel_count + 1) * sizeof(ColumnBlockEntry);
+        if (sizeof(ColumnChunkHeader) + directory > reader->size - offset) return NULL;
+        
+        const ColumnBlockEntry* entry = (const ColumnBlockEntry*)(chunk + 1);
+        expected += directory;
+        for (size_t b = 0; b <= reader->channel_count; b++) {
+            expected += ((size_t)entry[b].size + 7) & ~(size_t)7;
+        }
+    } else if (chunk->magic == COLUMN_CHUNK_MAGIC) {
+        expected += chunk->rows * sizeof(uint64_t);
+        for (size_t c = 0; c < reader->channel_count; c++) {
+            expected += column_block_size(reader->channels[c].type, chunk->rows);
+        }
+    } else {
+        return NULL;
+    }
+    
+    if (chunk->size != expected || chunk->size > reader->size - offset) return NULL;
+    const ColumnChunkTrailer* trailer = (const ColumnChunkTrailer*)
+        (reader->base + offset + chunk->size - sizeof(ColumnChunkTrailer));
+    if (trailer->magic != COLUMN_CHUNK_END || trailer->rows != chunk->rows ||
+        trailer->offset != offset) {
+        return NULL;
+    }
+    return chunk;
+}
+
+/* Use the index written at close; without one, walk the chunks from the
+ * start and stop at the first incomplete one */
+static int column_load_index(ColumnLogReader* reader) {
+    uint64_t data_start = reader->header->header_size;
+    
+    if (reader->size >= data_start + sizeof(ColumnFileTrailer)) {
+        const ColumnFileTrailer* trailer = (const ColumnFileTrailer*)
+            (reader->base + reader->size - sizeof(ColumnFileTrailer));
+        uint64_t index_end = reader->size - sizeof(ColumnFileTrailer);
+    
+        if (trailer->magic == COLUMN_INDEX_MAGIC && trailer->index_offset >= data_start &&
+            trailer->index_offset % 8 == 0 && trailer->index_offset <= index_end &&
+            (index_end - trailer->index_offset) / sizeof(ColumnIndexEntry) == trailer->chunk_count &&
+            (index_end - trailer->index_offset) % sizeof(ColumnIndexEntry) == 0) {
+            reader->index = (const ColumnIndexEntry*)(reader->base + trailer->index_offset);
+            reader->chunk_count = trailer->chunk_count;
+    
+            // Cheap check of both ends; chunk accessors validate the rest
+            if (reader->chunk_count == 0 ||
+                (column_chunk_at(reader, reader->index[0].offset) &&
+                 column_chunk_at(reader, reader->index[reader->chunk_count - 1].offset))) {
+                return 0;
+            }
+        }
+    }
+    
+    size_t capacity = 0;
+    uint64_t offset = data_start;
+    const ColumnChunkHeader* chunk;
+    
+    reader->index = NULL;
+    reader->chunk_count = 0;
+    while ((chunk = column_chunk_at(reader, offset)) != NULL) {
+        if (reader->chunk_count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            ColumnIndexEntry* owned = realloc(reader->owned, capacity * sizeof(ColumnIndexEntry));
+            if (!owned) return -1;
+            reader->owned = owned;
+        }
+        const ColumnChunkTrailer* trailer = (const ColumnChunkTrailer*)
+            (reader->base + offset + chunk->size - sizeof(ColumnChunkTrailer));
+        reader->owned[reader->chunk_count++] = (ColumnIndexEntry){ trailer->t_min, trailer->t_max,
+                                                                   offset };
+        offset += chunk->size;
+    }
+    reader->index = reader->owned;
+    
+    if (offset != reader->size) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Column log not closed cleanly, recovered %zu chunks",
+                    reader->chunk_count);
+    }
+    return 0;
+}
+
+ColumnLogReader* column_log_open(const char* path) {
+    if (!path) return NULL;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open column log %s: %s", path, strerror(errno));
+        return NULL;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ColumnFileHeader)) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Column log %s is empty", path);
+        close(fd);
+        return NULL;
+    }
+    
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to map column log %s: %s", path, strerror(errno));
+        return NULL;
+    }
+    // Column scans jump between blocks; readahead would pull in the others
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+    
+    ColumnLogReader* reader = calloc(1, sizeof(ColumnLogReader));
+    if (!reader) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->base = map;
+    reader->size = (size_t)st.st_size;
+    reader->header = map;
+    reader->channels = (const ColumnLogChannel*)(reader->base + sizeof(ColumnFileHeader));
+    reader->channel_count = reader->header->channel_count;
+    
+    const ColumnFileHeader* header = reader->header;
+    if (memcmp(header->magic, COLUMN_LOG_MAGIC, sizeof(COLUMN_LOG_MAGIC)) != 0 ||
+        header->version != COLUMN_LOG_VERSION ||
+        header->channel_count > COLUMN_LOG_MAX_CHANNELS ||
+        header->header_size != sizeof(ColumnFileHeader) +
+                               header->channel_count * sizeof(ColumnLogChannel) ||
+        header->header_size > reader->size ||
+        column_load_index(reader) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "%s is not a readable column log", path);
+        column_log_reader_close(reader);
+        return NULL;
+    }
+    
+    return reader;
+}
+
+void column_log_reader_close(ColumnLogReader* reader) {
+    if (!reader) return;
+    
+    munmap((void*)reader->base, reader->size);
+    free(reader->owned);
+    free(reader);
+}
+
+size_t column_log_channel_count(const ColumnLogReader* reader) {
+    return reader ? reader->channel_count : 0;
+}
+
+const ColumnLogChannel* column_log_channel(const ColumnLogReader* reader, size_t channel) {
+    if (!reader || channel >= reader->channel_count) return NULL;
+    return &reader->channels[channel];
+}
+
+int column_log_find_channel(const ColumnLogReader* reader, const char* name) {
+    if (!reader || !name) return -1;
+    
+    for (size_t c = 0; c < reader->channel_count; c++) {
+        if (strncmp(reader->channels[c].name, name, sizeof(reader->channels[c].name)) == 0) {
+            return (int)c;
+        }
+    }
+    return -1;
+}
+
+int column_log_get_anchor(const ColumnLogReader* reader, TimebaseAnchor* anchor) {
+    if (!reader || !anchor) return -1;
+    
+    anchor->monotonic_us = reader->header->anchor_monotonic_us;
+    anchor->wall_us = reader->header->anchor_wall_us;
+    return 0;
+}
+
+size_t column_log_chunk_count(const ColumnLogReader* reader) {
+    return reader ? reader->chunk_count : 0;
+}
+
+static const ColumnChunkHeader* column_reader_chunk(const ColumnLogReader* reader, size_t chunk) {
+    if (!reader || chunk >= reader->chunk_count) return NULL;
+    return column_chunk_at(reader, reader->index[chunk].offset);
+}
+
+int column_log_chunk_info(const ColumnLogReader* reader, size_t chunk, ColumnChunkInfo* info) {
+    const ColumnChunkHeader* header = column_reader_chunk(reader, chunk);
+    if (!header || !info) return -1;
+    
+    const ColumnChunkTrailer* trailer = (const ColumnChunkTrailer*)
+        ((const uint8_t*)header + header->size - sizeof(ColumnChunkTrailer));
+    info->rows = header->rows;
+    info->t_min = trailer->t_min;
+    info->t_max = trailer->t_max;
+    return 0;
+}
+
+int column_log_chunk_stats(const ColumnLogReader* reader, size_t chunk, size_t channel,
+                           ColumnChunkStats* stats) {
+    const ColumnChunkHeader* header = column_reader_chunk(reader, chunk);
+    if (!header || !stats || channel >= reader->channel_count) return -1;
+    
+    const ColumnChunkStat* stat = (const ColumnChunkStat*)
+        ((const uint8_t*)header + header->size - sizeof(ColumnChunkTrailer) -
+         (reader->channel_count - channel) * sizeof(ColumnChunkStat));
+    stats->min = stat->min;
+    stats->max = stat->max;
+    stats->count = stat->count;
+    return 0;
+}
+
+/* Locate block b of a chunk: 0 is the timestamps, c + 1 channel c */
+static const uint8_t* column_block(const ColumnLogReader* reader, const ColumnChunkHeader* chunk,
+                                   size_t b, size_t* size, uint8_t* codec) {
+    const uint8_t* data = (const uint8_t*)(chunk + 1);
+    
+    if (chunk->magic == COLUMN_CHUNK_PACKED) {
+        const ColumnBlockEntry* entry = (const ColumnBlockEntry*)data;
+        data += (reader->channel_count + 1) * sizeof(ColumnBlockEntry);
+        for (size_t i = 0; i < b; i++) {
+            data += ((size_t)entry[i].size + 7) & ~(size_t)7;
+        }
+        *size = entry[b].size;
+        *codec = entry[b].codec;
+        return data;
+    }
+    
+    if (b > 0) data += chunk->rows * sizeof(uint64_t);
+    for (size_t c = 0; c + 1 < b; c++) {
+        data += column_block_size(reader->channels[c].type, chunk->rows);
+    }
+    *size = (b ? ts_type_size(reader->channels[b - 1].type) : sizeof(uint64_t)) * chunk->rows;
+    *codec = TS_CODEC_RAW;
+    return data;
+}
+
+/* In-place pointer to a block stored raw, NULL for an encoded one */
+static const void* column_raw_block(const ColumnLogReader* reader, size_t chunk, size_t b,
+                                    size_t* rows) {
+    const ColumnChunkHeader* header = column_reader_chunk(reader, chunk);
+    if (!header || b > reader->channel_count) return NULL;
+    
+    uint8_t type = b ? reader->channels[b - 1].type : TS_TYPE_U64;
+    uint8_t codec;
+    size_t size;
+    const uint8_t* data = column_block(reader, header, b, &size, &codec);
+    if (codec != TS_CODEC_RAW || size != ts_type_size(type) * header->rows) return NULL;
+    
+    if (rows) *rows = header->rows;
+    return data;
+}
+
+const uint64_t* column_log_timestamps(const ColumnLogReader* reader, size_t chunk, size_t* rows) {
+    return column_raw_block(reader, chunk, 0, rows);
+}
+
+const void* column_log_column(const ColumnLogReader* reader, size_t chunk, size_t channel,
+                              size_t* rows) {
+    if (!reader || channel >= reader->channel_count) return NULL;
+    return column_raw_block(reader, chunk, channel + 1, rows);
+}
+
+/* Decode block b into its native type; returns the row count or 0 */
+static size_t column_decode_block(const ColumnLogReader* reader, size_t chunk, size_t b,
+                                  void* out, size_t capacity) {
+    const ColumnChunkHeader* header = column_reader_chunk(reader, chunk);
+    if (!header || b > reader->channel_count || header->rows > capacity) return 0;
+    
+    uint8_t type = b ? reader->channels[b - 1].type : TS_TYPE_U64;
+    uint8_t codec;
+    size_t size;
+    const uint8_t* data = column_block(reader, header, b, &size, &codec);
+    if (ts_decode_block(codec, type, data, size, out, header->rows) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Corrupt block %zu in column log chunk %zu", b, chunk);
+        return 0;
+    }
+    return header->rows;
+}
+
+size_t column_log_read_timestamps(const ColumnLogReader* reader, size_t chunk,
+                                  uint64_t* out, size_t max_rows) {
+    if (!out) return 0;
+    return column_decode_block(reader, chunk, 0, out, max_rows);
+}
+
+size_t column_log_read_floats(const ColumnLogReader* reader, size_t chunk, size_t channel,
+                              float* out, size_t max_rows) {
+    if (!reader || !out || channel >= reader->channel_count) return 0;
+    
+    uint8_t type = reader->channels[channel].type;
+    if (type == COLUMN_TYPE_F32) {
+        return column_decode_block(reader, chunk, channel + 1, out, max_rows);
+    }
+    
+    // Other types decode to a scratch block, then widen or narrow to float
+    size_t rows = reader->header->chunk_rows;
+    void* column = malloc(rows * ts_type_size(type));
+    if (!column) return 0;
+    rows = column_decode_block(reader, chunk, channel + 1, column, rows);
+    if (rows > max_rows) rows = 0;
+    
+    switch (type) {
+        case COLUMN_TYPE_F64:
+            for (size_t i = 0; i < rows; i++) out[i] = (float)((const double*)column)[i];
+            break;
+        case COLUMN_TYPE_I32:
+            for (size_t i = 0; i < rows; i++) out[i] = (float)((const int32_t*)column)[i];
+            break;
+        default:
+            for (size_t i = 0; i < rows; i++) out[i] = (float)((const uint8_t*)column)[i];
+            break;
+    }
+    free(column);
+    return rows;
+}
+
+/* Time access */
+
+/* First chunk whose last row is at or after t */
+static size_t column_seek_chunk(const ColumnLogReader* reader, uint64_t t) {
+    size_t low = 0, high = reader->chunk_count;
+    
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (reader->index[mid].t_max < t) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static size_t column_lower_bound(const uint64_t* timestamps, size_t rows, uint64_t t) {
+    size_t low = 0, high = rows;
+    
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (timestamps[mid] < t) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* Chunk timestamps, in place when stored raw, else decoded into scratch */
+static const uint64_t* column_chunk_timestamps(const ColumnLogReader* reader, size_t chunk,
+                                               uint64_t* scratch, size_t* rows) {
+    const uint64_t* timestamps = column_log_timestamps(reader, chunk, rows);
+    if (timestamps) return timestamps;
+    
+    *rows = column_log_read_timestamps(reader, chunk, scratch, reader->header->chunk_rows);
+    return *rows ? scratch : NULL;
+}
+
+int column_log_seek(const ColumnLogReader* reader, uint64_t t, ColumnLogPosition* position) {
+    if (!reader || !position) return -1;
+    
+    size_t chunk = column_seek_chunk(reader, t);
+    if (chunk >= reader->chunk_count) return -1;
+    
+    uint64_t* scratch = malloc(reader->header->chunk_rows * sizeof(uint64_t));
+    if (!scratch) return -1;
+    
+    size_t rows;
+    const uint64_t* timestamps = column_chunk_timestamps(reader, chunk, scratch, &rows);
+    if (timestamps) {
+        position->chunk = chunk;
+        position->row = column_lower_bound(timestamps, rows, t);
+    }
+    free(scratch);
+    return timestamps && position->row < rows ? 0 : -1;
+}
+
+struct ColumnLogIterator {
+    const ColumnLogReader* reader;
+    uint64_t t_end;
+    size_t chunk;              // Next chunk to read
+    size_t row;                // Where to start in it
+    size_t* channels;
+    size_t channel_count;
+    uint64_t* timestamps;      // Decode buffers, one chunk each
+    float** buffers;
+    const float** columns;     // Handed out: in-place columns or buffers
+};
+
+void column_log_iter_close(ColumnLogIterator* iter) {
+    if (!iter) return;
+    
+    for (size_t i = 0; iter->buffers && i < iter->channel_count; i++) {
+        free(iter->buffers[i]);
+    }
+    free(iter->buffers);
+    free(iter->columns);
+    free(iter->timestamps);
+    free(iter->channels);
+    free(iter);
+}
+
+ColumnLogIterator* column_log_iter_open(const ColumnLogReader* reader, uint64_t t_start,
+                                        uint64_t t_end, const size_t* channels,
+                                        size_t channel_count) {
+    if (!reader || (channel_count && !channels)) return NULL;
+    for (size_t i = 0; i < channel_count; i++) {
+        if (channels[i] >= reader->channel_count) return NULL;
+    }
+    
+    ColumnLogIterator* iter = calloc(1, sizeof(ColumnLogIterator));
+    if (!iter) return NULL;
+    
+    size_t chunk_rows = reader->header->chunk_rows;
+    iter->reader = reader;
+    iter->t_end = t_end;
+    iter->channel_count = channel_count;
+    iter->channels = calloc(channel_count ? channel_count : 1, sizeof(size_t));
+    iter->buffers = calloc(channel_count ? channel_count : 1, sizeof(float*));
+    iter->columns = calloc(channel_count ? channel_count : 1, sizeof(float*));
+    iter->timestamps = malloc(chunk_rows * sizeof(uint64_t));
+    int ok = iter->channels && iter->buffers && iter->columns && iter->timestamps;
+    for (size_t i = 0; ok && i < channel_count; i++) {
+        iter->channels[i] = channels[i];
+        iter->buffers[i] = malloc(chunk_rows * sizeof(float));
+        ok = iter->buffers[i] != NULL;
+    }
+    if (!ok) {
+        column_log_iter_close(iter);
+        return NULL;
+    }
+    
+    ColumnLogPosition start;
+    if (t_start > t_end || column_log_seek(reader, t_start, &start) != 0) {
+        iter->chunk = reader->chunk_count;
+    } else {
+        iter->chunk = start.chunk;
+        iter->row = start.row;
+    }
+    return iter;
+}
+
+size_t column_log_iter_next(ColumnLogIterator* iter, const uint64_t** timestamps,
+                            const float* const** columns) {
+    if (!iter || !timestamps || !columns) return 0;
+    
+    const ColumnLogReader* reader = iter->reader;
+    while (iter->chunk < reader->chunk_count) {
+        size_t chunk = iter->chunk++;
+        size_t start = iter->row;
+        iter->row = 0;
+        if (reader->index[chunk].t_min > iter->t_end) {
+            iter->chunk = reader->chunk_count;
+            break;
+        }
+    
+        size_t rows;
+        const uint64_t* chunk_times = column_chunk_timestamps(reader, chunk, iter->timestamps, &rows);
+        if (!chunk_times) continue;
+        size_t end = reader->index[chunk].t_max > iter->t_end ?
+                     column_lower_bound(chunk_times, rows, iter->t_end + 1) : rows;
+        if (start >= end) continue;
+    
+        for (size_t i = 0; i < iter->channel_count; i++) {
+            size_t channel = iter->channels[i];
+            size_t column_rows = 0;
+            const void* column = reader->channels[channel].type == COLUMN_TYPE_F32 ?
+                                 column_log_column(reader, chunk, channel, &column_rows) : NULL;
+            if (column && column_rows == rows) {
+                iter->columns[i] = (const float*)column + start;
+                continue;
+            }
+    
+            // Damaged blocks read as missing rather than ending the walk
+            float* buffer = iter->buffers[i];
+            if (column_log_read_floats(reader, chunk, channel, buffer,
+                                       reader->header->chunk_rows) != rows) {
+                for (size_t r = 0; r < rows; r++) buffer[r] = NAN;
+            }
+            iter->columns[i] = buffer + start;
+        }
+        *timestamps = chunk_times + start;
+        *columns = iter->columns;
+        return end - start;
+    }
+    return 0;
+}
+
+size_t column_log_read_range(const ColumnLogReader* reader, uint64_t t_start, uint64_t t_end,
+                             const size_t* channels, size_t channel_count,
+                             uint64_t* timestamps, float* const* columns, size_t max_rows) {
+    if (channel_count && !columns) return 0;
+    
+    ColumnLogIterator* iter = column_log_iter_open(reader, t_start, t_end, channels, channel_count);
+    if (!iter) return 0;
+    
+    const uint64_t* run_times;
+    const float* const* run_columns;
+    size_t copied = 0, rows;
+    while (copied < max_rows && (rows = column_log_iter_next(iter, &run_times, &run_columns)) > 0) {
+        if (rows > max_rows - copied) rows = max_rows - copied;
+        if (timestamps) memcpy(timestamps + copied, run_times, rows * sizeof(uint64_t));
+        for (size_t i = 0; i < channel_count; i++) {
+            memcpy(columns[i] + copied, run_columns[i], rows * sizeof(float));
+        }
+        copied += rows;
+    }
+    column_log_iter_close(iter);
+    return copied;
+}
+
+/* Self test */
+#define COLUMN_TEST_LOG "column_log_test.clog"
+
+int column_log_self_test(void) {
+    static const ColumnLogChannel channels[] = {
+        { "RPM", "rpm", COLUMN_TYPE_F32, {0} },
+        { "Gear", "", COLUMN_TYPE_U8, {0} }
+    };
+    int failures = 0;
+    
+    // Round trip across several chunks and a partial one
+    ColumnLog* log = column_log_create(COLUMN_TEST_LOG, channels, 2, 16);
+    for (size_t r = 0; log && r < 100; r++) {
+        float values[2] = { (float)r * 10.0f, (float)(r % 6) };
+        if (column_log_append(log, 1000 + r, values) != 0) failures++;
+    }
+    if (!log || column_log_close(log) != 0) failures++;
+    
+    ColumnLogReader* reader = column_log_open(COLUMN_TEST_LOG);
+    size_t rows = 0;
+    for (size_t c = 0; reader && c < column_log_chunk_count(reader); c++) {
+        ColumnChunkInfo info;
+        if (column_log_chunk_info(reader, c, &info) == 0) rows += info.rows;
+    }
+    if (!reader || rows != 100) failures++;
+    column_log_reader_close(reader);
+    unlink(COLUMN_TEST_LOG);
+    
+    // A full device: every flush fails, appends must stop at the chunk
+    // buffers instead of running past them
+    if (access("/dev/full", W_OK) == 0) {
+        log = column_log_create("/dev/full", channels, 2, 16);
+        size_t accepted = 0, refused = 0;
+        for (size_t r = 0; log && r < 100; r++) {
+            float values[2] = { 1.0f, 2.0f };
+            if (column_log_append(log, 1000 + r, values) == 0) {
+                accepted++;
+            } else {
+                refused++;
+            }
+        }
+        if (!log || accepted != 15 || refused != 85 || column_log_flush(log) == 0) failures++;
+        if (log && column_log_close(log) == 0) failures++;
+    }
+    
+    printf("Column log self test: %s\n", failures ? "FAILED" : "passed");
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,360 @@
+#include "csv_export.h"
+#include "column_log.h"
+#include "timebase.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#define CSV_FAST_LIMIT   2147483648.0  // Scaled values below this stay exact enough to round
+#define CSV_TIE_MARGIN   1e-6          // Closer to .5 than this goes through snprintf
+
+static const double decimal_scale[CSV_MAX_DECIMALS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/* Number formatting */
+static size_t format_unsigned(uint64_t value, char* out) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = digit_pairs[value * 2 + 1];
+        *--p = digit_pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    
+    size_t length = (size_t)(digits + sizeof(digits) - p);
+    memcpy(out, p, length);
+    return length;
+}
+
+size_t csv_format_int(int64_t value, char* out) {
+    size_t length = 0;
+    
+    if (value < 0) {
+        out[length++] = '-';
+        length += format_unsigned(0 - (uint64_t)value, out + length);
+    } else {
+        length += format_unsigned((uint64_t)value, out);
+    }
+    out[length] = '\0';
+    return length;
+}
+
+size_t csv_format_float(double value, int decimals, char* out) {
+    if (isnan(value)) {
+        out[0] = '\0';
+        return 0;
+    }
+    if (decimals < 0) decimals = 0;
+    if (decimals > CSV_MAX_DECIMALS) decimals = CSV_MAX_DECIMALS;
+    
+    // value * 10^d is exact for floats and within an ulp for doubles this
+    // small, so only values right at .5 need printf's exact tie rule
+    double scaled = fabs(value) * decimal_scale[decimals];
+    double whole = floor(scaled);
+    double fraction = scaled - whole;
+    if (isinf(value) || scaled >= CSV_FAST_LIMIT || fabs(fraction - 0.5) < CSV_TIE_MARGIN) {
+        int length = snprintf(out, CSV_NUMBER_MAX, "%.*f", decimals, value);
+        return length > 0 ? (size_t)length : 0;
+    }
+    
+    uint64_t units = (uint64_t)whole + (fraction > 0.5);
+    uint64_t divisor = (uint64_t)decimal_scale[decimals];
+    size_t length = 0;
+    if (signbit(value)) out[length++] = '-';
+    length += format_unsigned(units / divisor, out + length);
+    if (decimals > 0) {
+        uint64_t fraction_digits = units % divisor;
+        out[length++] = '.';
+        for (int d = decimals - 1; d >= 0; d--) {
+            out[length + (size_t)d] = (char)('0' + fraction_digits % 10);
+            fraction_digits /= 10;
+        }
+        length += (size_t)decimals;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/* Session export. Workers take chunks in order, format each into their
+ * own buffer, then wait for their turn to write so the file keeps the
+ * log's row order. */
+typedef struct {
+    const ColumnLogReader* reader;
+    int fd;
+    int decimals;
+    size_t channel_count;
+    size_t chunk_rows;         // Largest chunk
+    TimebaseAnchor anchor;
+    atomic_size_t next_chunk;
+    size_t next_write;         // Chunk whose turn it is, under lock
+    pthread_mutex_t lock;
+    pthread_cond_t turn;
+    atomic_int failed;
+} CsvExportJob;
+
+static int write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static size_t format_chunk(CsvExportJob* job, size_t chunk, uint64_t* timestamps,
+                           float* columns, char* out) {
+    size_t rows = column_log_read_timestamps(job->reader, chunk, timestamps, job->chunk_rows);
+    if (rows == 0) return 0;
+    for (size_t c = 0; c < job->channel_count; c++) {
+        if (column_log_read_floats(job->reader, chunk, c, columns + c * job->chunk_rows,
+                                   job->chunk_rows) != rows) {
+            return 0;
+        }
+    }
+    
+    char* p = out;
+    for (size_t r = 0; r < rows; r++) {
+        p += csv_format_int(job->anchor.wall_us +
+                            (int64_t)(timestamps[r] - job->anchor.monotonic_us), p);
+        for (size_t c = 0; c < job->channel_count; c++) {
+            *p++ = ',';
+            p += csv_format_float(columns[c * job->chunk_rows + r], job->decimals, p);
+        }
+        *p++ = '\n';
+    }
+    return (size_t)(p - out);
+}
+
+static void* export_worker(void* arg) {
+    CsvExportJob* job = arg;
+    size_t line_max = CSV_NUMBER_MAX * (job->channel_count + 1) + 1;
+    uint64_t* timestamps = malloc(job->chunk_rows * sizeof(uint64_t));
+    float* columns = malloc(job->chunk_rows * job->channel_count * sizeof(float));
+    char* out = malloc(job->chunk_rows * line_max);
+    if (!timestamps || !columns || !out) atomic_store(&job->failed, 1);
+    
+    size_t chunk;
+    while ((chunk = atomic_fetch_add(&job->next_chunk, 1)) <
+           column_log_chunk_count(job->reader)) {
+        size_t length = atomic_load(&job->failed) ? 0 :
+                        format_chunk(job, chunk, timestamps, columns, out);
+        if (length == 0) atomic_store(&job->failed, 1);
+    
+        pthread_mutex_lock(&job->lock);
+        while (job->next_write != chunk && !atomic_load(&job->failed)) {
+            pthread_cond_wait(&job->turn, &job->lock);
+        }
+        if (!atomic_load(&job->failed) && write_all(job->fd, out, length) != 0) {
+            atomic_store(&job->failed, 1);
+        }
+        job->next_write++;
+        pthread_cond_broadcast(&job->turn);
+        pthread_mutex_unlock(&job->lock);
+        if (atomic_load(&job->failed)) break;
+    }
+    
+    free(timestamps);
+    free(columns);
+    free(out);
+    return NULL;
+}
+
+int csv_export_log(const char* input_path, const char* output_path,
+                   const CsvExportOptions* options) {
+    if (!input_path || !output_path) return -1;
+    
+    if (column_log_is_csv_path(input_path)) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "%s is already CSV", input_path);
+        return -1;
+    }
+    ColumnLogReader* reader = column_log_open(input_path);
+    if (!reader) return -1;
+    
+    CsvExportJob job = {
+        .reader = reader,
+        .decimals = options && options->decimals ? options->decimals : CSV_DEFAULT_DECIMALS,
+        .channel_count = column_log_channel_count(reader),
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+        .turn = PTHREAD_COND_INITIALIZER
+    };
+    size_t chunk_count = column_log_chunk_count(reader);
+    for (size_t c = 0; c < chunk_count; c++) {
+        ColumnChunkInfo info;
+        if (column_log_chunk_info(reader, c, &info) == 0 && info.rows > job.chunk_rows) {
+            job.chunk_rows = info.rows;
+        }
+    }
+    column_log_get_anchor(reader, &job.anchor);
+    atomic_init(&job.next_chunk, 0);
+    atomic_init(&job.failed, 0);
+    
+    job.fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (job.fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create %s: %s", output_path, strerror(errno));
+        column_log_reader_close(reader);
+        return -1;
+    }
+    
+    // Channel names fit ColumnLogChannel.name, so 33 bytes a column
+    size_t header_size = sizeof("Timestamp\n") + job.channel_count * 33;
+    char* header = malloc(header_size);
+    int status = header ? 0 : -1;
+    if (header) {
+        size_t length = (size_t)snprintf(header, header_size, "Timestamp");
+        for (size_t c = 0; c < job.channel_count; c++) {
+            length += (size_t)snprintf(header + length, header_size - length, ",%s",
+                                       column_log_channel(reader, c)->name);
+        }
+        header[length++] = '\n';
+        status = write_all(job.fd, header, length);
+        free(header);
+    }
+    
+    size_t threads = options && options->threads ? options->threads :
+                     (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > CSV_EXPORT_MAX_THREADS) threads = CSV_EXPORT_MAX_THREADS;
+    if (threads > chunk_count) threads = chunk_count ? chunk_count : 1;
+    
+    pthread_t workers[CSV_EXPORT_MAX_THREADS];
+    size_t started = 0;
+    if (status == 0 && chunk_count > 0) {
+        while (started < threads &&
+               pthread_create(&workers[started], NULL, export_worker, &job) == 0) {
+            started++;
+        }
+        if (started == 0) status = -1;
+    }
+    for (size_t i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    if (atomic_load(&job.failed)) status = -1;
+    
+    if (close(job.fd) != 0) status = -1;
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.turn);
+    column_log_reader_close(reader);
+    if (status == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Exported %s to %s", input_path, output_path);
+    } else {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "CSV export of %s failed", input_path);
+        unlink(output_path);
+    }
+    return status;
+}
+
+/* Benchmark */
+#define CSV_BENCH_LOG "csv_bench.clog"
+#define CSV_BENCH_CSV "csv_bench.csv"
+
+static double bench_elapsed(const struct timespec* t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+int csv_export_benchmark(size_t rows) {
+    const size_t count = 10;
+    float* samples = malloc(rows * count * sizeof(float));
+    if (!samples || rows == 0) {
+        free(samples);
+        return -1;
+    }
+    
+    // Sensor-like values across the range the loggers see, some negative
+    uint32_t seed = 2463534242u;
+    for (size_t i = 0; i < rows * count; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        samples[i] = (float)((double)(seed % 2000000) / 100.0 - 2000.0) / (float)(1 + i % count);
+    }
+    
+    // Formatter against printf, digit for digit
+    char expected[64], actual[CSV_NUMBER_MAX];
+    size_t mismatches = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t checksum = 0;
+    for (size_t i = 0; i < rows * count; i++) {
+        checksum += (size_t)snprintf(expected, sizeof(expected), "%0.2f", samples[i]);
+    }
+    double printf_s = bench_elapsed(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < rows * count; i++) {
+        checksum += csv_format_float(samples[i], 2, actual);
+    }
+    double format_s = bench_elapsed(&start);
+    for (size_t i = 0; i < rows * count; i++) {
+        for (int d = 0; d <= 6; d += 2) {
+            snprintf(expected, sizeof(expected), "%.*f", d, samples[i]);
+            csv_format_float(samples[i], d, actual);
+            if (strcmp(expected, actual) != 0 && mismatches++ < 5) {
+                printf("  mismatch: %s vs %s\n", expected, actual);
+            }
+        }
+    }
+    printf("CSV formatting: %zu values, printf %.1f ns, csv_format_float %.1f ns, %zu mismatches\n",
+           rows * count, printf_s * 1e9 / (rows * count), format_s * 1e9 / (rows * count),
+           mismatches);
+    (void)checksum;
+    
+    // Whole-session export
+    ColumnLogChannel channels[10];
+    memset(channels, 0, sizeof(channels));
+    for (size_t c = 0; c < count; c++) {
+        snprintf(channels[c].name, sizeof(channels[c].name), "Channel%zu", c);
+        channels[c].type = COLUMN_TYPE_F32;
+    }
+    ColumnLog* log = column_log_create(CSV_BENCH_LOG, channels, count, 0);
+    uint64_t t0 = timebase_now_us();
+    for (size_t r = 0; log && r < rows; r++) {
+        column_log_append(log, t0 + r * 10000, samples + r * count);
+    }
+    free(samples);
+    if (!log || column_log_close(log) != 0) {
+        unlink(CSV_BENCH_LOG);
+        return -1;
+    }
+    
+    int status = mismatches ? -1 : 0;
+    size_t thread_counts[] = { 1, 0 };
+    for (size_t i = 0; i < 2 && status == 0; i++) {
+        CsvExportOptions options = { .threads = thread_counts[i] };
+        struct stat st;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        status = csv_export_log(CSV_BENCH_LOG, CSV_BENCH_CSV, &options);
+        double seconds = bench_elapsed(&start);
+        double mb = stat(CSV_BENCH_CSV, &st) == 0 ? st.st_size / 1e6 : 0.0;
+        printf("  export, %s: %.3f s, %.1f MB of CSV, %.1f MB/s\n",
+               thread_counts[i] ? "1 thread" : "all CPUs", seconds, mb,
+               seconds > 0 ? mb / seconds : 0.0);
+    }
+    
+    unlink(CSV_BENCH_CSV);
+    unlink(CSV_BENCH_LOG);
+    return status;
+}
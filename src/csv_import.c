@@ -0,0 +1,793 @@
+#include "csv_import.h"
+#include "csv_export.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define IMPORT_MIN_SPAN      (1024 * 1024)  // Bytes per thread worth the start-up
+#define IMPORT_FIELD_TIME    (-1)           // Field map: the row timestamp
+#define IMPORT_FIELD_SKIP    (-2)           // Field map: not imported
+#define IMPORT_NAME_MAX      128            // Longest header field kept
+#define FAST_MANTISSA_MAX    (1ULL << 53)   // Integers a double holds exactly
+#define FAST_EXPONENT_MAX    22             // Largest exact power of ten
+
+static const double exact_powers[FAST_EXPONENT_MAX + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Units of the logs written by this tree, which carry bare names */
+typedef struct {
+    const char* name;
+    const char* unit;
+} KnownUnit;
+
+static const KnownUnit performance_units[] = {
+    { "RPM", "rpm" }, { "Speed", "mph" }, { "VE", "%" }, { "MAF", "g/s" },
+    { "Torque", "Nm" }, { "Boost", "psi" }, { "IAT", "C" }, { "TPS", "%" },
+    { "G-Force", "g" }, { NULL, NULL }
+};
+
+static const KnownUnit telemetry_units[] = {
+    { "lat", "deg" }, { "lon", "deg" }, { "speed", "mph" }, { "rpm", "rpm" },
+    { "boost", "psi" }, { "throttle", "%" }, { "brake", "%" }, { "accel_x", "g" },
+    { "accel_y", "g" }, { "accel_z", "g" }, { "g_force", "g" }, { "slip_angle", "deg" },
+    { "lap_time", "s" }, { "sector_time", "s" }, { "predicted_time", "s" }, { NULL, NULL }
+};
+
+/* Number parsing. Up to 19 digits go into an integer; when it and the
+ * power of ten are both exact doubles one multiply or divide rounds
+ * correctly. Anything longer goes to strtod. */
+static inline int is_digit(char c) {
+    return (unsigned)(c - '0') < 10;
+}
+
+const char* csv_parse_double(const char* text, const char* end, double* value) {
+    const char* p = text;
+    int negative = 0;
+    
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    
+    // Every digit goes in; more than 19 may have wrapped and take strtod
+    uint64_t mantissa = 0;
+    const char* digits = p;
+    for (; p < end && is_digit(*p); p++) mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    ptrdiff_t digit_count = p - digits;
+    int exponent = 0;
+    if (p < end && *p == '.') {
+        const char* fraction = ++p;
+        for (; p < end && is_digit(*p); p++) mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        exponent = (int)(fraction - p);
+        digit_count += p - fraction;
+    }
+    if (digit_count == 0) return NULL;
+    int truncated = digit_count > 19;
+    
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        int exponent_negative = 0;
+        if (e < end && (*e == '-' || *e == '+')) exponent_negative = *e++ == '-';
+        if (e < end && is_digit(*e)) {
+            int written = 0;
+            for (; e < end && is_digit(*e); e++) {
+                if (written < 10000) written = written * 10 + (*e - '0');
+            }
+            exponent += exponent_negative ? -written : written;
+            p = e;
+        }
+    }
+    
+    double result;
+    if (!truncated && mantissa == 0) {
+        result = 0.0;
+    } else if (!truncated && mantissa <= FAST_MANTISSA_MAX &&
+               exponent >= -FAST_EXPONENT_MAX && exponent <= FAST_EXPONENT_MAX) {
+        result = exponent < 0 ? (double)mantissa / exact_powers[-exponent] :
+                                (double)mantissa * exact_powers[exponent];
+    } else {
+        // Digits a double cannot take exactly: strtod rounds them right.
+        // The copy keeps it off unterminated mapped text.
+        char copy[64];
+        size_t length = (size_t)(p - text);
+        if (length >= sizeof(copy)) length = sizeof(copy) - 1;
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+        *value = strtod(copy, NULL);
+        return p;
+    }
+    *value = negative ? -result : result;
+    return p;
+}
+
+/* Fields and records. A quote opens a quoted field only at its start;
+ * inside one, a doubled quote is a literal quote. */
+static const char* record_end(const char* p, const char* end) {
+    const char* eol = memchr(p, '\n', (size_t)(end - p));
+    const char* stop = eol ? eol : end;
+    const char* quote = memchr(p, '"', (size_t)(stop - p));
+    if (!quote) return eol ? eol + 1 : end;
+    
+    int quoted = 0;
+    for (p = quote; p < end; p++) {
+        if (*p == '"') {
+            quoted = !quoted;
+        } else if (*p == '\n' && !quoted) {
+            return p + 1;
+        }
+    }
+    return end;
+}
+
+static int is_blank_record(const char* p, const char* end) {
+    return end - p <= 2 && (*p == '\n' || *p == '\r');
+}
+
+static const char* content_end(const char* p, const char* end) {
+    while (end > p && (end[-1] == '\n' || end[-1] == '\r')) end--;
+    return end;
+}
+
+/* Sets start/stop to the field's text, without quotes; returns the
+ * delimiter after it or end */
+static const char* field_bounds(const char* p, const char* end, char delimiter,
+                                const char** start, const char** stop) {
+    if (p < end && *p == '"') {
+        *start = ++p;
+        while (p < end) {
+            if (*p == '"') {
+                if (p + 1 < end && p[1] == '"') {
+                    p += 2;
+                    continue;
+                }
+                break;
+            }
+            p++;
+        }
+        *stop = p;
+        if (p < end) p++;
+    } else {
+        *start = p;
+    }
+    const char* next = p < end ? memchr(p, delimiter, (size_t)(end - p)) : NULL;
+    if (!next) next = end;
+    if (*start == p) *stop = next;
+    return next;
+}
+
+static double text_value(const char* start, const char* stop, char delimiter) {
+    while (start < stop && (*start == ' ' || *start == '\t')) start++;
+    while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+    
+    double value;
+    if (csv_parse_double(start, stop, &value) == stop && start < stop) return value;
+    size_t length = (size_t)(stop - start);
+    
+    // Semicolon or tab files from locales with a decimal comma
+    const char* comma = delimiter != ',' ? memchr(start, ',', length) : NULL;
+    if (comma && length < CSV_NUMBER_MAX) {
+        char copy[CSV_NUMBER_MAX];
+        memcpy(copy, start, length);
+        copy[comma - start] = '.';
+        if (csv_parse_double(copy, copy + length, &value) == copy + length) return value;
+    }
+    if (length == 4 && strncasecmp(start, "true", 4) == 0) return 1.0;
+    if (length == 5 && strncasecmp(start, "false", 5) == 0) return 0.0;
+    return NAN;
+}
+
+/* Bare numbers parse in one pass; the rest are bounded first */
+static const char* read_cell(const char* p, const char* end, char delimiter, double* value) {
+    const char* next = csv_parse_double(p, end, value);
+    if (next && (next == end || *next == delimiter)) return next;
+    
+    const char* start;
+    const char* stop;
+    next = field_bounds(p, end, delimiter, &start, &stop);
+    *value = text_value(start, stop, delimiter);
+    return next;
+}
+
+static size_t read_name(const char** p, const char* end, char delimiter, char* out, size_t size) {
+    const char* start;
+    const char* stop;
+    *p = field_bounds(*p, end, delimiter, &start, &stop);
+    while (start < stop && (*start == ' ' || *start == '\t')) start++;
+    while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+    
+    size_t length = 0;
+    for (const char* c = start; c < stop && length + 1 < size; c++) {
+        out[length++] = *c;
+        if (*c == '"' && c + 1 < stop && c[1] == '"') c++;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/* ISO 8601 as DateTimeOffset "O" writes it: 2024-05-01T12:00:00.0000000+00:00 */
+static int64_t days_from_civil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned year_of_era = (unsigned)(year - era * 400);
+    unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+static int read_digits(const char** p, const char* end, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++, (*p)++) {
+        if (*p >= end || !is_digit(**p)) return -1;
+        value = value * 10 + (**p - '0');
+    }
+    return value;
+}
+
+static int parse_iso8601(const char* p, const char* end, int64_t* wall_us) {
+    int year = read_digits(&p, end, 4);
+    if (year < 0 || p >= end || *p++ != '-') return -1;
+    int month = read_digits(&p, end, 2);
+    if (month < 1 || month > 12 || p >= end || *p++ != '-') return -1;
+    int day = read_digits(&p, end, 2);
+    if (day < 1 || day > 31 || p >= end || (*p != 'T' && *p != ' ')) return -1;
+    p++;
+    int hour = read_digits(&p, end, 2);
+    if (hour < 0 || p >= end || *p++ != ':') return -1;
+    int minute = read_digits(&p, end, 2);
+    if (minute < 0 || p >= end || *p++ != ':') return -1;
+    int second = read_digits(&p, end, 2);
+    if (second < 0) return -1;
+    
+    int64_t micros = 0;
+    if (p < end && *p == '.') {
+        int64_t scale = 100000;
+        for (p++; p < end && is_digit(*p); p++, scale /= 10) micros += (*p - '0') * scale;
+    }
+    int64_t offset_s = 0;
+    if (p < end && (*p == '+' || *p == '-')) {
+        int sign = *p++ == '-' ? -1 : 1;
+        int offset_hours = read_digits(&p, end, 2);
+        if (offset_hours < 0) return -1;
+        if (p < end && *p == ':') p++;
+        int offset_minutes = p < end ? read_digits(&p, end, 2) : 0;
+        if (offset_minutes < 0) return -1;
+        offset_s = sign * (offset_hours * 3600 + offset_minutes * 60);
+    }
+    
+    int64_t seconds = days_from_civil(year, (unsigned)month, (unsigned)day) * 86400 +
+                      hour * 3600 + minute * 60 + second - offset_s;
+    *wall_us = seconds * 1000000 + micros;
+    return 0;
+}
+
+/* Header: dialect, delimiter and the field to channel map */
+typedef struct {
+    int16_t* field_map;        // Per field: channel, IMPORT_FIELD_TIME or IMPORT_FIELD_SKIP
+    size_t field_count;
+    double time_scale;         // Time field to µs
+    int64_t time_offset_us;    // Added after scaling
+} ImportLayout;
+
+static char detect_delimiter(const char* p, const char* end) {
+    size_t commas = 0, semicolons = 0, tabs = 0;
+    int quoted = 0;
+    for (; p < end; p++) {
+        if (*p == '"') quoted = !quoted;
+        if (quoted) continue;
+        commas += *p == ',';
+        semicolons += *p == ';';
+        tabs += *p == '\t';
+    }
+    if (tabs > commas && tabs >= semicolons) return '\t';
+    if (semicolons > commas) return ';';
+    return ',';
+}
+
+static const char* known_unit(const KnownUnit* units, const char* name) {
+    for (; units && units->name; units++) {
+        if (strcmp(units->name, name) == 0) return units->unit;
+    }
+    return NULL;
+}
+
+static void add_channel(CsvImport* import, const char* name, const KnownUnit* units) {
+    ColumnLogChannel* channel = &import->channels[import->channel_count++];
+    memset(channel, 0, sizeof(*channel));
+    channel->type = COLUMN_TYPE_F32;
+    
+    // "Load (%)" is name "Load", unit "%"
+    size_t length = strlen(name);
+    const char* open = strrchr(name, '(');
+    const char* unit = known_unit(units, name);
+    if (!unit && length > 2 && name[length - 1] == ')' && open && open > name && open[-1] == ' ') {
+        size_t unit_length = (size_t)(name + length - 1 - (open + 1));
+        if (unit_length >= sizeof(channel->unit)) unit_length = sizeof(channel->unit) - 1;
+        memcpy(channel->unit, open + 1, unit_length);
+        length = (size_t)(open - 1 - name);
+    } else if (unit) {
+        snprintf(channel->unit, sizeof(channel->unit), "%s", unit);
+    }
+    if (length >= sizeof(channel->name)) length = sizeof(channel->name) - 1;
+    memcpy(channel->name, name, length);
+}
+
+static int read_header(CsvImport* import, ImportLayout* layout, const char* data,
+                       const char* header_end, const char* end) {
+    const char* stop = content_end(data, header_end);
+    import->delimiter = detect_delimiter(data, stop);
+    
+    // Field names, counted first for the map
+    size_t count = 1;
+    for (const char* p = data; p < stop; count++) {
+        const char* start;
+        const char* field_stop;
+        p = field_bounds(p, stop, import->delimiter, &start, &field_stop);
+        if (p >= stop) break;
+        p++;
+    }
+    char (*names)[IMPORT_NAME_MAX] = malloc(count * IMPORT_NAME_MAX);
+    layout->field_map = malloc(count * sizeof(int16_t));
+    import->channels = calloc(count < COLUMN_LOG_MAX_CHANNELS ? count : COLUMN_LOG_MAX_CHANNELS,
+                              sizeof(ColumnLogChannel));
+    if (!names || !layout->field_map || !import->channels) {
+        free(names);
+        return -1;
+    }
+    const char* p = data;
+    for (size_t f = 0; f < count; f++) {
+        read_name(&p, stop, import->delimiter, names[f], IMPORT_NAME_MAX);
+        if (p < stop) p++;
+    }
+    layout->field_count = count;
+    
+    if (count >= 3 && strcmp(names[0], "Timestamp") == 0 && strcmp(names[1], "Time (ms)") == 0) {
+        import->dialect = CSV_DIALECT_MAUI;
+    } else if (count >= 3 && strcmp(names[0], "Timestamp") == 0 &&
+               strcmp(names[1], "RPM") == 0 && strcmp(names[2], "Speed") == 0) {
+        import->dialect = CSV_DIALECT_PERFORMANCE;
+    } else if (count >= 3 && strcmp(names[0], "timestamp") == 0 &&
+               strcmp(names[1], "lat") == 0 && strcmp(names[2], "lon") == 0) {
+        import->dialect = CSV_DIALECT_TELEMETRY;
+    } else {
+        import->dialect = CSV_DIALECT_GENERIC;
+    }
+    
+    const KnownUnit* units = NULL;
+    size_t time_field = 0;
+    layout->time_scale = 1.0;
+    layout->time_offset_us = 0;
+    memset(&import->anchor, 0, sizeof(import->anchor));
+    switch (import->dialect) {
+    case CSV_DIALECT_PERFORMANCE:
+        units = performance_units;
+        import->wall_clock = 1;
+        break;
+    case CSV_DIALECT_TELEMETRY:
+        units = telemetry_units;
+        import->wall_clock = 1;
+        break;
+    case CSV_DIALECT_MAUI: {
+        // Time (ms) is relative with µs resolution; the first row's
+        // Timestamp (ms resolution) places it on the wall clock
+        time_field = 1;
+        layout->time_scale = 1000.0;
+        const char* row_end = record_end(header_end, end);
+        const char* first = header_end;
+        const char* start;
+        const char* first_stop;
+        field_bounds(first, content_end(first, row_end), import->delimiter, &start, &first_stop);
+        if (parse_iso8601(start, first_stop, &import->anchor.wall_us) == 0) {
+            import->wall_clock = 1;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    
+    for (size_t f = 0; f < count; f++) {
+        if (f == time_field) {
+            layout->field_map[f] = IMPORT_FIELD_TIME;
+        } else if (f < time_field || names[f][0] == '\0' ||
+                   (import->dialect == CSV_DIALECT_MAUI && strcmp(names[f], "Warning Message") == 0)) {
+            layout->field_map[f] = IMPORT_FIELD_SKIP;
+        } else if (import->channel_count >= COLUMN_LOG_MAX_CHANNELS) {
+            DEBUG_PRINT(DEBUG_LEVEL_WARN, "Column %s dropped: more than %d channels",
+                        names[f], COLUMN_LOG_MAX_CHANNELS);
+            layout->field_map[f] = IMPORT_FIELD_SKIP;
+        } else {
+            layout->field_map[f] = (int16_t)import->channel_count;
+            add_channel(import, names[f], units);
+        }
+    }
+    free(names);
+    return import->channel_count > 0 ? 0 : -1;
+}
+
+/* Parallel passes over spans of the mapping */
+typedef struct {
+    const char* start;
+    const char* end;
+    size_t quotes;             // Pass 1
+    size_t rows;               // Pass 2
+    size_t first_row;          // Pass 3 writes from here
+} ImportSpan;
+
+typedef struct ImportJob ImportJob;
+typedef void (*ImportPass)(ImportJob* job, ImportSpan* span);
+
+struct ImportJob {
+    CsvImport* import;
+    const ImportLayout* layout;
+    ImportPass pass;
+    ImportSpan* spans;
+    size_t span_count;
+};
+
+typedef struct {
+    ImportJob* job;
+    size_t index;
+} ImportWorker;
+
+static void count_quotes(ImportJob* job, ImportSpan* span) {
+    (void)job;
+    size_t quotes = 0;
+    for (const char* p = span->start;
+         (p = memchr(p, '"', (size_t)(span->end - p))) != NULL; p++) {
+        quotes++;
+    }
+    span->quotes = quotes;
+}
+
+static void count_records(ImportJob* job, ImportSpan* span) {
+    (void)job;
+    size_t rows = 0;
+    for (const char* p = span->start; p < span->end; ) {
+        const char* next = record_end(p, span->end);
+        rows += !is_blank_record(p, next);
+        p = next;
+    }
+    span->rows = rows;
+}
+
+static void parse_records(ImportJob* job, ImportSpan* span) {
+    CsvImport* import = job->import;
+    const ImportLayout* layout = job->layout;
+    const char delimiter = import->delimiter;
+    size_t row = span->first_row;
+    
+    for (const char* p = span->start; p < span->end; ) {
+        const char* next = record_end(p, span->end);
+        if (is_blank_record(p, next)) {
+            p = next;
+            continue;
+        }
+        const char* end = content_end(p, next);
+    
+        double time = NAN;
+        size_t channel = 0;
+        for (size_t f = 0; f < layout->field_count; f++) {
+            int target = layout->field_map[f];
+            if (target == IMPORT_FIELD_SKIP) {
+                const char* start;
+                const char* stop;
+                p = field_bounds(p, end, delimiter, &start, &stop);
+            } else {
+                double value;
+                p = read_cell(p, end, delimiter, &value);
+                if (target == IMPORT_FIELD_TIME) {
+                    time = value;
+                } else {
+                    import->columns[target][row] = (float)value;
+                    channel = (size_t)target + 1;
+                }
+            }
+            if (p >= end) break;
+            p++;
+        }
+        // Short records: the channels not reached are missing
+        for (; channel < import->channel_count; channel++) {
+            import->columns[channel][row] = NAN;
+        }
+        int64_t us = isnan(time) ? 0 : llround(time * layout->time_scale) + layout->time_offset_us;
+        import->timestamps[row++] = us > 0 ? (uint64_t)us : 0;
+        p = next;
+    }
+}
+
+static void* import_worker(void* arg) {
+    ImportWorker* worker = arg;
+    worker->job->pass(worker->job, &worker->job->spans[worker->index]);
+    return NULL;
+}
+
+static void run_pass(ImportJob* job, ImportPass pass) {
+    pthread_t threads[CSV_IMPORT_MAX_THREADS];
+    ImportWorker workers[CSV_IMPORT_MAX_THREADS];
+    size_t started = 0;
+    
+    job->pass = pass;
+    for (size_t i = 1; i < job->span_count; i++) {
+        workers[i] = (ImportWorker){ job, i };
+        if (pthread_create(&threads[i], NULL, import_worker, &workers[i]) != 0) break;
+        started = i;
+    }
+    // This thread takes the first span and any a thread could not start for
+    pass(job, &job->spans[0]);
+    for (size_t i = started + 1; i < job->span_count; i++) pass(job, &job->spans[i]);
+    for (size_t i = 1; i <= started; i++) pthread_join(threads[i], NULL);
+}
+
+/* Moves each span start past the next record boundary. Quote parity
+ * before it says whether a newline there is inside a field. */
+static void align_spans(ImportJob* job, const char* end) {
+    size_t quotes = 0;
+    for (size_t i = 1; i < job->span_count; i++) {
+        quotes += job->spans[i - 1].quotes;
+        int quoted = (int)(quotes & 1);
+        const char* p = job->spans[i].start;
+        while (p < end) {
+            if (*p == '"') {
+                quoted = !quoted;
+            } else if (*p == '\n' && !quoted) {
+                p++;
+                break;
+            }
+            p++;
+        }
+        // Parity comes from the unaligned starts, which are still in
+        // place for the spans after this one
+        job->spans[i].start = p;
+    }
+    for (size_t i = 0; i + 1 < job->span_count; i++) {
+        job->spans[i].end = job->spans[i + 1].start;
+    }
+    job->spans[job->span_count - 1].end = end;
+}
+
+static size_t import_threads(const CsvImportOptions* options, size_t size) {
+    size_t threads = options && options->threads ? options->threads :
+                     (size_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > size / IMPORT_MIN_SPAN) threads = size / IMPORT_MIN_SPAN;
+    if (threads < 1) threads = 1;
+    if (threads > CSV_IMPORT_MAX_THREADS) threads = CSV_IMPORT_MAX_THREADS;
+    return threads;
+}
+
+CsvImport* csv_import(const char* path, const CsvImportOptions* options) {
+    if (!path) return NULL;
+    
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open %s", path);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    size_t size = (size_t)st.st_size;
+    const char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+    
+    const char* end = data + size;
+    const char* body = data;
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) body += 3;
+    const char* header_end = record_end(body, end);
+    
+    CsvImport* import = calloc(1, sizeof(CsvImport));
+    ImportLayout layout = { 0 };
+    int status = import ? read_header(import, &layout, body, header_end, end) : -1;
+    if (status != 0) DEBUG_PRINT(DEBUG_LEVEL_ERROR, "%s has no usable CSV header", path);
+    
+    ImportSpan spans[CSV_IMPORT_MAX_THREADS];
+    ImportJob job = {
+        .import = import,
+        .layout = &layout,
+        .spans = spans,
+        .span_count = import_threads(options, (size_t)(end - header_end))
+    };
+    if (status == 0) {
+        size_t span_size = (size_t)(end - header_end) / job.span_count;
+        for (size_t i = 0; i < job.span_count; i++) {
+            spans[i] = (ImportSpan){ .start = header_end + i * span_size };
+            spans[i].end = i + 1 < job.span_count ? spans[i].start + span_size : end;
+        }
+        if (job.span_count > 1) {
+            run_pass(&job, count_quotes);
+            align_spans(&job, end);
+        }
+        run_pass(&job, count_records);
+    
+        for (size_t i = 0; i < job.span_count; i++) {
+            spans[i].first_row = import->rows;
+            import->rows += spans[i].rows;
+        }
+        import->timestamps = malloc((import->rows ? import->rows : 1) * sizeof(uint64_t));
+        import->columns = calloc(import->channel_count, sizeof(float*));
+        status = import->timestamps && import->columns ? 0 : -1;
+        for (size_t c = 0; status == 0 && c < import->channel_count; c++) {
+            import->columns[c] = malloc((import->rows ? import->rows : 1) * sizeof(float));
+            if (!import->columns[c]) status = -1;
+        }
+        if (status == 0) {
+            run_pass(&job, parse_records);
+        } else {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Out of memory importing %zu rows of %s",
+                        import->rows, path);
+        }
+    }
+    
+    free(layout.field_map);
+    munmap((void*)data, size);
+    if (status != 0) {
+        csv_import_free(import);
+        return NULL;
+    }
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Imported %zu rows of %zu channels from %s (%zu threads)",
+                import->rows, import->channel_count, path, job.span_count);
+    return import;
+}
+
+void csv_import_free(CsvImport* import) {
+    if (!import) return;
+    
+    for (size_t c = 0; import->columns && c < import->channel_count; c++) {
+        free(import->columns[c]);
+    }
+    free(import->columns);
+    free(import->timestamps);
+    free(import->channels);
+    free(import);
+}
+
+int csv_import_to_column_log(const CsvImport* import, const char* path, int compress) {
+    if (!import || !path) return -1;
+    
+    float* row = malloc((import->channel_count ? import->channel_count : 1) * sizeof(float));
+    ColumnLog* log = row ? column_log_create(path, import->channels, import->channel_count, 0) : NULL;
+    if (!log) {
+        free(row);
+        return -1;
+    }
+    column_log_set_anchor(log, &import->anchor);
+    column_log_set_compression(log, compress);
+    
+    int status = 0;
+    for (size_t r = 0; r < import->rows && status == 0; r++) {
+        for (size_t c = 0; c < import->channel_count; c++) row[c] = import->columns[c][r];
+        status = column_log_append(log, import->timestamps[r], row);
+    }
+    if (column_log_close(log) != 0) status = -1;
+    free(row);
+    if (status != 0) unlink(path);
+    return status;
+}
+
+/* Benchmark */
+#define CSV_IMPORT_BENCH_CSV "csv_import_bench.csv"
+
+static double bench_elapsed(const struct timespec* t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+int csv_import_benchmark(size_t rows) {
+    const size_t count = 10;
+    if (rows == 0) return -1;
+    
+    // Parser against strtod, bit for bit, over the forms loggers write
+    size_t samples = rows < 1000000 ? rows : 1000000;
+    char (*texts)[32] = malloc(samples * sizeof(*texts));
+    if (!texts) return -1;
+    uint64_t seed = 88172645463325252ULL;
+    for (size_t i = 0; i < samples; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        double value = (double)(int64_t)(seed >> 11) / 1e6 / (double)(1 + i % 1000);
+        switch (i % 4) {
+        case 0: snprintf(texts[i], sizeof(texts[i]), "%.2f", value / 1e6); break;
+        case 1: snprintf(texts[i], sizeof(texts[i]), "%.6f", value / 1e9); break;
+        case 2: snprintf(texts[i], sizeof(texts[i]), "%.17g", value); break;
+        default: snprintf(texts[i], sizeof(texts[i]), "%lld", (long long)(seed >> 14)); break;
+        }
+    }
+    struct timespec start;
+    double sum = 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < samples; i++) sum += strtod(texts[i], NULL);
+    double strtod_s = bench_elapsed(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < samples; i++) {
+        double value;
+        csv_parse_double(texts[i], texts[i] + strlen(texts[i]), &value);
+        sum += value;
+    }
+    double parse_s = bench_elapsed(&start);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < samples; i++) {
+        double expected = strtod(texts[i], NULL), actual;
+        csv_parse_double(texts[i], texts[i] + strlen(texts[i]), &actual);
+        if (memcmp(&expected, &actual, sizeof(double)) != 0 && mismatches++ < 5) {
+            printf("  mismatch: %s -> %.17g\n", texts[i], actual);
+        }
+    }
+    free(texts);
+    printf("CSV number parsing: %zu values, strtod %.1f ns, csv_parse_double %.1f ns, %zu mismatches\n",
+           samples, strtod_s * 1e9 / samples, parse_s * 1e9 / samples, mismatches);
+    (void)sum;
+    
+    // A performance_calc session log, as the logger writes it
+    FILE* file = fopen(CSV_IMPORT_BENCH_CSV, "w");
+    if (!file) return -1;
+    fputs("Timestamp,RPM,Speed,VE,MAF,Torque,Boost,AFR,IAT,TPS,G-Force\n", file);
+    int64_t wall_us = 1700000000000000LL;
+    char line[CSV_NUMBER_MAX * 11 + 2];
+    uint32_t state = 2463534242u;
+    for (size_t r = 0; r < rows; r++) {
+        char* p = line;
+        p += csv_format_int(wall_us + (int64_t)r * 10000, p);
+        for (size_t c = 0; c < count; c++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            *p++ = ',';
+            p += csv_format_float((double)(state % 800000) / 100.0 - 1000.0, 2, p);
+        }
+        *p++ = '\n';
+        fwrite(line, 1, (size_t)(p - line), file);
+    }
+    if (fclose(file) != 0) {
+        unlink(CSV_IMPORT_BENCH_CSV);
+        return -1;
+    }
+    
+    struct stat st;
+    double mb = stat(CSV_IMPORT_BENCH_CSV, &st) == 0 ? st.st_size / 1e6 : 0.0;
+    int status = mismatches ? -1 : 0;
+    CsvImport* single = NULL;
+    size_t thread_counts[] = { 1, 0 };
+    for (size_t i = 0; i < 2 && status == 0; i++) {
+        CsvImportOptions options = { .threads = thread_counts[i] };
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        CsvImport* import = csv_import(CSV_IMPORT_BENCH_CSV, &options);
+        double seconds = bench_elapsed(&start);
+        if (!import || import->rows != rows || import->channel_count != count ||
+            import->dialect != CSV_DIALECT_PERFORMANCE) {
+            status = -1;
+        } else if (single) {
+            // Every split must give the same columns as one thread
+            if (memcmp(single->timestamps, import->timestamps, rows * sizeof(uint64_t)) != 0) {
+                status = -1;
+            }
+            for (size_t c = 0; c < count && status == 0; c++) {
+                if (memcmp(single->columns[c], import->columns[c], rows * sizeof(float)) != 0) {
+                    status = -1;
+                }
+            }
+        }
+        printf("  import, %s: %.3f s, %.1f MB of CSV, %.1f MB/s\n",
+               thread_counts[i] ? "1 thread" : "all CPUs", seconds, mb,
+               seconds > 0 ? mb / seconds : 0.0);
+        if (single) {
+            csv_import_free(import);
+        } else {
+            single = import;
+        }
+    }
+    csv_import_free(single);
+    
+    unlink(CSV_IMPORT_BENCH_CSV);
+    return status;
+}
@@ -1,11 +1,330 @@
 #include "device_adapter.h"
+#include "adapter_caps.h"
+#include "device_plugin.h"
+#include "sct_device.h"
+#include "session_replay.h"
+#include "j2534_interface.h"
+#include "timebase.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#define ELM327_TIMEOUT_MS           1000
+#define ELM327_MAX_PIDS_PER_REQUEST 6     // ELM327 limit for multi-PID Mode 01
+#define ELM327_DEFAULT_BAUDRATE     38400
+#define ELM327_BRD_CLOCK            4000000   // ATBRD divisor base
+
+#define OBD_CAN_FUNCTIONAL_ID       0x7DF
+#define OBD_CAN_ECU_REQUEST_ID      0x7E0
+#define OBD_CAN_TIMEOUT_MS          100
+#define UDS_READ_DATA_BY_ID         0x22
+#define UDS_MAX_DIDS_PER_REQUEST    8
+
+static DeviceInterface* active_interface = NULL;
+
+/* Shared batch helpers */
+static uint8_t query_data_length(const PIDQuery* query) {
+    if (query->length) return query->length;
+    if (query->mode == OBD_MODE_SHOW_CURRENT_DATA) {
+        return obd2_pid_data_length((uint8_t)query->pid);
+    }
+    return 0;
+}
+
+/* Split a multi-PID/DID positive response into per-query results.
+ * Layout is [mode+0x40] followed by (id, data...) groups, where id is one
+ * byte for OBD modes and two bytes for UDS DIDs. Returns number decoded. */
+static size_t decode_multi_response(const uint8_t* buf, size_t len, uint8_t mode,
+                                    const PIDQuery* queries, const size_t* index,
+                                    size_t n, PIDResult* results, uint64_t received_us) {
+    size_t id_size = (mode == UDS_READ_DATA_BY_ID) ? 2 : 1;
+    size_t decoded = 0;
+    size_t pos = 1;
+    
+    if (len == 0 || buf[0] != (uint8_t)(mode + 0x40)) {
+        return 0;
+    }
+    
+    while (pos + id_size <= len && decoded < n) {
+        uint16_t id = (id_size == 2) ? (uint16_t)((buf[pos] << 8) | buf[pos + 1]) : buf[pos];
+        size_t match = n;
+        
+        for (size_t i = 0; i < n; i++) {
+            if (queries[index[i]].pid == id && results[index[i]].status != 0) {
+                match = i;
+                break;
+            }
+        }
+        if (match == n) break;   // Unrequested ID: trailing data from another ECU
+        
+        PIDResult* result = &results[index[match]];
+        uint8_t size = query_data_length(&queries[index[match]]);
+        pos += id_size;
+        if (size > sizeof(result->data) || pos + size > len) break;
+        
+        memcpy(result->data, &buf[pos], size);
+        result->length = size;
+        result->status = 0;
+        result->timestamp_us = received_us;
+        pos += size;
+        decoded++;
+    }
+    
+    return decoded;
+}
+
+static void reset_results(PIDResult* results, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        results[i].status = -1;
+        results[i].length = 0;
+        results[i].timestamp_us = 0;
+    }
+}
+
+/* Serial transport */
+/* termios speed for a baud rate, B0 if the host can't do it */
+static speed_t serial_speed(uint32_t baudrate) {
+    switch (baudrate) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+#ifdef B500000
+        case 500000: return B500000;
+#endif
+#ifdef B1000000
+        case 1000000: return B1000000;
+#endif
+#ifdef B2000000
+        case 2000000: return B2000000;
+#endif
+        default:     return B0;
+    }
+}
+
+static int serial_set_speed(int fd, uint32_t baudrate) {
+    struct termios tio;
+    speed_t speed = serial_speed(baudrate);
+    
+    if (speed == B0 || tcgetattr(fd, &tio) != 0) return -1;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    return tcsetattr(fd, TCSADRAIN, &tio);
+}
+
+static int serial_open(const char* port, uint32_t baudrate) {
+    int fd = open(port, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open %s: %s", port, strerror(errno));
+        return -1;
+    }
+    
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    if (serial_speed(baudrate) == B0) {
+        baudrate = ELM327_DEFAULT_BAUDRATE;
+    }
+    
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, serial_speed(baudrate));
+    cfsetospeed(&tio, serial_speed(baudrate));
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/* Raw serial port for backends living in other translation units */
+int device_serial_open(const char* port, uint32_t baudrate) {
+    return port ? serial_open(port, baudrate) : -1;
+}
 
 /* ELM327 Implementation */
+static DeviceInterface elm327_interface;
+
+static struct {
+    int fd;
+    uint16_t timeout_ms;
+    char port[PATH_MAX];      // Resolved device node, the registry key
+    uint32_t baudrate;        // Current host-side UART speed
+    uint8_t max_pids;         // Multi-PID limit from capabilities
+    uint64_t rx_us;           // When the last response started arriving
+    bool caps_unverified;     // Registry protocol not yet confirmed by a reply
+} elm327_state = {
+    .fd = -1,
+    .timeout_ms = ELM327_TIMEOUT_MS,
+    .max_pids = ELM327_MAX_PIDS_PER_REQUEST
+};
+
+static int elm327_write(const char* command) {
+    size_t cmd_len = strlen(command);
+    if (write(elm327_state.fd, command, cmd_len) != (ssize_t)cmd_len) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "ELM327 write failed: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* Collect input until one of the terminator characters is seen or the timeout expires */
+static int elm327_read_until(const char* terminators, char* response, size_t size) {
+    size_t received = 0;
+    while (received < size - 1) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(elm327_state.fd, &fds);
+        struct timeval tv = {
+            .tv_sec = elm327_state.timeout_ms / 1000,
+            .tv_usec = (elm327_state.timeout_ms % 1000) * 1000
+        };
+        
+        if (select(elm327_state.fd + 1, &fds, NULL, NULL, &tv) <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_WARN, "ELM327 timeout waiting for prompt");
+            response[received] = '\0';
+            return -1;
+        }
+        if (received == 0) {
+            elm327_state.rx_us = timebase_now_us();
+        }
+        
+        ssize_t n = read(elm327_state.fd, &response[received], size - 1 - received);
+        if (n <= 0) return -1;
+        received += (size_t)n;
+        
+        response[received] = '\0';
+        if (strpbrk(&response[received - (size_t)n], terminators)) {
+            break;
+        }
+    }
+    
+    response[received] = '\0';
+    return 0;
+}
+
+/* Send a command and collect the reply up to the '>' prompt */
+static int elm327_command(const char* command, char* response, size_t size) {
+    char scratch[256];
+    
+    if (elm327_state.fd < 0 || !command) return -1;
+    if (!response || size == 0) {
+        response = scratch;
+        size = sizeof(scratch);
+    }
+    
+    if (elm327_write(command) != 0) return -1;
+    return elm327_read_until(">", response, size);
+}
+
+/* Switch UART speed with ATBRD. The chip answers OK at the old rate, then
+ * sends its ID at the new rate and keeps it only if we echo a CR back in
+ * time; otherwise it reverts by itself. */
+static int elm327_set_baudrate(uint32_t baudrate) {
+    char command[16];
+    char response[128];
+    uint32_t divisor = (ELM327_BRD_CLOCK + baudrate / 2) / baudrate;
+    uint32_t previous = elm327_state.baudrate;
+    
+    if (baudrate == previous) return 0;
+    if (divisor == 0 || divisor > 0xFF || serial_speed(baudrate) == B0) return -1;
+    
+    snprintf(command, sizeof(command), "ATBRD %02X\r", divisor);
+    if (elm327_write(command) != 0 ||
+        elm327_read_until("K>", response, sizeof(response)) != 0 ||
+        !strstr(response, "OK")) {
+        if (!strchr(response, '>')) {
+            elm327_read_until(">", response, sizeof(response));
+        }
+        return -1;
+    }
+    
+    if (serial_set_speed(elm327_state.fd, baudrate) != 0) return -1;
+    
+    if (elm327_read_until("\r", response, sizeof(response)) == 0 &&
+        strstr(response, "ELM") && elm327_write("\r") == 0 &&
+        elm327_read_until(">", response, sizeof(response)) == 0) {
+        elm327_state.baudrate = baudrate;
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "ELM327 UART switched to %u baud", baudrate);
+        return 0;
+    }
+    
+    // Chip falls back on its own; follow it and resync on the prompt
+    serial_set_speed(elm327_state.fd, previous);
+    tcflush(elm327_state.fd, TCIOFLUSH);
+    elm327_command("\r", response, sizeof(response));
+    return -1;
+}
+
+/* Extract data bytes from an ELM327 reply. Skips ISO-TP frame indices
+ * ("0:"), the multi-frame length line and status text. */
+static int elm327_parse_bytes(const char* text, uint8_t* bytes, size_t max) {
+    size_t count = 0;
+    
+    if (strstr(text, "NO DATA") || strstr(text, "ERROR") ||
+        strstr(text, "UNABLE") || strchr(text, '?')) {
+        return -1;
+    }
+    
+    while (*text && count < max) {
+        while (*text == ' ' || *text == '\r' || *text == '\n') text++;
+        
+        const char* start = text;
+        while (*text && *text != ' ' && *text != '\r' && *text != '\n') text++;
+        
+        // Data bytes are exactly two hex digits; "0:" and "00E" are framing
+        size_t token_len = (size_t)(text - start);
+        unsigned int value;
+        if (token_len == 2 && isxdigit((unsigned char)start[0]) &&
+            isxdigit((unsigned char)start[1]) && sscanf(start, "%2x", &value) == 1) {
+            bytes[count++] = (uint8_t)value;
+        }
+    }
+    
+    return (int)count;
+}
+
 static int elm327_init(const DeviceConfig* config) {
     DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing ELM327 device");
     
+    if (!config->conn_config.port) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "No port configured for ELM327");
+        return -1;
+    }
+    
+    elm327_state.fd = serial_open(config->conn_config.port, config->conn_config.baudrate);
+    if (elm327_state.fd < 0) return -1;
+    // Registry key: the resolved device node, so /dev/serial/by-id links and
+    // the dashboard's port names all land on the same entry
+    char resolved[PATH_MAX];
+    snprintf(elm327_state.port, sizeof(elm327_state.port), "%s",
+             realpath(config->conn_config.port, resolved) ? resolved : config->conn_config.port);
+    elm327_state.baudrate = serial_speed(config->conn_config.baudrate) != B0 ?
+                            config->conn_config.baudrate : ELM327_DEFAULT_BAUDRATE;
+    elm327_state.max_pids = ELM327_MAX_PIDS_PER_REQUEST;
+    elm327_state.caps_unverified = false;
+    if (config->conn_config.timeout_ms) {
+        elm327_state.timeout_ms = config->conn_config.timeout_ms;
+    }
+    
     // Reset device
     const char* reset_cmd = "ATZ\r";
     // Echo off
@@ -14,90 +333,562 @@ static int elm327_init(const DeviceConfig* config) {
     const char* headers_off = "ATH0\r";
     // Line feeds off
     const char* linefeeds_off = "ATL0\r";
+    // Automatic protocol selection
+    const char* protocol_auto = "ATSP0\r";
+    
+    if (elm327_command(reset_cmd, NULL, 0) != 0 ||
+        elm327_command(echo_off, NULL, 0) != 0 ||
+        elm327_command(headers_off, NULL, 0) != 0 ||
+        elm327_command(linefeeds_off, NULL, 0) != 0 ||
+        elm327_command(protocol_auto, NULL, 0) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "ELM327 initialization sequence failed");
+        close(elm327_state.fd);
+        elm327_state.fd = -1;
+        return -1;
+    }
+    
+    // Known adapters skip the probe and go straight to their fastest setup
+    AdapterCapabilities caps;
+    if (adapter_caps_resolve(&elm327_interface, elm327_state.port, &caps) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Using ELM327 defaults, capabilities unknown");
+    }
     
-    // Implementation would send these commands through the configured connection
     return 0;
 }
 
-/* Arduino Implementation */
-static int arduino_init(const DeviceConfig* config) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing Arduino device");
+static int elm327_probe_capabilities(AdapterCapabilities* caps) {
+    char response[256];
+    uint8_t bytes[64];
     
-    // Arduino-specific initialization
+    // Identity: STN chips answer STI, genuine ELM/clones only ATI
+    if (elm327_command("ATI\r", response, sizeof(response)) != 0) return -1;
+    char* ident = response + strspn(response, "\r\n ");
+    ident[strcspn(ident, "\r\n>")] = '\0';
+    snprintf(caps->identity, sizeof(caps->identity), "%s", ident);
+    
+    if (elm327_command("STI\r", response, sizeof(response)) == 0 && !strchr(response, '?')) {
+        ident = response + strspn(response, "\r\n ");
+        ident[strcspn(ident, "\r\n>")] = '\0';
+        snprintf(caps->identity, sizeof(caps->identity), "%s", ident);
+    }
+    
+    unsigned int major = 0, minor = 0;
+    const char* version = strstr(caps->identity, " v");
+    if (version) {
+        sscanf(version + 2, "%u.%u", &major, &minor);
+    }
+    bool is_stn = strncmp(caps->identity, "STN", 3) == 0;
+    
+    caps->default_baudrate = elm327_state.baudrate;
+    caps->monitor_mode = is_stn || major >= 1;   // ATMA exists since v1.0
+    caps->periodic_slots = 0;
+    caps->can_fd = false;
+    
+    // Fastest UART rate the chip and host agree on
+    static const uint32_t candidates[] = { 2000000, 1000000, 500000, 230400, 115200 };
+    caps->max_baudrate = elm327_state.baudrate;
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (candidates[i] <= caps->max_baudrate) break;
+        if (!is_stn && candidates[i] > 500000) continue;
+        if (elm327_set_baudrate(candidates[i]) == 0) {
+            caps->max_baudrate = candidates[i];
+            break;
+        }
+    }
+    
+    // Multi-PID: ask for two always-supported PIDs and see if both come back
+    caps->max_pids_per_request = 1;
+    if (elm327_command("01 00 20\r", response, sizeof(response)) == 0) {
+        int n = elm327_parse_bytes(response, bytes, sizeof(bytes));
+        if (n >= 11 && bytes[0] == 0x41 && bytes[1] == 0x00 && bytes[6] == 0x20) {
+            caps->max_pids_per_request = ELM327_MAX_PIDS_PER_REQUEST;
+        }
+    }
+    
+    // Protocol found by the automatic search: "A6" = auto, CAN 11/500;
+    // a lone "A" is protocol A, J1939
+    caps->protocol = 0;
+    if (elm327_command("ATDPN\r", response, sizeof(response)) == 0) {
+        const char* p = response + strspn(response, "\r\n ");
+        if (p[0] == 'A' && isxdigit((unsigned char)p[1])) p++;
+        unsigned int protocol;
+        if (sscanf(p, "%1x", &protocol) == 1) {
+            caps->protocol = (uint8_t)protocol;
+        }
+    }
+    
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "ELM327 capabilities: %s, %u baud, %u PIDs/request",
+                caps->identity, caps->max_baudrate, caps->max_pids_per_request);
     return 0;
 }
 
-/* ESP32 Implementation */
-static int esp32_init(const DeviceConfig* config) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing ESP32 device");
+/* Registry entries are keyed by port, so a different adapter on the same
+ * port, or the same adapter in another car, can find a stale one. Drop it
+ * and let the next connect probe again. */
+static void elm327_forget_capabilities(const char* reason) {
+    DEBUG_PRINT(DEBUG_LEVEL_WARN, "Forgetting capabilities of %s: %s", elm327_state.port, reason);
+    adapter_caps_forget(elm327_state.port);
+    elm327_state.caps_unverified = false;
+}
+
+static void elm327_confirm_capabilities(bool answered) {
+    if (!elm327_state.caps_unverified) return;
     
-    // ESP32-specific initialization
-    return 0;
+    if (answered) {
+        elm327_state.caps_unverified = false;
+    } else {
+        elm327_forget_capabilities("first query failed");
+    }
 }
 
-/* SCT Implementation */
-static int sct_init_device(const DeviceConfig* config) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing SCT device");
+static int elm327_apply_capabilities(const AdapterCapabilities* caps) {
+    char command[16];
+    char response[64];
+    
+    elm327_state.max_pids = caps->max_pids_per_request ? caps->max_pids_per_request : 1;
+    if (elm327_state.max_pids > ELM327_MAX_PIDS_PER_REQUEST) {
+        elm327_state.max_pids = ELM327_MAX_PIDS_PER_REQUEST;
+    }
+    
+    if (caps->max_baudrate > elm327_state.baudrate &&
+        elm327_set_baudrate(caps->max_baudrate) != 0) {
+        elm327_forget_capabilities("baud rate switch failed");
+        return 0;
+    }
+    
+    // Try the known protocol first, searching the others if it fails
+    if (caps->protocol) {
+        snprintf(command, sizeof(command), "ATSPA%X\r", caps->protocol);
+        if (elm327_command(command, response, sizeof(response)) != 0 || strchr(response, '?')) {
+            elm327_forget_capabilities("protocol rejected");
+            elm327_command("ATSP0\r", NULL, 0);
+            return 0;
+        }
+        elm327_state.caps_unverified = true;
+    }
     
-    // SCT-specific initialization
     return 0;
 }
 
-static int sct_connect(void) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Connecting SCT device");
-    
-    // SCT-specific connection logic
+static int elm327_disconnect(void) {
+    if (elm327_state.fd >= 0) {
+        close(elm327_state.fd);
+        elm327_state.fd = -1;
+    }
     return 0;
 }
 
-static int sct_disconnect(void) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Disconnecting SCT device");
+/* Start of the data in a positive reply. ISO 15765 puts a DTC count byte ahead of
+ * the mode 03/07/0A codes; the older protocols pad the codes to groups of three
+ * instead, so only a CAN reply has an odd number of bytes after the service byte */
+static size_t reply_data_offset(const uint8_t* reply, size_t reply_len, bool has_pid) {
+    if (has_pid) return 2;
+    
+    size_t payload = reply_len - 1;
+    if (payload % 2 == 1 && (size_t)reply[1] * 2 == payload - 1) return 2;
+    return 1;
+}
+
+static int elm327_query_pid(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length) {
+    char command[16];
+    char response[512];
+    uint8_t bytes[256];
+    
+    if (!data || !length) return -1;
+    
+    // Modes without a PID byte: stored, pending and permanent DTCs
+    bool has_pid = !(mode == 0x03 || mode == 0x04 || mode == 0x07 || mode == 0x0A);
+    if (has_pid) {
+        snprintf(command, sizeof(command), "%02X %02X\r", mode, pid);
+    } else {
+        snprintf(command, sizeof(command), "%02X\r", mode);
+    }
+    
+    if (elm327_command(command, response, sizeof(response)) != 0) return -1;
+    
+    int count = elm327_parse_bytes(response, bytes, sizeof(bytes));
+    if (count < 1 || bytes[0] != (uint8_t)(mode + 0x40)) return -1;
     
-    // SCT-specific disconnection logic
+    size_t offset = reply_data_offset(bytes, (size_t)count, has_pid);
+    if ((size_t)count < offset) return -1;
+    
+    size_t size = (size_t)count - offset;
+    if (size > *length) size = *length;
+    memcpy(data, &bytes[offset], size);
+    *length = size;
     return 0;
 }
 
-static int sct_send_request(const char* request) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Sending request to SCT device");
+static int elm327_read_pid(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length) {
+    int status = elm327_query_pid(mode, pid, data, length);
+    elm327_confirm_capabilities(status == 0);
+    return status;
+}
+
+static int elm327_write_pid(uint8_t mode, uint8_t pid, const uint8_t* data, size_t length) {
+    char response[128];
+    (void)pid;
+    (void)data;
+    (void)length;
+    
+    // Only Mode 04 (clear DTCs) is a write the ELM327 exposes directly
+    if (mode != OBD_MODE_CLEAR_TROUBLE_CODES) return -1;
+    if (elm327_command("04\r", response, sizeof(response)) != 0) return -1;
+    return strstr(response, "44") ? 0 : -1;
+}
+
+static int elm327_read_pids(const PIDQuery* queries, PIDResult* results, size_t count) {
+    size_t index[ELM327_MAX_PIDS_PER_REQUEST];
+    size_t pending = 0;
+    int decoded = 0;
+    
+    if (!queries || !results || count > DEVICE_MAX_BATCH) return -1;
+    reset_results(results, count);
+    
+    for (size_t i = 0; i <= count; i++) {
+        bool batchable = i < count &&
+                         queries[i].mode == OBD_MODE_SHOW_CURRENT_DATA &&
+                         queries[i].pid <= 0xFF &&
+                         query_data_length(&queries[i]) > 0;
+        
+        if (batchable) {
+            index[pending++] = i;
+        }
+        
+        // Flush when the request is full, or at the end of the batch
+        if (pending == elm327_state.max_pids || (i == count && pending > 0)) {
+            char command[40] = "01";
+            char response[512];
+            uint8_t bytes[256];
+            size_t used = 2;
+            
+            for (size_t j = 0; j < pending; j++) {
+                used += snprintf(&command[used], sizeof(command) - used, " %02X",
+                                 queries[index[j]].pid);
+            }
+            snprintf(&command[used], sizeof(command) - used, "\r");
+            
+            if (elm327_command(command, response, sizeof(response)) != 0) {
+                elm327_confirm_capabilities(false);
+                return -1;
+            }
+            
+            int n = elm327_parse_bytes(response, bytes, sizeof(bytes));
+            if (n > 0) {
+                decoded += (int)decode_multi_response(bytes, (size_t)n,
+                                                      OBD_MODE_SHOW_CURRENT_DATA,
+                                                      queries, index, pending, results,
+                                                      elm327_state.rx_us);
+            }
+            elm327_confirm_capabilities(decoded > 0);
+            pending = 0;
+        }
+        
+        if (i < count && !batchable && queries[i].pid <= 0xFF) {
+            size_t length = sizeof(results[i].data);
+            if (elm327_read_pid(queries[i].mode, (uint8_t)queries[i].pid,
+                                results[i].data, &length) == 0) {
+                results[i].length = (uint8_t)length;
+                results[i].status = 0;
+                results[i].timestamp_us = elm327_state.rx_us;
+                decoded++;
+            }
+        }
+    }
+    
+    return decoded;
+}
+
+/* J2534 CAN Implementation (ISO 15765-4 multi-PID and UDS multi-DID) */
+static int j2534_device_init(const DeviceConfig* config) {
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing J2534 device");
+    
+    uint32_t baud = config->device_config.performance.can_config.primary_can_baud;
+    if (J2534_Initialize() != 0) return -1;
+    return can_init(baud ? baud : 500000, 0);
+}
+
+static int j2534_transfer(uint32_t request_id, const uint8_t* request, size_t request_len,
+                          uint8_t* response, size_t* response_len) {
+    if (can_iso_tp_send(request_id, request, request_len) != 0) return -1;
+    
+    // Skip response-pending (0x7F xx 0x78) replies from slow ECUs
+    for (int attempt = 0; attempt < 10; attempt++) {
+        size_t length = *response_len;
+        if (can_iso_tp_receive(OBD_CAN_ECU_REQUEST_ID, response, &length,
+                               OBD_CAN_TIMEOUT_MS) != 0) {
+            return -1;
+        }
+        if (!(length == 3 && response[0] == 0x7F && response[2] == 0x78)) {
+            *response_len = length;
+            return 0;
+        }
+    }
+    
+    return -1;
+}
+
+static int j2534_device_read_pid(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length) {
+    uint8_t request[2] = { mode, pid };
+    uint8_t response[256];
+    size_t response_len = sizeof(response);
+    
+    if (!data || !length) return -1;
     
-    // SCT-specific request sending logic
+    bool has_pid = !(mode == 0x03 || mode == 0x04 || mode == 0x07 || mode == 0x0A);
+    if (j2534_transfer(OBD_CAN_FUNCTIONAL_ID, request, has_pid ? 2 : 1,
+                       response, &response_len) != 0) {
+        return -1;
+    }
+    if (response_len < 1 || response[0] != (uint8_t)(mode + 0x40)) return -1;
+    
+    size_t offset = reply_data_offset(response, response_len, has_pid);
+    if (response_len < offset) return -1;
+    
+    size_t size = response_len - offset;
+    if (size > *length) size = *length;
+    memcpy(data, &response[offset], size);
+    *length = size;
     return 0;
 }
 
-static int sct_receive_response(char* response, size_t response_size) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Receiving response from SCT device");
+static int j2534_device_write_pid(uint8_t mode, uint8_t pid, const uint8_t* data, size_t length) {
+    uint8_t request[8];
+    uint8_t response[16];
+    size_t response_len = sizeof(response);
+    size_t request_len = 0;
+    
+    if (length > sizeof(request) - 2) return -1;
+    
+    request[request_len++] = mode;
+    if (mode != OBD_MODE_CLEAR_TROUBLE_CODES) {
+        request[request_len++] = pid;
+        memcpy(&request[request_len], data, length);
+        request_len += length;
+    }
+    
+    if (j2534_transfer(OBD_CAN_FUNCTIONAL_ID, request, request_len,
+                       response, &response_len) != 0) {
+        return -1;
+    }
+    return (response_len > 0 && response[0] == (uint8_t)(mode + 0x40)) ? 0 : -1;
+}
+
+static int j2534_device_read_pids(const PIDQuery* queries, PIDResult* results, size_t count) {
+    int decoded = 0;
+    
+    if (!queries || !results || count > DEVICE_MAX_BATCH) return -1;
+    reset_results(results, count);
+    
+    // One pass per batchable service: Mode 01 PIDs, then UDS DIDs
+    static const struct {
+        uint8_t mode;
+        uint32_t request_id;
+        size_t max_ids;
+    } groups[] = {
+        { OBD_MODE_SHOW_CURRENT_DATA, OBD_CAN_FUNCTIONAL_ID, 6 },
+        { UDS_READ_DATA_BY_ID, OBD_CAN_ECU_REQUEST_ID, UDS_MAX_DIDS_PER_REQUEST },
+    };
     
-    // SCT-specific response receiving logic
+    for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++) {
+        size_t index[UDS_MAX_DIDS_PER_REQUEST];
+        size_t pending = 0;
+        size_t id_size = (groups[g].mode == UDS_READ_DATA_BY_ID) ? 2 : 1;
+        
+        for (size_t i = 0; i <= count; i++) {
+            if (i < count && queries[i].mode == groups[g].mode &&
+                query_data_length(&queries[i]) > 0) {
+                index[pending++] = i;
+            }
+            
+            if (pending == groups[g].max_ids || (i == count && pending > 0)) {
+                uint8_t request[1 + UDS_MAX_DIDS_PER_REQUEST * 2];
+                uint8_t response[512];
+                size_t request_len = 0;
+                size_t response_len = sizeof(response);
+                
+                request[request_len++] = groups[g].mode;
+                for (size_t j = 0; j < pending; j++) {
+                    if (id_size == 2) {
+                        request[request_len++] = (uint8_t)(queries[index[j]].pid >> 8);
+                    }
+                    request[request_len++] = (uint8_t)queries[index[j]].pid;
+                }
+                
+                if (j2534_transfer(groups[g].request_id, request, request_len,
+                                   response, &response_len) == 0) {
+                    decoded += (int)decode_multi_response(response, response_len,
+                                                          groups[g].mode, queries,
+                                                          index, pending, results,
+                                                          timebase_now_us());
+                }
+                pending = 0;
+            }
+        }
+    }
+    
+    // Anything left (other modes, unknown lengths) goes one at a time
+    for (size_t i = 0; i < count; i++) {
+        if (results[i].status == 0 || query_data_length(&queries[i]) > 0) continue;
+        
+        size_t length = sizeof(results[i].data);
+        if (queries[i].pid <= 0xFF &&
+            j2534_device_read_pid(queries[i].mode, (uint8_t)queries[i].pid,
+                                  results[i].data, &length) == 0) {
+            results[i].length = (uint8_t)length;
+            results[i].status = 0;
+            results[i].timestamp_us = timebase_now_us();
+            decoded++;
+        }
+    }
+    
+    return decoded;
+}
+
+/* Simulator Implementation */
+static struct {
+    bool noise;
+    struct timespec start;
+} simulator_state = {0};
+
+static double simulator_elapsed(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - simulator_state.start.tv_sec) +
+           (double)(now.tv_nsec - simulator_state.start.tv_nsec) / 1e9;
+}
+
+static int simulator_init(const DeviceConfig* config) {
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing simulator device");
+    
+    simulator_state.noise = config->device_config.demo.enable_realistic_noise;
+    clock_gettime(CLOCK_MONOTONIC, &simulator_state.start);
     return 0;
 }
 
-static int sct_set_protocol(int protocol) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Setting protocol for SCT device");
+static int simulator_read_pid(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length) {
+    if (!data || !length) return -1;
+    
+    if (mode == OBD_MODE_READ_TROUBLE_CODES) {
+        *length = 0;   // No stored codes
+        return 0;
+    }
+    if (mode != OBD_MODE_SHOW_CURRENT_DATA) return -1;
+    
+    double t = simulator_elapsed();
+    double throttle = 0.5 + 0.5 * sin(t * 0.4);
+    double rpm = 800.0 + 5200.0 * throttle;
+    if (simulator_state.noise) {
+        rpm += (rand() % 100) - 50;
+    }
+    
+    uint8_t size = obd2_pid_data_length(pid);
+    if (size == 0 || size > *length) return -1;
+    memset(data, 0, size);
     
-    // SCT-specific protocol setting logic
+    switch (pid) {
+        case 0x04:  // Calculated engine load
+        case 0x11:  // Throttle position
+            data[0] = (uint8_t)(throttle * 255.0);
+            break;
+        case 0x05:  // Engine coolant temperature
+            data[0] = (uint8_t)(40 + 90.0 - 2.0 * cos(t * 0.05));
+            break;
+        case 0x0B:  // Intake manifold pressure
+            data[0] = (uint8_t)(30 + 170.0 * throttle);
+            break;
+        case 0x0C: {  // Engine RPM
+            uint16_t raw = (uint16_t)(rpm * 4.0);
+            data[0] = (uint8_t)(raw >> 8);
+            data[1] = (uint8_t)raw;
+            break;
+        }
+        case 0x0D:  // Vehicle speed
+            data[0] = (uint8_t)(rpm / 45.0);
+            break;
+        case 0x0F:  // Intake air temperature
+            data[0] = 40 + 35;
+            break;
+        case 0x10: {  // MAF air flow rate
+            uint16_t raw = (uint16_t)(rpm * throttle * 5.0);
+            data[0] = (uint8_t)(raw >> 8);
+            data[1] = (uint8_t)raw;
+            break;
+        }
+        case 0x2F:  // Fuel tank level
+            data[0] = 180;
+            break;
+        case 0x33:  // Barometric pressure
+            data[0] = 101;
+            break;
+        default:
+            break;
+    }
+    
+    *length = size;
     return 0;
 }
 
-static float sct_get_voltage(void) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Getting voltage from SCT device");
+static int simulator_read_pids(const PIDQuery* queries, PIDResult* results, size_t count) {
+    int decoded = 0;
+    
+    if (!queries || !results || count > DEVICE_MAX_BATCH) return -1;
+    
+    for (size_t i = 0; i < count; i++) {
+        size_t length = sizeof(results[i].data);
+        results[i].status = queries[i].pid <= 0xFF ?
+                            simulator_read_pid(queries[i].mode, (uint8_t)queries[i].pid,
+                                               results[i].data, &length) : -1;
+        results[i].length = results[i].status == 0 ? (uint8_t)length : 0;
+        results[i].timestamp_us = timebase_now_us();
+        if (results[i].status == 0) decoded++;
+    }
+    
+    return decoded;
+}
+
+/* Arduino Implementation */
+static int arduino_init(const DeviceConfig* config) {
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing Arduino device");
     
-    // SCT-specific voltage retrieval logic
-    return 0.0;
+    // Arduino-specific initialization
+    return 0;
 }
 
-static int sct_get_status(void) {
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Getting status of SCT device");
+/* ESP32 Implementation */
+static int esp32_init(const DeviceConfig* config) {
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing ESP32 device");
     
-    // SCT-specific status retrieval logic
+    // ESP32-specific initialization
     return 0;
 }
 
 /* Device interface implementations */
 static DeviceInterface elm327_interface = {
     .init = elm327_init,
+    .disconnect = elm327_disconnect,
+    .send_command = elm327_command,
+    .read_pid = elm327_read_pid,
+    .write_pid = elm327_write_pid,
+    .read_pids = elm327_read_pids,
+    .probe_capabilities = elm327_probe_capabilities,
+    .apply_capabilities = elm327_apply_capabilities,
     // Other function pointers would be set here
 };
 
+static DeviceInterface j2534_interface = {
+    .init = j2534_device_init,
+    .read_pid = j2534_device_read_pid,
+    .write_pid = j2534_device_write_pid,
+    .read_pids = j2534_device_read_pids,
+};
+
+static DeviceInterface simulator_interface = {
+    .init = simulator_init,
+    .read_pid = simulator_read_pid,
+    .read_pids = simulator_read_pids,
+};
+
 static DeviceInterface arduino_interface = {
     .init = arduino_init,
     // Other function pointers would be set here
@@ -108,20 +899,11 @@ static DeviceInterface esp32_interface = {
     // Other function pointers would be set here
 };
 
-static DeviceInterface sct_interface = {
-    .init = sct_init_device,
-    .connect = sct_connect,
-    .disconnect = sct_disconnect,
-    .send_request = sct_send_request,
-    .receive_response = sct_receive_response,
-    .set_protocol = sct_set_protocol,
-    .get_voltage = sct_get_voltage,
-    .get_status = sct_get_status
-};
-
 /* Get interface for device type */
 DeviceInterface* device_get_interface(DeviceType type) {
     switch(type) {
+        case DEVICE_J2534:
+            return &j2534_interface;
         case DEVICE_ELM327:
             return &elm327_interface;
         case DEVICE_ARDUINO:
@@ -129,7 +911,11 @@ DeviceInterface* device_get_interface(DeviceType type) {
         case DEVICE_ESP32:
             return &esp32_interface;
         case DEVICE_SCT:
-            return &sct_interface;
+            return sct_get_device_interface();
+        case DEVICE_SIMULATOR:
+            return &simulator_interface;
+        case DEVICE_REPLAY:
+            return session_replay_get_device_interface();
         default:
             DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Unsupported device type: %d", type);
             return NULL;
@@ -140,13 +926,112 @@ DeviceInterface* device_get_interface(DeviceType type) {
 int device_init(const DeviceConfig* config) {
     if (!config) return -1;
     
-    DeviceInterface* interface = device_get_interface(config->type);
+    DeviceInterface* interface = (config->type == DEVICE_PLUGIN) ?
+                                 device_plugin_get_interface(config->plugin_name) :
+                                 device_get_interface(config->type);
     if (!interface) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Unsupported device type");
         return -1;
     }
     
-    return interface->init(config);
+    if (interface->init(config) != 0) {
+        return -1;
+    }
+    
+    active_interface = interface;
+    return 0;
+}
+
+/* Get interface selected by the last successful device_init */
+DeviceInterface* device_get_active(void) {
+    return active_interface;
+}
+
+/* Read a batch of PIDs, falling back to one request per PID when the
+ * backend has no native batch support. Returns the number of valid results. */
+int device_read_pids(DeviceInterface* device, const PIDQuery* queries,
+                     PIDResult* results, size_t count) {
+    if (!device || !queries || !results || count > DEVICE_MAX_BATCH) return -1;
+    
+    if (device->read_pids) {
+        int decoded = device->read_pids(queries, results, count);
+        
+        // Backends that don't stamp receive time get the completion time
+        uint64_t now_us = timebase_now_us();
+        for (size_t i = 0; decoded > 0 && i < count; i++) {
+            if (results[i].status == 0 && results[i].timestamp_us == 0) {
+                results[i].timestamp_us = now_us;
+            }
+        }
+        return decoded;
+    }
+    if (!device->read_pid) return -1;
+    
+    int decoded = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = sizeof(results[i].data);
+        // read_pid takes one-byte PIDs; a DID would read the wrong PID
+        results[i].status = queries[i].pid <= 0xFF ?
+                            device->read_pid(queries[i].mode, (uint8_t)queries[i].pid,
+                                             results[i].data, &length) : -1;
+        results[i].length = results[i].status == 0 ? (uint8_t)length : 0;
+        results[i].timestamp_us = timebase_now_us();
+        if (results[i].status == 0) decoded++;
+    }
+    
+    return decoded;
+}
+
+/* Batch decoding against captured adapter replies */
+int device_batch_self_test(void) {
+    // ELM327 on CAN, headers off: "01 0C 0D 11" answered in two ISO-TP frames
+    static const char multi_frame[] = "008\r0: 41 0C 1A F8 0D 00\r1: 11 26 00 00 00 00 00\r\r>";
+    static const PIDQuery queries[] = {
+        { OBD_MODE_SHOW_CURRENT_DATA, 0x0C, 0 },
+        { OBD_MODE_SHOW_CURRENT_DATA, 0x0D, 0 },
+        { OBD_MODE_SHOW_CURRENT_DATA, 0x11, 0 }
+    };
+    const size_t index[] = { 0, 1, 2 };
+    PIDResult results[3];
+    uint8_t bytes[64];
+    int failures = 0;
+    
+    reset_results(results, 3);
+    int n = elm327_parse_bytes(multi_frame, bytes, sizeof(bytes));
+    size_t decoded = n > 0 ? decode_multi_response(bytes, (size_t)n, OBD_MODE_SHOW_CURRENT_DATA,
+                                                   queries, index, 3, results, 1) : 0;
+    if (n != 13 || bytes[0] != 0x41 || decoded != 3 ||
+        results[0].length != 2 || results[0].data[0] != 0x1A || results[0].data[1] != 0xF8 ||
+        results[1].length != 1 || results[1].data[0] != 0x00 ||
+        results[2].length != 1 || results[2].data[0] != 0x26) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Multi-frame reply: %d bytes, %zu of 3 PIDs decoded",
+                    n, decoded);
+        failures++;
+    }
+    
+    // Single-frame reply and adapter status text
+    n = elm327_parse_bytes("41 0C 1A F8 \r\r>", bytes, sizeof(bytes));
+    if (n != 4 || bytes[0] != 0x41 || bytes[3] != 0xF8) failures++;
+    if (elm327_parse_bytes("SEARCHING...\rNO DATA\r\r>", bytes, sizeof(bytes)) != -1) failures++;
+    
+    // Mode 03 on CAN carries a count byte; J1850 pads to three codes
+    n = elm327_parse_bytes("43 02 01 43 02 00 \r\r>", bytes, sizeof(bytes));
+    size_t offset = n > 0 ? reply_data_offset(bytes, (size_t)n, false) : 0;
+    if (n != 6 || offset != 2 || bytes[offset] != 0x01 || bytes[offset + 1] != 0x43 ||
+        bytes[offset + 2] != 0x02 || bytes[offset + 3] != 0x00) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "CAN DTC reply: %d bytes, data at %zu", n, offset);
+        failures++;
+    }
+    n = elm327_parse_bytes("43 01 43 02 00 00 00 \r\r>", bytes, sizeof(bytes));
+    if (n != 7 || reply_data_offset(bytes, (size_t)n, false) != 1) failures++;
+    
+    // DIDs through a read_pid-only backend fail instead of aliasing a PID
+    DeviceInterface single = { .read_pid = simulator_read_pid };
+    PIDQuery did = { UDS_READ_DATA_BY_ID, 0xF40C, 2 };
+    if (device_read_pids(&single, &did, results, 1) != 0 || results[0].status == 0) failures++;
+    
+    printf("Batch decoding self test: %s\n", failures ? "FAILED" : "passed");
+    return failures ? -1 : 0;
 }
 
 /* Real-time monitoring */
@@ -0,0 +1,148 @@
+#include "device_plugin.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <dlfcn.h>
+
+/* Discovered plugin */
+typedef struct {
+    char name[32];
+    char path[512];
+    void* handle;                 // NULL until first selected
+    DeviceInterface interface;    // Copy sized to this core's DeviceInterface
+    uint8_t loaded;
+} DevicePlugin;
+
+static struct {
+    DevicePlugin plugins[DEVICE_PLUGIN_MAX];
+    size_t count;
+} plugin_state = {0};
+
+int device_plugin_scan(const char* directory) {
+    if (!directory) directory = DEVICE_PLUGIN_DEFAULT_DIR;
+    
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        DEBUG_PRINT(DEBUG_LEVEL_DEBUG, "No plugin directory: %s", directory);
+        return 0;
+    }
+    
+    size_t prefix_len = strlen(DEVICE_PLUGIN_PREFIX);
+    size_t suffix_len = strlen(DEVICE_PLUGIN_SUFFIX);
+    struct dirent* entry;
+    
+    while ((entry = readdir(dir)) != NULL && plugin_state.count < DEVICE_PLUGIN_MAX) {
+        size_t len = strlen(entry->d_name);
+        if (len <= prefix_len + suffix_len ||
+            strncmp(entry->d_name, DEVICE_PLUGIN_PREFIX, prefix_len) != 0 ||
+            strcmp(entry->d_name + len - suffix_len, DEVICE_PLUGIN_SUFFIX) != 0) {
+            continue;
+        }
+        
+        size_t name_len = len - prefix_len - suffix_len;
+        if (name_len >= sizeof(plugin_state.plugins[0].name)) continue;
+        
+        DevicePlugin* plugin = &plugin_state.plugins[plugin_state.count];
+        memset(plugin, 0, sizeof(*plugin));
+        memcpy(plugin->name, entry->d_name + prefix_len, name_len);
+        snprintf(plugin->path, sizeof(plugin->path), "%s/%s", directory, entry->d_name);
+        
+        // A rescan must not duplicate an already known backend
+        int duplicate = 0;
+        for (size_t i = 0; i < plugin_state.count; i++) {
+            if (strcmp(plugin_state.plugins[i].name, plugin->name) == 0) {
+                duplicate = 1;
+                break;
+            }
+        }
+        if (duplicate) continue;
+        
+        DEBUG_PRINT(DEBUG_LEVEL_DEBUG, "Found device plugin %s", plugin->name);
+        plugin_state.count++;
+    }
+    
+    closedir(dir);
+    return (int)plugin_state.count;
+}
+
+size_t device_plugin_count(void) {
+    return plugin_state.count;
+}
+
+const char* device_plugin_name(size_t index) {
+    return index < plugin_state.count ? plugin_state.plugins[index].name : NULL;
+}
+
+static int device_plugin_load(DevicePlugin* plugin) {
+    plugin->handle = dlopen(plugin->path, RTLD_NOW | RTLD_LOCAL);
+    if (!plugin->handle) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to load plugin %s: %s", plugin->path, dlerror());
+        return -1;
+    }
+    
+    const DevicePluginDescriptor* descriptor = dlsym(plugin->handle, DEVICE_PLUGIN_SYMBOL);
+    if (!descriptor) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Plugin %s has no %s descriptor",
+                    plugin->name, DEVICE_PLUGIN_SYMBOL);
+        goto fail;
+    }
+    
+    if (descriptor->abi_version != DEVICE_PLUGIN_ABI_VERSION) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Plugin %s ABI v%u, core expects v%u",
+                    plugin->name, descriptor->abi_version, DEVICE_PLUGIN_ABI_VERSION);
+        goto fail;
+    }
+    
+    if (descriptor->interface_size > sizeof(DeviceInterface)) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Plugin %s was built against a newer core", plugin->name);
+        goto fail;
+    }
+    
+    DeviceInterface* interface = descriptor->get_interface ? descriptor->get_interface() : NULL;
+    if (!interface || !interface->init) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Plugin %s returned no usable interface", plugin->name);
+        goto fail;
+    }
+    
+    // Older plugins only fill the prefix of the vtable they knew about
+    memset(&plugin->interface, 0, sizeof(plugin->interface));
+    memcpy(&plugin->interface, interface, descriptor->interface_size);
+    plugin->loaded = 1;
+    
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Loaded device plugin %s: %s", plugin->name,
+                descriptor->description ? descriptor->description : "");
+    return 0;
+    
+fail:
+    dlclose(plugin->handle);
+    plugin->handle = NULL;
+    return -1;
+}
+
+DeviceInterface* device_plugin_get_interface(const char* name) {
+    if (!name) return NULL;
+    
+    for (size_t i = 0; i < plugin_state.count; i++) {
+        DevicePlugin* plugin = &plugin_state.plugins[i];
+        if (strcmp(plugin->name, name) != 0) continue;
+        
+        if (!plugin->loaded && device_plugin_load(plugin) != 0) {
+            return NULL;
+        }
+        return &plugin->interface;
+    }
+    
+    DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Unknown device plugin: %s", name);
+    return NULL;
+}
+
+void device_plugin_unload_all(void) {
+    for (size_t i = 0; i < plugin_state.count; i++) {
+        DevicePlugin* plugin = &plugin_state.plugins[i];
+        if (plugin->handle) {
+            dlclose(plugin->handle);
+        }
+        plugin->handle = NULL;
+        plugin->loaded = 0;
+    }
+}
@@ -10,9 +10,9 @@ typedef struct {
     char description[256];
     uint8_t severity;
     char system[64];
-} DTCInfo;
+} DTCDatabaseEntry;
 
-static DTCInfo* dtc_database = NULL;
+static DTCDatabaseEntry* dtc_database = NULL;
 static size_t dtc_count = 0;
 
 int dtc_init_database(const char* database_path) {
@@ -32,7 +32,7 @@ int dtc_init_database(const char* database_path) {
     }
     
     // Allocate memory
-    dtc_database = malloc(sizeof(DTCInfo) * count);
+    dtc_database = malloc(sizeof(DTCDatabaseEntry) * count);
     if (!dtc_database) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to allocate DTC database");
         fclose(fp);
@@ -104,8 +104,8 @@ int dtc_read_current(DTCData* data) {
     size_t length = sizeof(buffer);
     
     // Mode 03: Get current DTCs
-    DeviceInterface* device = device_get_interface(current_device_type);
-    if (!device) return -1;
+    DeviceInterface* device = device_get_active();
+    if (!device || !device->read_pid) return -1;
     
     if (device->read_pid(0x03, 0x00, buffer, &length) != 0) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to read DTCs");
@@ -146,8 +146,8 @@ int dtc_read_freeze_frame(uint8_t frame_id, DTCData* data) {
     size_t length = sizeof(buffer);
     
     // Mode 02: Get freeze frame data
-    DeviceInterface* device = device_get_interface(current_device_type);
-    if (!device) return -1;
+    DeviceInterface* device = device_get_active();
+    if (!device || !device->read_pid) return -1;
     
     if (device->read_pid(0x02, frame_id, buffer, &length) != 0) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to read freeze frame");
@@ -161,8 +161,8 @@ int dtc_read_freeze_frame(uint8_t frame_id, DTCData* data) {
 
 int dtc_clear_all(void) {
     // Mode 04: Clear DTCs
-    DeviceInterface* device = device_get_interface(current_device_type);
-    if (!device) return -1;
+    DeviceInterface* device = device_get_active();
+    if (!device || !device->write_pid) return -1;
     
     uint8_t data = 0;
     size_t length = 1;
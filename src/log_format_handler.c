@@ -0,0 +1,637 @@
+#define _GNU_SOURCE  // memmem
+#include "log_format_handler.h"
+#include "column_log.h"
+#include "csv_import.h"
+#include "log_template.h"
+#include "timebase.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stddef.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define RECORD_XDF_MAGIC        "OBDXDF1"
+#define RECORD_A2L_MAGIC        "OBDA2L1"
+#define RECORD_DEFAULT_BUFFER   (64 * 1024)
+#define RECORD_MAX_LINE         4096
+#define CONVERT_MAX_THREADS     8
+
+/* Where each known measurement comes from: a PerformanceData member when
+ * logging live, a session log column when converting */
+static const struct {
+    const char* name;
+    size_t member;
+    const char* column;
+} field_sources[] = {
+    { "RPM", offsetof(PerformanceData, engine_rpm), "RPM" },
+    { "SPEED", offsetof(PerformanceData, vehicle_speed), "Speed" },
+    { "VE", offsetof(PerformanceData, volumetric_efficiency), "VE" },
+    { "MAF", offsetof(PerformanceData, maf_scaled), "MAF" },
+    { "TORQUE", offsetof(PerformanceData, torque_actual), "Torque" },
+    { "BOOST", offsetof(PerformanceData, boost_pressure), "Boost" },
+    { "AFR", offsetof(PerformanceData, air_fuel_ratio), "AFR" },
+    { "IAT", offsetof(PerformanceData, intake_air_temp), "IAT" },
+    { "TPS", offsetof(PerformanceData, throttle_position), "TPS" },
+    { "COOLANT", offsetof(PerformanceData, coolant_temp), "Coolant" },
+    { "ACCEL_X", offsetof(PerformanceData, lateral_g), "Lateral-G" },
+    { "ACCEL_Y", offsetof(PerformanceData, acceleration), "G-Force" }
+};
+
+#define FIELD_UNMAPPED ((size_t)-1)
+
+typedef struct {
+    const ChannelDescriptor* channel;
+    uint32_t offset;           // Byte offset in the record
+    size_t member;             // PerformanceData offset, FIELD_UNMAPPED if none
+    const char* column;        // Session log column name
+} RecordField;
+
+/* A template's measurements laid out as a record */
+typedef struct {
+    LogTemplate* tmpl;
+    RecordField fields[LOG_FORMAT_MAX_FIELDS];
+    size_t field_count;
+    size_t record_size;
+} RecordLayout;
+
+/* Log file header, followed by the template text padded to 8 bytes */
+typedef struct {
+    char magic[8];             // RECORD_XDF_MAGIC or RECORD_A2L_MAGIC
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t field_count;
+    uint32_t template_size;
+    int64_t start_wall_us;
+    uint64_t record_count;     // Set at close; derive from the file size otherwise
+    uint8_t reserved[24];
+} RecordFileHeader;
+
+_Static_assert(sizeof(RecordFileHeader) == 64, "record file header layout");
+
+typedef struct {
+    RecordLayout* layout;
+    int fd;
+    char path[256];
+    RecordFileHeader header;
+    uint64_t data_offset;      // First record
+    uint8_t* buffer;
+    size_t buffer_size;
+    size_t fill;
+    uint64_t records;
+    int failed;
+} RecordWriter;
+
+/* Record layout */
+static void layout_free(RecordLayout* layout) {
+    if (!layout) return;
+    log_template_free(layout->tmpl);
+    free(layout);
+}
+
+static RecordLayout* layout_load(const char* path, int format) {
+    LogTemplate* tmpl = log_template_load(path);
+    if (!tmpl) return NULL;
+    if (tmpl->format != format) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "%s is not an %s template", path,
+                    format == LOG_TEMPLATE_XDF ? "XDF" : "A2L");
+        log_template_free(tmpl);
+        return NULL;
+    }
+    
+    RecordLayout* layout = calloc(1, sizeof(RecordLayout));
+    if (!layout) {
+        log_template_free(tmpl);
+        return NULL;
+    }
+    layout->tmpl = tmpl;
+    
+    // Records start with the timestamp
+    layout->record_size = sizeof(uint64_t);
+    layout->field_count = tmpl->channel_count;
+    if (layout->field_count > LOG_FORMAT_MAX_FIELDS) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "%s has %zu measurements, logging the first %d",
+                    path, tmpl->channel_count, LOG_FORMAT_MAX_FIELDS);
+        layout->field_count = LOG_FORMAT_MAX_FIELDS;
+    }
+    for (size_t f = 0; f < layout->field_count; f++) {
+        RecordField* field = &layout->fields[f];
+        field->channel = &tmpl->channels[f];
+        field->offset = (uint32_t)layout->record_size;
+        field->member = FIELD_UNMAPPED;
+        field->column = field->channel->name;
+        for (size_t i = 0; i < sizeof(field_sources) / sizeof(field_sources[0]); i++) {
+            if (strcasecmp(field->channel->name, field_sources[i].name) == 0) {
+                field->member = field_sources[i].member;
+                field->column = field_sources[i].column;
+                break;
+            }
+        }
+        layout->record_size += log_template_channel_size(field->channel->type);
+    }
+    return layout;
+}
+
+/* values holds one entry per field, NaN where there is none */
+static void record_encode(const RecordLayout* layout, int64_t wall_us, const float* values,
+                          uint8_t* out) {
+    memcpy(out, &wall_us, sizeof(wall_us));
+    for (size_t f = 0; f < layout->field_count; f++) {
+        log_template_encode(layout->fields[f].channel, values[f], out + layout->fields[f].offset);
+    }
+}
+
+/* Writer */
+static int record_write_all(RecordWriter* writer, const void* data, size_t length) {
+    const uint8_t* bytes = data;
+    
+    while (length > 0) {
+        ssize_t n = write(writer->fd, bytes, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Log write to %s failed: %s", writer->path, strerror(errno));
+            writer->failed = 1;
+            return -1;
+        }
+        bytes += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+static int record_writer_flush(RecordWriter* writer) {
+    if (writer->failed) return -1;
+    if (writer->fill && record_write_all(writer, writer->buffer, writer->fill) != 0) return -1;
+    writer->fill = 0;
+    return 0;
+}
+
+static int record_writer_close(RecordWriter* writer) {
+    if (!writer) return -1;
+    
+    int status = 0;
+    if (writer->fd >= 0) {
+        status = record_writer_flush(writer);
+        writer->header.record_count = writer->records;
+        if (status == 0 &&
+            pwrite(writer->fd, &writer->header, sizeof(writer->header), 0) != sizeof(writer->header)) {
+            status = -1;
+        }
+        if (fdatasync(writer->fd) != 0) status = -1;
+        if (close(writer->fd) != 0) status = -1;
+    }
+    layout_free(writer->layout);
+    free(writer->buffer);
+    free(writer);
+    return status;
+}
+
+/* Takes ownership of layout. buffer_size 0 sizes the buffer from the
+ * template's <BUFFERSIZE>, else RECORD_DEFAULT_BUFFER. */
+static RecordWriter* record_writer_create(const char* path, RecordLayout* layout,
+                                          int64_t start_wall_us, size_t buffer_size) {
+    RecordWriter* writer = calloc(1, sizeof(RecordWriter));
+    if (!writer) {
+        layout_free(layout);
+        return NULL;
+    }
+    writer->layout = layout;
+    writer->fd = -1;
+    snprintf(writer->path, sizeof(writer->path), "%s", path);
+    
+    if (!buffer_size) {
+        buffer_size = layout->tmpl->buffer_records ? layout->tmpl->buffer_records * layout->record_size :
+                                               RECORD_DEFAULT_BUFFER;
+    }
+    if (buffer_size < layout->record_size) buffer_size = layout->record_size;
+    writer->buffer_size = buffer_size;
+    writer->buffer = malloc(buffer_size);
+    writer->fd = writer->buffer ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (writer->fd < 0) {
+        if (writer->buffer) DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create %s: %s",
+                                        path, strerror(errno));
+        record_writer_close(writer);
+        return NULL;
+    }
+    
+    // The stored template has $TIMESTAMP filled in, written around the marker
+    const LogTemplate* tmpl = layout->tmpl;
+    const char* marker = memmem(tmpl->text, tmpl->text_size, "$TIMESTAMP", 10);
+    size_t prefix = marker ? (size_t)(marker - tmpl->text) : tmpl->text_size;
+    size_t suffix = marker ? tmpl->text_size - prefix - 10 : 0;
+    char stamp[32] = "";
+    if (marker) {
+        time_t now = time(NULL);
+        struct tm t;
+        gmtime_r(&now, &t);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", &t);
+    }
+    size_t text_size = prefix + strlen(stamp) + suffix;
+    
+    RecordFileHeader* header = &writer->header;
+    memcpy(header->magic, tmpl->format == LOG_TEMPLATE_XDF ? RECORD_XDF_MAGIC : RECORD_A2L_MAGIC,
+           sizeof(RECORD_XDF_MAGIC));
+    header->version = LOG_FORMAT_VERSION;
+    header->record_size = (uint32_t)layout->record_size;
+    header->field_count = (uint32_t)layout->field_count;
+    header->template_size = (uint32_t)text_size;
+    header->start_wall_us = start_wall_us;
+    
+    static const uint8_t padding[8];
+    size_t pad = (8 - text_size % 8) % 8;
+    writer->data_offset = sizeof(*header) + text_size + pad;
+    if (record_write_all(writer, header, sizeof(*header)) != 0 ||
+        record_write_all(writer, tmpl->text, prefix) != 0 ||
+        record_write_all(writer, stamp, strlen(stamp)) != 0 ||
+        record_write_all(writer, tmpl->text + tmpl->text_size - suffix, suffix) != 0 ||
+        record_write_all(writer, padding, pad) != 0) {
+        record_writer_close(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+static int record_writer_append(RecordWriter* writer, int64_t wall_us, const float* values) {
+    if (writer->failed) return -1;
+    if (writer->fill + writer->layout->record_size > writer->buffer_size &&
+        record_writer_flush(writer) != 0) {
+        return -1;
+    }
+    record_encode(writer->layout, wall_us, values, writer->buffer + writer->fill);
+    writer->fill += writer->layout->record_size;
+    writer->records++;
+    return 0;
+}
+
+static int record_append_performance(RecordWriter* writer, const PerformanceData* data) {
+    const RecordLayout* layout = writer->layout;
+    float values[LOG_FORMAT_MAX_FIELDS];
+    
+    for (size_t f = 0; f < layout->field_count; f++) {
+        size_t member = layout->fields[f].member;
+        if (member == FIELD_UNMAPPED) {
+            values[f] = NAN;
+        } else {
+            memcpy(&values[f], (const uint8_t*)data + member, sizeof(float));
+        }
+    }
+    return record_writer_append(writer, timebase_to_wall_us(data->timestamp_us), values);
+}
+
+/* XDF Format Handler */
+int xdf_init_logging(XDFHandler* handler, const char* template_path) {
+    if (!handler || !template_path || !handler->output_path) return -1;
+    
+    RecordLayout* layout = layout_load(template_path, LOG_TEMPLATE_XDF);
+    if (!layout) return -1;
+    
+    int64_t start = timebase_to_wall_us(timebase_now_us());
+    size_t buffer_size = (size_t)handler->xdf_state.buffer_size * layout->record_size;
+    RecordWriter* writer = record_writer_create(handler->output_path, layout, start, buffer_size);
+    if (!writer) return -1;
+    
+    handler->template_path = template_path;
+    handler->xdf_handle = writer;
+    handler->xdf_state.record_count = 0;
+    handler->xdf_state.start_time = (uint64_t)start;
+    handler->xdf_state.buffer_size = (uint32_t)(writer->buffer_size / writer->layout->record_size);
+    return 0;
+}
+
+int xdf_write_record(XDFHandler* handler, const PerformanceData* data) {
+    if (!handler || !handler->xdf_handle || !data) return -1;
+    
+    if (record_append_performance(handler->xdf_handle, data) != 0) return -1;
+    handler->xdf_state.record_count++;
+    return 0;
+}
+
+int xdf_close_log(XDFHandler* handler) {
+    if (!handler || !handler->xdf_handle) return -1;
+    
+    int status = record_writer_close(handler->xdf_handle);
+    handler->xdf_handle = NULL;
+    return status;
+}
+
+/* A2L Format Handler */
+int a2l_init_logging(A2LHandler* handler, const char* a2l_path) {
+    if (!handler || !a2l_path || !handler->output_path) return -1;
+    
+    RecordLayout* layout = layout_load(a2l_path, LOG_TEMPLATE_A2L);
+    if (!layout) return -1;
+    
+    handler->a2l_state.measurement_count = (uint32_t)layout->field_count;
+    handler->a2l_state.characteristic_count = layout->tmpl->characteristics;
+    snprintf(handler->a2l_state.project_name, sizeof(handler->a2l_state.project_name),
+             "%s", layout->tmpl->project);
+    
+    RecordWriter* writer = record_writer_create(handler->output_path, layout,
+                                                timebase_to_wall_us(timebase_now_us()), 0);
+    if (!writer) return -1;
+    
+    handler->a2l_path = a2l_path;
+    handler->a2l_handle = writer;
+    return 0;
+}
+
+int a2l_write_record(A2LHandler* handler, const PerformanceData* data) {
+    if (!handler || !handler->a2l_handle || !data) return -1;
+    return record_append_performance(handler->a2l_handle, data);
+}
+
+int a2l_close_log(A2LHandler* handler) {
+    if (!handler || !handler->a2l_handle) return -1;
+    
+    int status = record_writer_close(handler->a2l_handle);
+    handler->a2l_handle = NULL;
+    return status;
+}
+
+/* Conversion from CSV session logs: one sequential pass over a mapping */
+static int convert_csv(const char* input_path, RecordWriter* writer) {
+    const RecordLayout* layout = writer->layout;
+    int fd = open(input_path, O_RDONLY);
+    struct stat st;
+    
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open %s", input_path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    const char* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return -1;
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+    
+    // Header line: the first column is the wall clock timestamp
+    int columns[LOG_FORMAT_MAX_FIELDS];
+    char line[RECORD_MAX_LINE];
+    const char* p = data;
+    const char* end = data + size;
+    const char* eol = memchr(p, '\n', size);
+    size_t length = (size_t)((eol ? eol : end) - p);
+    if (length >= sizeof(line)) length = sizeof(line) - 1;
+    memcpy(line, p, length);
+    line[length] = '\0';
+    
+    for (size_t f = 0; f < layout->field_count; f++) columns[f] = -1;
+    int column = 0;
+    for (char* save, *name = strtok_r(line, ",\r", &save); name; name = strtok_r(NULL, ",\r", &save)) {
+        for (size_t f = 0; column > 0 && f < layout->field_count; f++) {
+            if (strcasecmp(name, layout->fields[f].column) == 0 ||
+                strcasecmp(name, layout->fields[f].channel->name) == 0) {
+                columns[f] = column;
+            }
+        }
+        column++;
+    }
+    
+    int status = 0;
+    float row[RECORD_MAX_LINE / 2];
+    float values[LOG_FORMAT_MAX_FIELDS];
+    p = eol ? eol + 1 : end;
+    while (p < end && status == 0) {
+        eol = memchr(p, '\n', (size_t)(end - p));
+        length = (size_t)((eol ? eol : end) - p);
+        if (length >= sizeof(line)) length = sizeof(line) - 1;
+        memcpy(line, p, length);
+        line[length] = '\0';
+        p = eol ? eol + 1 : end;
+        if (length == 0 || line[0] == '\r') continue;
+    
+        char* cursor = line;
+        int64_t wall_us = strtoll(cursor, &cursor, 10);
+        int count = 1;
+        while (*cursor == ',' && count < (int)(sizeof(row) / sizeof(row[0]))) {
+            double value;
+            const char* next = csv_parse_double(cursor + 1, line + length, &value);
+            row[count++] = next ? (float)value : NAN;
+            cursor += 1 + strcspn(cursor + 1, ",");
+        }
+        for (size_t f = 0; f < layout->field_count; f++) {
+            values[f] = columns[f] > 0 && columns[f] < count ? row[columns[f]] : NAN;
+        }
+        if (writer->records == 0) writer->header.start_wall_us = wall_us;
+        status = record_writer_append(writer, wall_us, values);
+    }
+    
+    munmap((void*)data, size);
+    return status;
+}
+
+/* Conversion from columnar session logs: worker threads take chunks in
+ * turn and pwrite each one's records at its precomputed offset */
+typedef struct {
+    const ColumnLogReader* reader;
+    const RecordLayout* layout;
+    int fd;
+    const uint64_t* first_row;   // Per chunk, rows before it
+    const int* channels;         // Per field, -1 when the log lacks it
+    TimebaseAnchor anchor;
+    uint64_t data_offset;
+    atomic_size_t next_chunk;
+    atomic_int failed;
+} ConvertJob;
+
+static void* convert_worker(void* arg) {
+    ConvertJob* job = arg;
+    const RecordLayout* layout = job->layout;
+    size_t chunk_rows = 0;
+    
+    for (size_t c = 0; c < column_log_chunk_count(job->reader); c++) {
+        ColumnChunkInfo info;
+        if (column_log_chunk_info(job->reader, c, &info) == 0 && info.rows > chunk_rows) {
+            chunk_rows = info.rows;
+        }
+    }
+    
+    uint64_t* timestamps = malloc(chunk_rows * sizeof(uint64_t));
+    float* columns = malloc(chunk_rows * layout->field_count * sizeof(float));
+    uint8_t* out = malloc(chunk_rows * layout->record_size);
+    float values[LOG_FORMAT_MAX_FIELDS];
+    if (!timestamps || !columns || !out) atomic_store(&job->failed, 1);
+    
+    size_t chunk;
+    while (!atomic_load(&job->failed) &&
+           (chunk = atomic_fetch_add(&job->next_chunk, 1)) < column_log_chunk_count(job->reader)) {
+        size_t rows = column_log_read_timestamps(job->reader, chunk, timestamps, chunk_rows);
+        if (rows == 0) {
+            atomic_store(&job->failed, 1);
+            break;
+        }
+        for (size_t f = 0; f < layout->field_count; f++) {
+            float* column = columns + f * chunk_rows;
+            if (job->channels[f] < 0 ||
+                column_log_read_floats(job->reader, chunk, (size_t)job->channels[f],
+                                       column, chunk_rows) != rows) {
+                for (size_t r = 0; r < rows; r++) column[r] = NAN;
+            }
+        }
+    
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t f = 0; f < layout->field_count; f++) values[f] = columns[f * chunk_rows + r];
+            int64_t wall_us = job->anchor.wall_us +
+                              (int64_t)(timestamps[r] - job->anchor.monotonic_us);
+            record_encode(layout, wall_us, values, out + r * layout->record_size);
+        }
+    
+        size_t length = rows * layout->record_size;
+        uint64_t offset = job->data_offset + job->first_row[chunk] * layout->record_size;
+        for (size_t done = 0; done < length; ) {
+            ssize_t n = pwrite(job->fd, out + done, length - done, (off_t)(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                atomic_store(&job->failed, 1);
+                break;
+            }
+            done += (size_t)n;
+        }
+    }
+    
+    free(timestamps);
+    free(columns);
+    free(out);
+    return NULL;
+}
+
+static int convert_columns(const char* input_path, RecordWriter* writer) {
+    ColumnLogReader* reader = column_log_open(input_path);
+    if (!reader) return -1;
+    
+    const RecordLayout* layout = writer->layout;
+    size_t chunks = column_log_chunk_count(reader);
+    uint64_t* first_row = malloc((chunks ? chunks : 1) * sizeof(uint64_t));
+    int channels[LOG_FORMAT_MAX_FIELDS];
+    if (!first_row || record_writer_flush(writer) != 0) {
+        free(first_row);
+        column_log_reader_close(reader);
+        return -1;
+    }
+    
+    for (size_t f = 0; f < layout->field_count; f++) {
+        channels[f] = -1;
+        for (size_t c = 0; c < column_log_channel_count(reader); c++) {
+            const char* name = column_log_channel(reader, c)->name;
+            if (strcasecmp(name, layout->fields[f].column) == 0 ||
+                strcasecmp(name, layout->fields[f].channel->name) == 0) {
+                channels[f] = (int)c;
+                break;
+            }
+        }
+    }
+    
+    uint64_t rows = 0;
+    for (size_t c = 0; c < chunks; c++) {
+        ColumnChunkInfo info;
+        first_row[c] = rows;
+        if (column_log_chunk_info(reader, c, &info) == 0) rows += info.rows;
+    }
+    
+    ConvertJob job = {
+        .reader = reader,
+        .layout = layout,
+        .fd = writer->fd,
+        .first_row = first_row,
+        .channels = channels,
+        .data_offset = writer->data_offset
+    };
+    column_log_get_anchor(reader, &job.anchor);
+    atomic_init(&job.next_chunk, 0);
+    atomic_init(&job.failed, 0);
+    
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t thread_count = cpus > 0 ? (size_t)cpus : 1;
+    if (thread_count > CONVERT_MAX_THREADS) thread_count = CONVERT_MAX_THREADS;
+    if (thread_count > chunks) thread_count = chunks ? chunks : 1;
+    
+    pthread_t threads[CONVERT_MAX_THREADS];
+    size_t started = 0;
+    while (started + 1 < thread_count &&
+           pthread_create(&threads[started], NULL, convert_worker, &job) == 0) {
+        started++;
+    }
+    convert_worker(&job);
+    for (size_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    
+    int status = atomic_load(&job.failed) ? -1 : 0;
+    if (status == 0) {
+        writer->records = rows;
+        writer->header.start_wall_us = job.anchor.wall_us;
+        if (chunks) {
+            ColumnChunkInfo info;
+            column_log_chunk_info(reader, 0, &info);
+            writer->header.start_wall_us += (int64_t)(info.t_min - job.anchor.monotonic_us);
+        }
+    } else {
+        writer->failed = 1;
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Converting %s failed", input_path);
+    }
+    
+    free(first_row);
+    column_log_reader_close(reader);
+    return status;
+}
+
+static int convert_log(const char* input_path, const char* output_path,
+                       const char* template_name, int format) {
+    if (!input_path || !output_path) return -1;
+    
+    char template_path[PATH_MAX];
+    if (log_template_path(template_name, template_path, sizeof(template_path)) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Template %s not found, set %s to its directory",
+                    template_name, LOG_TEMPLATE_DIR_ENV);
+        return -1;
+    }
+    RecordLayout* layout = layout_load(template_path, format);
+    if (!layout) return -1;
+    RecordWriter* writer = record_writer_create(output_path, layout, 0, 0);
+    if (!writer) return -1;
+    
+    int status = column_log_is_csv_path(input_path) ? convert_csv(input_path, writer) :
+                                                      convert_columns(input_path, writer);
+    if (record_writer_close(writer) != 0) status = -1;
+    if (status == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Converted %s to %s", input_path, output_path);
+    } else {
+        unlink(output_path);
+    }
+    return status;
+}
+
+/* Utility Functions */
+int convert_log_to_xdf(const char* input_path, const char* output_path) {
+    return convert_log(input_path, output_path, LOG_FORMAT_XDF_TEMPLATE, LOG_TEMPLATE_XDF);
+}
+
+int convert_log_to_a2l(const char* input_path, const char* output_path) {
+    return convert_log(input_path, output_path, LOG_FORMAT_A2L_TEMPLATE, LOG_TEMPLATE_A2L);
+}
+
+int validate_xdf_format(const char* xdf_path) {
+    if (!xdf_path) return -1;
+    
+    RecordLayout* layout = layout_load(xdf_path, LOG_TEMPLATE_XDF);
+    if (!layout) return -1;
+    layout_free(layout);
+    return 0;
+}
+
+int validate_a2l_format(const char* a2l_path) {
+    if (!a2l_path) return -1;
+    
+    RecordLayout* layout = layout_load(a2l_path, LOG_TEMPLATE_A2L);
+    if (!layout) return -1;
+    layout_free(layout);
+    return 0;
+}
@@ -0,0 +1,330 @@
+#include "log_sink.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define LOG_SINK_ALIGN        4096
+#define LOG_SINK_IDLE_US      2000   // Writer poll interval when the queue is empty
+#define LOG_SINK_DEFAULT_LATENCY_MS 100
+
+/* Queue slot: seq == position means free for that producer position,
+ * seq == position + 1 means the record is ready for the writer */
+typedef struct {
+    atomic_size_t seq;
+} LogSlotHeader;
+
+struct LogSink {
+    LogSinkConfig config;
+    int fd;
+    
+    /* Bounded multi-producer, single-consumer queue */
+    uint8_t* slots;
+    size_t slot_stride;
+    size_t mask;
+    atomic_size_t enqueue_pos;
+    atomic_size_t dequeue_pos;
+    
+    /* Writer side */
+    pthread_t thread;
+    atomic_int running;
+    atomic_uint flush_requested;
+    atomic_uint flush_done;
+    char* chunk;                // Aligned staging buffer
+    size_t chunk_fill;
+    
+    /* Counters */
+    atomic_uint_fast64_t records_written;
+    atomic_uint_fast64_t records_dropped;
+    atomic_uint_fast64_t bytes_written;
+    atomic_uint_fast64_t fsyncs;
+    atomic_uint_fast64_t write_errors;
+    atomic_uint queue_high_water;
+};
+
+static uint64_t log_sink_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static LogSlotHeader* log_sink_slot(LogSink* sink, size_t pos) {
+    return (LogSlotHeader*)(sink->slots + (pos & sink->mask) * sink->slot_stride);
+}
+
+static int log_sink_write_all(LogSink* sink, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(sink->fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            atomic_fetch_add(&sink->write_errors, 1);
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Log write to %s failed: %s",
+                        sink->config.path, strerror(errno));
+            return -1;
+        }
+        data += n;
+        length -= (size_t)n;
+        atomic_fetch_add(&sink->bytes_written, (uint64_t)n);
+    }
+    return 0;
+}
+
+static void log_sink_write_chunk(LogSink* sink) {
+    if (sink->chunk_fill == 0) return;
+    log_sink_write_all(sink, sink->chunk, sink->chunk_fill);
+    sink->chunk_fill = 0;
+}
+
+/* Append bytes to the staging chunk, writing it out each time it fills
+ * so every full-chunk write has the same aligned size */
+static void log_sink_stage(LogSink* sink, const char* data, size_t length) {
+    while (length > 0) {
+        size_t space = sink->config.chunk_size - sink->chunk_fill;
+        size_t take = length < space ? length : space;
+        
+        memcpy(sink->chunk + sink->chunk_fill, data, take);
+        sink->chunk_fill += take;
+        data += take;
+        length -= take;
+        
+        if (sink->chunk_fill == sink->config.chunk_size) {
+            log_sink_write_chunk(sink);
+        }
+    }
+}
+
+/* Move every ready record into the staging chunk, returns how many */
+static size_t log_sink_drain(LogSink* sink) {
+    char line[LOG_SINK_MAX_LINE];
+    size_t pos = atomic_load_explicit(&sink->dequeue_pos, memory_order_relaxed);
+    size_t drained = 0;
+    
+    for (;;) {
+        LogSlotHeader* slot = log_sink_slot(sink, pos);
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1) break;
+        
+        const void* record = slot + 1;
+        if (sink->config.consume) {
+            size_t written = sink->config.consume(sink->config.consume_context, record);
+            atomic_fetch_add(&sink->bytes_written, (uint64_t)written);
+        } else if (sink->config.format) {
+            size_t length = sink->config.format(record, line, sizeof(line));
+            log_sink_stage(sink, line, length < sizeof(line) ? length : sizeof(line) - 1);
+        } else {
+            log_sink_stage(sink, record, sink->config.record_size);
+        }
+        
+        // Hand the slot back to producers one lap ahead
+        atomic_store_explicit(&slot->seq, pos + sink->mask + 1, memory_order_release);
+        atomic_store_explicit(&sink->dequeue_pos, ++pos, memory_order_release);
+        drained++;
+    }
+    
+    atomic_fetch_add(&sink->records_written, drained);
+    return drained;
+}
+
+static void log_sink_sync(LogSink* sink) {
+    if (sink->config.consume) {
+        size_t written = sink->config.consume(sink->config.consume_context, NULL);
+        atomic_fetch_add(&sink->bytes_written, (uint64_t)written);
+        atomic_fetch_add(&sink->fsyncs, 1);
+    } else if (fdatasync(sink->fd) == 0) {
+        atomic_fetch_add(&sink->fsyncs, 1);
+    } else {
+        atomic_fetch_add(&sink->write_errors, 1);
+    }
+}
+
+static void* log_sink_thread(void* arg) {
+    LogSink* sink = arg;
+    const uint32_t max_latency_ms = sink->config.max_latency_ms ?
+                                    sink->config.max_latency_ms : LOG_SINK_DEFAULT_LATENCY_MS;
+    uint64_t last_sync = log_sink_now_ms();
+    uint64_t staged_since = 0;
+    uint64_t synced_bytes = 0;
+    uint64_t unsynced = 0;      // Records a consumer may still be holding
+    
+    for (;;) {
+        // Sample the stop and flush requests before draining so every record
+        // appended ahead of them is part of this pass
+        int running = atomic_load(&sink->running);
+        unsigned flush = atomic_load(&sink->flush_requested);
+        int flushing = flush != atomic_load(&sink->flush_done);
+        
+        size_t staged_before = sink->chunk_fill;
+        size_t drained = log_sink_drain(sink);
+        uint64_t now = log_sink_now_ms();
+        if (!staged_before && sink->chunk_fill) staged_since = now;
+        
+        // Partial chunks go out once they get old, on request or at exit
+        if (sink->chunk_fill && (flushing || !running || now - staged_since >= max_latency_ms)) {
+            log_sink_write_chunk(sink);
+        }
+        
+        // A consumer buffers on its own, so it is asked to write out when
+        // the records it took need syncing
+        uint64_t bytes = atomic_load(&sink->bytes_written);
+        unsynced += drained;
+        int dirty = sink->config.consume ? unsynced != 0 : bytes != synced_bytes;
+        if (dirty &&
+            (flushing || !running ||
+             (sink->config.fsync_interval_ms && now - last_sync >= sink->config.fsync_interval_ms))) {
+            log_sink_sync(sink);
+            synced_bytes = atomic_load(&sink->bytes_written);
+            unsynced = 0;
+            last_sync = now;
+        }
+        
+        if (flushing) atomic_store(&sink->flush_done, flush);
+        if (!running) break;
+        if (!drained) usleep(LOG_SINK_IDLE_US);
+    }
+    
+    return NULL;
+}
+
+LogSink* log_sink_open(const LogSinkConfig* config) {
+    if (!config || (!config->path && !config->consume) || config->record_size == 0) return NULL;
+    
+    LogSink* sink = calloc(1, sizeof(LogSink));
+    if (!sink) return NULL;
+    
+    sink->config = *config;
+    
+    uint32_t capacity = 1;
+    uint32_t wanted = config->capacity ? config->capacity : LOG_SINK_DEFAULT_CAPACITY;
+    while (capacity < wanted) capacity <<= 1;
+    sink->config.capacity = capacity;
+    sink->mask = capacity - 1;
+    
+    uint32_t chunk = config->chunk_size ? config->chunk_size : LOG_SINK_DEFAULT_CHUNK;
+    sink->config.chunk_size = (chunk + LOG_SINK_ALIGN - 1) & ~(uint32_t)(LOG_SINK_ALIGN - 1);
+    
+    // Keep every record aligned for the producer's memcpy and the formatter
+    sink->slot_stride = (sizeof(LogSlotHeader) + config->record_size + 7) & ~(size_t)7;
+    sink->slots = calloc(capacity, sink->slot_stride);
+    if (!sink->slots || (!config->consume &&
+                         posix_memalign((void**)&sink->chunk, LOG_SINK_ALIGN, sink->config.chunk_size) != 0)) {
+        free(sink->slots);
+        free(sink);
+        return NULL;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&log_sink_slot(sink, i)->seq, i);
+    }
+    
+    sink->fd = config->consume ? -1 : open(config->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!config->consume && sink->fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open log %s: %s", config->path, strerror(errno));
+        free(sink->chunk);
+        free(sink->slots);
+        free(sink);
+        return NULL;
+    }
+    
+    if (config->header && !config->consume) {
+        log_sink_stage(sink, config->header, strlen(config->header));
+    }
+    
+    atomic_store(&sink->running, 1);
+    if (pthread_create(&sink->thread, NULL, log_sink_thread, sink) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to start log writer for %s",
+                    config->path ? config->path : "consumer");
+        if (sink->fd >= 0) close(sink->fd);
+        free(sink->chunk);
+        free(sink->slots);
+        free(sink);
+        return NULL;
+    }
+    
+    return sink;
+}
+
+/* Lock-free, never blocks. Returns -1 and counts a drop when full. */
+int log_sink_append(LogSink* sink, const void* record) {
+    if (!sink || !record) return -1;
+    
+    size_t pos = atomic_load_explicit(&sink->enqueue_pos, memory_order_relaxed);
+    LogSlotHeader* slot;
+    
+    for (;;) {
+        slot = log_sink_slot(sink, pos);
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&sink->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&sink->records_dropped, 1, memory_order_relaxed);
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&sink->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    
+    memcpy(slot + 1, record, sink->config.record_size);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    
+    // Track the high-water mark for sizing the queue
+    size_t depth = pos + 1 - atomic_load_explicit(&sink->dequeue_pos, memory_order_relaxed);
+    unsigned high = atomic_load_explicit(&sink->queue_high_water, memory_order_relaxed);
+    while (depth > high &&
+           !atomic_compare_exchange_weak_explicit(&sink->queue_high_water, &high, (unsigned)depth,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return 0;
+}
+
+/* Block until everything appended so far is written and synced.
+ * Not for use on a sampling thread. */
+int log_sink_flush(LogSink* sink) {
+    if (!sink) return -1;
+    
+    unsigned request = atomic_fetch_add(&sink->flush_requested, 1) + 1;
+    while ((int)(atomic_load(&sink->flush_done) - request) < 0) {
+        usleep(LOG_SINK_IDLE_US);
+    }
+    return 0;
+}
+
+int log_sink_get_stats(LogSink* sink, LogSinkStats* stats) {
+    if (!sink || !stats) return -1;
+    
+    size_t enqueued = atomic_load(&sink->enqueue_pos);
+    size_t dequeued = atomic_load(&sink->dequeue_pos);
+    
+    stats->queue_depth = (uint32_t)(enqueued - dequeued);
+    stats->queue_high_water = atomic_load(&sink->queue_high_water);
+    stats->records_written = atomic_load(&sink->records_written);
+    stats->records_dropped = atomic_load(&sink->records_dropped);
+    stats->bytes_written = atomic_load(&sink->bytes_written);
+    stats->fsyncs = atomic_load(&sink->fsyncs);
+    stats->write_errors = atomic_load(&sink->write_errors);
+    return 0;
+}
+
+/* Drain, write and sync everything still queued, then release the sink */
+int log_sink_close(LogSink* sink) {
+    if (!sink) return -1;
+    
+    atomic_store(&sink->running, 0);
+    pthread_join(sink->thread, NULL);
+    
+    int status = atomic_load(&sink->write_errors) ? -1 : 0;
+    if (sink->fd >= 0 && close(sink->fd) != 0) status = -1;
+    
+    free(sink->chunk);
+    free(sink->slots);
+    free(sink);
+    return status;
+}
@@ -0,0 +1,639 @@
+#define _GNU_SOURCE  // memmem
+#include "log_template.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TEMPLATE_BENCH_TARGET_MS 1000
+
+/* A slice of the template text */
+typedef struct {
+    const char* p;
+    size_t n;
+} Token;
+
+typedef struct {
+    const char* p;
+    const char* end;
+} Lexer;
+
+static const struct {
+    const char* name;
+    uint8_t type;
+} channel_type_names[] = {
+    { "UINT8", CHANNEL_TYPE_U8 }, { "UBYTE", CHANNEL_TYPE_U8 },
+    { "INT8", CHANNEL_TYPE_S8 }, { "SBYTE", CHANNEL_TYPE_S8 },
+    { "UINT16", CHANNEL_TYPE_U16 }, { "UWORD", CHANNEL_TYPE_U16 },
+    { "INT16", CHANNEL_TYPE_S16 }, { "SWORD", CHANNEL_TYPE_S16 },
+    { "UINT32", CHANNEL_TYPE_U32 }, { "ULONG", CHANNEL_TYPE_U32 },
+    { "INT32", CHANNEL_TYPE_S32 }, { "SLONG", CHANNEL_TYPE_S32 },
+    { "FLOAT", CHANNEL_TYPE_F32 }, { "FLOAT32", CHANNEL_TYPE_F32 },
+    { "FLOAT32_IEEE", CHANNEL_TYPE_F32 },
+    { "DOUBLE", CHANNEL_TYPE_F64 }, { "FLOAT64", CHANNEL_TYPE_F64 },
+    { "FLOAT64_IEEE", CHANNEL_TYPE_F64 }
+};
+
+static const uint8_t channel_sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+size_t log_template_channel_size(uint8_t type) {
+    return type <= CHANNEL_TYPE_F64 ? channel_sizes[type] : 0;
+}
+
+void log_template_encode(const ChannelDescriptor* channel, double value, uint8_t* out) {
+    static const double limits[][2] = {
+        { 0, UINT8_MAX }, { INT8_MIN, INT8_MAX }, { 0, UINT16_MAX }, { INT16_MIN, INT16_MAX },
+        { 0, UINT32_MAX }, { INT32_MIN, INT32_MAX }
+    };
+    
+    if (channel->type >= CHANNEL_TYPE_F32) {
+        value = (value - channel->offset) / channel->factor;
+        if (channel->type == CHANNEL_TYPE_F32) {
+            float f = (float)value;
+            memcpy(out, &f, sizeof(f));
+        } else {
+            memcpy(out, &value, sizeof(value));
+        }
+        return;
+    }
+    
+    // Integers have no missing value; NaN stores as 0
+    if (isnan(value)) value = 0;
+    if (channel->min < channel->max) {
+        if (value < channel->min) value = channel->min;
+        if (value > channel->max) value = channel->max;
+    }
+    value = (value - channel->offset) / channel->factor;
+    if (value < limits[channel->type][0]) value = limits[channel->type][0];
+    if (value > limits[channel->type][1]) value = limits[channel->type][1];
+    
+    int64_t n = llround(value);
+    switch (channel->type) {
+        case CHANNEL_TYPE_U8:
+        case CHANNEL_TYPE_S8: {
+            uint8_t v = (uint8_t)n;
+            memcpy(out, &v, sizeof(v));
+            break;
+        }
+        case CHANNEL_TYPE_U16:
+        case CHANNEL_TYPE_S16: {
+            uint16_t v = (uint16_t)n;
+            memcpy(out, &v, sizeof(v));
+            break;
+        }
+        default: {
+            uint32_t v = (uint32_t)n;
+            memcpy(out, &v, sizeof(v));
+            break;
+        }
+    }
+}
+
+/* Token helpers */
+static int token_is(Token token, const char* word) {
+    size_t length = strlen(word);
+    return token.n == length && memcmp(token.p, word, length) == 0;
+}
+
+static void token_copy(Token token, char* out, size_t size) {
+    size_t length = token.n < size - 1 ? token.n : size - 1;
+    memcpy(out, token.p, length);
+    out[length] = '\0';
+}
+
+static int token_number(Token token, int base, double* value) {
+    char buffer[64];
+    char* end;
+    
+    if (token.n == 0 || token.n >= sizeof(buffer)) return -1;
+    token_copy(token, buffer, sizeof(buffer));
+    *value = base == 16 ? (double)strtol(buffer, &end, 16) : strtod(buffer, &end);
+    return *end == '\0' ? 0 : -1;
+}
+
+static int token_type(Token token, uint8_t* type) {
+    for (size_t i = 0; i < sizeof(channel_type_names) / sizeof(channel_type_names[0]); i++) {
+        if (token.n == strlen(channel_type_names[i].name) &&
+            strncasecmp(token.p, channel_type_names[i].name, token.n) == 0) {
+            *type = channel_type_names[i].type;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static Token token_trim(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    return (Token){ p, (size_t)(end - p) };
+}
+
+static ChannelDescriptor* template_add_channel(LogTemplate* tmpl, size_t* capacity) {
+    if (tmpl->channel_count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 64;
+        ChannelDescriptor* channels = realloc(tmpl->channels, grown * sizeof(ChannelDescriptor));
+        if (!channels) return NULL;
+        tmpl->channels = channels;
+        *capacity = grown;
+    }
+    
+    ChannelDescriptor* channel = &tmpl->channels[tmpl->channel_count++];
+    memset(channel, 0, sizeof(*channel));
+    channel->type = CHANNEL_TYPE_F32;
+    channel->factor = 1.0;
+    channel->pid = CHANNEL_NO_PID;
+    return channel;
+}
+
+/* XDF */
+
+/* Trimmed text of <tag>...</tag> inside [p, end) */
+static int xdf_tag(const char* p, const char* end, const char* tag, Token* value) {
+    char open_tag[32];
+    int length = snprintf(open_tag, sizeof(open_tag), "<%s>", tag);
+    
+    const char* start = memmem(p, (size_t)(end - p), open_tag, (size_t)length);
+    if (!start) return -1;
+    start += length;
+    const char* close_tag = memmem(start, (size_t)(end - start), "</", 2);
+    if (!close_tag) return -1;
+    
+    *value = token_trim(start, close_tag);
+    return 0;
+}
+
+static int xdf_number(const char* p, const char* end, const char* tag, int base, double* value) {
+    Token token;
+    return xdf_tag(p, end, tag, &token) == 0 ? token_number(token, base, value) : -1;
+}
+
+static int template_parse_xdf(LogTemplate* tmpl) {
+    const char* p = tmpl->text;
+    const char* end = tmpl->text + tmpl->text_size;
+    size_t capacity = 0;
+    double value;
+    
+    while ((p = memmem(p, (size_t)(end - p), "<MEASUREMENT", 12)) != NULL) {
+        p += 12;
+        if (p < end && *p != ' ' && *p != '>') continue;
+    
+        const char* close = memmem(p, (size_t)(end - p), "</MEASUREMENT>", 14);
+        const char* name = memmem(p, (size_t)((close ? close : end) - p), "name=\"", 6);
+        const char* tag_end = memchr(p, '>', (size_t)(end - p));
+        if (!close || !name || !tag_end || name > tag_end) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Malformed XDF MEASUREMENT at byte %zu",
+                        (size_t)(p - tmpl->text));
+            return -1;
+        }
+        name += 6;
+        const char* name_end = memchr(name, '"', (size_t)(tag_end - name));
+        if (!name_end) return -1;
+    
+        ChannelDescriptor* channel = template_add_channel(tmpl, &capacity);
+        if (!channel) return -1;
+        token_copy((Token){ name, (size_t)(name_end - name) }, channel->name, sizeof(channel->name));
+    
+        Token token;
+        if (xdf_tag(p, close, "DATATYPE", &token) != 0 || token_type(token, &channel->type) != 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "XDF measurement %s has no known DATATYPE", channel->name);
+            return -1;
+        }
+        if (xdf_tag(p, close, "UNIT", &token) == 0) {
+            token_copy(token, channel->unit, sizeof(channel->unit));
+        }
+        if (xdf_number(p, close, "MIN", 10, &value) == 0) channel->min = value;
+        if (xdf_number(p, close, "MAX", 10, &value) == 0) channel->max = value;
+        if (xdf_number(p, close, "SAMPLERATE", 10, &value) == 0) channel->rate_hz = (float)value;
+        if (xdf_number(p, close, "FACTOR", 10, &value) == 0 && value != 0) channel->factor = value;
+        if (xdf_number(p, close, "OFFSET", 10, &value) == 0) channel->offset = value;
+        if (xdf_number(p, close, "PID", 16, &value) == 0 && value >= 0 && value <= 0xFF) {
+            channel->pid = (int16_t)value;
+        }
+        p = close + 14;
+    }
+    
+    if (xdf_number(tmpl->text, end, "BUFFERSIZE", 10, &value) == 0 && value > 0) {
+        tmpl->buffer_records = (uint32_t)value;
+    }
+    return 0;
+}
+
+/* A2L */
+
+/* Next token: a word, or a string without its quotes. Returns 0 at the end. */
+static int a2l_next(Lexer* lexer, Token* token) {
+    const char* p = lexer->p;
+    const char* end = lexer->end;
+    
+    for (;;) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+        if (end - p >= 2 && p[0] == '/' && p[1] == '*') {
+            const char* close = memmem(p + 2, (size_t)(end - p - 2), "*/", 2);
+            p = close ? close + 2 : end;
+        } else if (end - p >= 2 && p[0] == '/' && p[1] == '/') {
+            const char* eol = memchr(p, '\n', (size_t)(end - p));
+            p = eol ? eol : end;
+        } else {
+            break;
+        }
+    }
+    if (p == end) {
+        lexer->p = p;
+        return 0;
+    }
+    
+    if (*p == '"') {
+        const char* start = ++p;
+        while (p < end && *p != '"') p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+        *token = (Token){ start, (size_t)(p - start) };
+        if (p < end) p++;
+    } else {
+        const char* start = p;
+        while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && *p != '"') p++;
+        *token = (Token){ start, (size_t)(p - start) };
+    }
+    lexer->p = p;
+    return 1;
+}
+
+/* Conversion of one measurement, resolved once all COMPU_METHODs are known */
+typedef struct {
+    Token name;
+    double factor;
+    double offset;
+    Token unit;
+} A2LConversion;
+
+static uint32_t token_hash(Token token) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < token.n; i++) hash = (hash ^ (uint8_t)token.p[i]) * 16777619u;
+    return hash;
+}
+
+static int a2l_parse_compu_method(Lexer* lexer, A2LConversion* method) {
+    Token kind, format, token;
+    double coeffs[6] = {0};
+    
+    method->factor = 1.0;
+    method->offset = 0.0;
+    if (!a2l_next(lexer, &method->name) || !a2l_next(lexer, &token) ||
+        !a2l_next(lexer, &kind) || !a2l_next(lexer, &format) || !a2l_next(lexer, &method->unit)) {
+        return -1;
+    }
+    
+    int depth = 0;
+    while (a2l_next(lexer, &token)) {
+        if (token_is(token, "/begin")) {
+            depth++;
+            a2l_next(lexer, &token);
+        } else if (token_is(token, "/end")) {
+            a2l_next(lexer, &token);
+            if (depth-- == 0) break;
+        } else if (depth == 0 && (token_is(token, "COEFFS_LINEAR") || token_is(token, "COEFFS"))) {
+            size_t count = token_is(token, "COEFFS") ? 6 : 2;
+            for (size_t i = 0; i < count; i++) {
+                if (!a2l_next(lexer, &token) || token_number(token, 10, &coeffs[i]) != 0) return -1;
+            }
+            if (count == 2) {
+                // phys = a * raw + b
+                method->factor = coeffs[0];
+                method->offset = coeffs[1];
+            } else if (coeffs[0] == 0 && coeffs[3] == 0 && coeffs[4] == 0 && coeffs[1] != 0) {
+                // raw = (b * phys + c) / f
+                method->factor = coeffs[5] / coeffs[1];
+                method->offset = -coeffs[2] / coeffs[1];
+            } else {
+                DEBUG_PRINT(DEBUG_LEVEL_WARN, "Non-linear COMPU_METHOD %.*s read as identity",
+                            (int)method->name.n, method->name.p);
+            }
+        }
+    }
+    if (!token_is(kind, "LINEAR") && !token_is(kind, "RAT_FUNC") && !token_is(kind, "IDENTICAL")) {
+        method->factor = 1.0;
+        method->offset = 0.0;
+    }
+    return 0;
+}
+
+static int a2l_parse_measurement(Lexer* lexer, LogTemplate* tmpl, size_t* capacity,
+                                 Token* conversion) {
+    Token name, description, type, token;
+    
+    if (!a2l_next(lexer, &name) || !a2l_next(lexer, &description) ||
+        !a2l_next(lexer, &type) || !a2l_next(lexer, conversion)) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Truncated A2L MEASUREMENT");
+        return -1;
+    }
+    
+    ChannelDescriptor* channel = template_add_channel(tmpl, capacity);
+    if (!channel) return -1;
+    token_copy(name, channel->name, sizeof(channel->name));
+    if (token_type(type, &channel->type) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "A2L measurement %s has unknown datatype %.*s",
+                    channel->name, (int)type.n, type.p);
+        return -1;
+    }
+    
+    // Resolution, accuracy, lower and upper limit; the templates give only the limits
+    double numbers[4];
+    size_t count = 0;
+    int pending = 0;
+    while (a2l_next(lexer, &token)) {
+        if (count < 4 && token_number(token, 10, &numbers[count]) == 0) {
+            count++;
+            continue;
+        }
+        pending = 1;
+        break;
+    }
+    if (count >= 2) {
+        channel->min = numbers[count >= 4 ? 2 : 0];
+        channel->max = numbers[count >= 4 ? 3 : 1];
+    }
+    
+    int depth = 0;
+    while (pending || a2l_next(lexer, &token)) {
+        pending = 0;
+        if (token_is(token, "/begin")) {
+            depth++;
+            a2l_next(lexer, &token);
+        } else if (token_is(token, "/end")) {
+            a2l_next(lexer, &token);
+            if (depth-- == 0) return 0;
+        } else if (depth > 0) {
+            continue;
+        } else if (token_is(token, "SAMPLED")) {
+            double rate;
+            if (a2l_next(lexer, &token) && token_number(token, 10, &rate) == 0) {
+                channel->rate_hz = (float)rate;
+            }
+        } else if (token_is(token, "OBD_PID")) {
+            double pid;
+            if (a2l_next(lexer, &token) && token_number(token, 10, &pid) == 0 &&
+                pid >= 0 && pid <= 0xFF) {
+                channel->pid = (int16_t)pid;
+            }
+        } else if (token_is(token, "PHYS_UNIT")) {
+            if (a2l_next(lexer, &token)) token_copy(token, channel->unit, sizeof(channel->unit));
+        }
+    }
+    DEBUG_PRINT(DEBUG_LEVEL_ERROR, "A2L measurement %s is not closed", channel->name);
+    return -1;
+}
+
+static int template_parse_a2l(LogTemplate* tmpl) {
+    Lexer lexer = { tmpl->text, tmpl->text + tmpl->text_size };
+    Token token;
+    size_t capacity = 0;
+    Token* conversions = NULL;         // Per channel
+    A2LConversion* methods = NULL;
+    size_t method_count = 0, method_capacity = 0;
+    int status = 0;
+    
+    while (status == 0 && a2l_next(&lexer, &token)) {
+        if (!token_is(token, "/begin") || !a2l_next(&lexer, &token)) continue;
+    
+        if (token_is(token, "MEASUREMENT")) {
+            Token conversion;
+            status = a2l_parse_measurement(&lexer, tmpl, &capacity, &conversion);
+            if (status == 0) {
+                Token* grown = realloc(conversions, capacity * sizeof(Token));
+                if (!grown) {
+                    status = -1;
+                    break;
+                }
+                conversions = grown;
+                conversions[tmpl->channel_count - 1] = conversion;
+            }
+        } else if (token_is(token, "COMPU_METHOD")) {
+            if (method_count == method_capacity) {
+                method_capacity = method_capacity ? method_capacity * 2 : 64;
+                A2LConversion* grown = realloc(methods, method_capacity * sizeof(A2LConversion));
+                if (!grown) {
+                    status = -1;
+                    break;
+                }
+                methods = grown;
+            }
+            status = a2l_parse_compu_method(&lexer, &methods[method_count]);
+            if (status == 0) method_count++;
+        } else if (token_is(token, "PROJECT")) {
+            if (a2l_next(&lexer, &token)) token_copy(token, tmpl->project, sizeof(tmpl->project));
+        } else if (token_is(token, "CHARACTERISTIC")) {
+            tmpl->characteristics++;
+        }
+    }
+    
+    // Resolve conversions through an open-addressed table of method names
+    size_t slots = 1;
+    while (slots < method_count * 2) slots <<= 1;
+    int32_t* table = status == 0 && method_count ? malloc(slots * sizeof(int32_t)) : NULL;
+    if (table) {
+        memset(table, 0xFF, slots * sizeof(int32_t));
+        for (size_t m = 0; m < method_count; m++) {
+            size_t slot = token_hash(methods[m].name) & (slots - 1);
+            while (table[slot] >= 0) slot = (slot + 1) & (slots - 1);
+            table[slot] = (int32_t)m;
+        }
+        for (size_t c = 0; c < tmpl->channel_count; c++) {
+            Token name = conversions[c];
+            if (token_is(name, "NO_CONVERSION")) continue;
+    
+            size_t slot = token_hash(name) & (slots - 1);
+            for (; table[slot] >= 0; slot = (slot + 1) & (slots - 1)) {
+                const A2LConversion* method = &methods[table[slot]];
+                if (method->name.n != name.n || memcmp(method->name.p, name.p, name.n) != 0) continue;
+    
+                ChannelDescriptor* channel = &tmpl->channels[c];
+                channel->factor = method->factor;
+                channel->offset = method->offset;
+                if (!channel->unit[0]) token_copy(method->unit, channel->unit, sizeof(channel->unit));
+                break;
+            }
+        }
+    } else if (status == 0 && method_count) {
+        status = -1;
+    }
+    
+    free(table);
+    free(methods);
+    free(conversions);
+    return status;
+}
+
+/* Loading */
+LogTemplate* log_template_parse(const char* text, size_t size, int format) {
+    if (!text) return NULL;
+    
+    LogTemplate* tmpl = calloc(1, sizeof(LogTemplate));
+    if (!tmpl) return NULL;
+    tmpl->format = format;
+    tmpl->text = text;
+    tmpl->text_size = size;
+    
+    int status = format == LOG_TEMPLATE_XDF ? template_parse_xdf(tmpl) : template_parse_a2l(tmpl);
+    if (status != 0 || tmpl->channel_count == 0) {
+        if (status == 0) DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Template has no measurements");
+        free(tmpl->channels);
+        free(tmpl);
+        return NULL;
+    }
+    return tmpl;
+}
+
+LogTemplate* log_template_load(const char* path) {
+    if (!path) return NULL;
+    
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open template %s: %s", path,
+                    fd < 0 ? strerror(errno) : "empty file");
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    
+    size_t size = (size_t)st.st_size;
+    const char* text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to map template %s: %s", path, strerror(errno));
+        return NULL;
+    }
+    madvise((void*)text, size, MADV_SEQUENTIAL);
+    
+    size_t first = 0;
+    while (first < size && (text[first] == ' ' || text[first] == '\t' ||
+                            text[first] == '\r' || text[first] == '\n')) {
+        first++;
+    }
+    int format = first < size && text[first] == '<' ? LOG_TEMPLATE_XDF : LOG_TEMPLATE_A2L;
+    
+    LogTemplate* tmpl = log_template_parse(text, size, format);
+    if (!tmpl) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Template %s could not be parsed", path);
+        munmap((void*)text, size);
+        return NULL;
+    }
+    tmpl->mapped_size = size;
+    return tmpl;
+}
+
+void log_template_free(LogTemplate* tmpl) {
+    if (!tmpl) return;
+    
+    if (tmpl->mapped_size) munmap((void*)tmpl->text, tmpl->mapped_size);
+    free(tmpl->channels);
+    free(tmpl);
+}
+
+int log_template_find(const LogTemplate* tmpl, const char* name) {
+    if (!tmpl || !name) return -1;
+    
+    for (size_t c = 0; c < tmpl->channel_count; c++) {
+        if (strcasecmp(tmpl->channels[c].name, name) == 0) return (int)c;
+    }
+    return -1;
+}
+
+size_t log_template_pids(const LogTemplate* tmpl, uint8_t* pids, uint32_t* period_ms,
+                         size_t max) {
+    size_t count = 0;
+    
+    if (!tmpl || !pids) return 0;
+    for (size_t c = 0; c < tmpl->channel_count && count < max; c++) {
+        const ChannelDescriptor* channel = &tmpl->channels[c];
+        if (channel->pid == CHANNEL_NO_PID) continue;
+    
+        pids[count] = (uint8_t)channel->pid;
+        if (period_ms) {
+            period_ms[count] = channel->rate_hz > 0 ? (uint32_t)(1000.0f / channel->rate_hz + 0.5f) : 0;
+        }
+        count++;
+    }
+    return count;
+}
+
+/* Template lookup */
+static int template_candidate(const char* dir, const char* name, char* path, size_t size) {
+    int n = snprintf(path, size, "%s/%s", dir, name);
+    return n > 0 && (size_t)n < size && access(path, R_OK) == 0;
+}
+
+int log_template_path(const char* name, char* path, size_t size) {
+    if (!name || !path || size == 0) return -1;
+    
+    const char* override = getenv(LOG_TEMPLATE_DIR_ENV);
+    if (override && override[0] && template_candidate(override, name, path, size)) return 0;
+    
+#ifdef __linux__
+    char exe[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    char* slash = length > 0 ? memrchr(exe, '/', (size_t)length) : NULL;
+    if (slash) {
+        static const char* const relative[] = { "templates", "../templates" };
+        char dir[PATH_MAX + 48];
+        *slash = '\0';
+        for (size_t i = 0; i < sizeof(relative) / sizeof(relative[0]); i++) {
+            snprintf(dir, sizeof(dir), "%s/%s", exe, relative[i]);
+            if (template_candidate(dir, name, path, size)) return 0;
+        }
+    }
+#endif
+    
+    return template_candidate("templates", name, path, size) ? 0 : -1;
+}
+
+/* Benchmark */
+int log_template_benchmark(size_t measurements) {
+    size_t capacity = measurements * 420 + 4096;
+    char* text = malloc(capacity);
+    if (!text) return -1;
+    
+    // Shaped like an OEM file: conversions, IF_DATA and comments between measurements
+    size_t size = (size_t)snprintf(text, capacity, "ASAP2_VERSION 1 61\n/begin PROJECT Bench \"\"\n"
+                                   "/begin MODULE ECU \"\"\n");
+    for (size_t i = 0; i < measurements && size + 420 < capacity; i++) {
+        size += (size_t)snprintf(text + size, capacity - size,
+            "/* channel %zu */\n"
+            "/begin COMPU_METHOD CM_%zu \"\" RAT_FUNC \"%%6.2\" \"rpm\"\n"
+            "  COEFFS 0 4 0 0 0 1\n/end COMPU_METHOD\n"
+            "/begin MEASUREMENT Signal_%zu \"Bench signal %zu\"\n"
+            "  UWORD CM_%zu 1 100 0 16383.75\n  ECU_ADDRESS 0x%zx\n"
+            "  /begin IF_DATA XCP /begin DAQ_EVENT FIXED_EVENT_LIST EVENT 0x1 /end DAQ_EVENT "
+            "/end IF_DATA\n  SAMPLED 100\n/end MEASUREMENT\n",
+            i, i, i, i, i, 0x40000000 + i * 2);
+    }
+    size += (size_t)snprintf(text + size, capacity - size, "/end MODULE\n/end PROJECT\n");
+    
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    LogTemplate* tmpl = log_template_parse(text, size, LOG_TEMPLATE_A2L);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ms = (double)(t1.tv_sec - t0.tv_sec) * 1e3 + (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+    
+    int status = -1;
+    if (tmpl && tmpl->channel_count == measurements && tmpl->channels[0].factor == 0.25 &&
+        tmpl->channels[0].max == 16383.75) {
+        printf("Template parser: %zu measurements, %.1f MB in %.1f ms (%.0f MB/s)\n",
+               measurements, (double)size / 1e6, ms, (double)size / 1e3 / ms);
+        status = ms < TEMPLATE_BENCH_TARGET_MS ? 0 : -1;
+    } else {
+        printf("Template parser: FAILED on %zu measurements\n", measurements);
+    }
+    
+    log_template_free(tmpl);
+    free(text);
+    return status;
+}
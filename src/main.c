@@ -1,4 +1,16 @@
 #include "obd2_core.h"
+#include "device_plugin.h"
+#include "sct_emulator.h"
+#include "expr_engine.h"
+#include "safety_rules.h"
+#include "timebase.h"
+#include "ts_codec.h"
+#include "column_log.h"
+#include "log_template.h"
+#include "mdf4_writer.h"
+#include "csv_export.h"
+#include "csv_import.h"
+#include "session_replay.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -11,6 +23,39 @@ static int handle_diagnostic_command(const char* command) {
     else if (strcmp(command, "--test-j2534") == 0) {
         return diag_test_j2534_device();
     }
+    else if (strcmp(command, "--test-batch") == 0) {
+        return device_batch_self_test();
+    }
+    else if (strcmp(command, "--test-sct") == 0) {
+        return sct_emulator_self_test(1000, 2000);
+    }
+    else if (strcmp(command, "--test-expr") == 0) {
+        return expr_benchmark(64, 100000);
+    }
+    else if (strcmp(command, "--test-safety") == 0) {
+        return safety_rules_benchmark(100, 1000000);
+    }
+    else if (strcmp(command, "--test-column-log") == 0) {
+        return column_log_self_test();
+    }
+    else if (strcmp(command, "--test-codec") == 0) {
+        return ts_codec_benchmark(1000000);
+    }
+    else if (strcmp(command, "--test-template") == 0) {
+        return log_template_benchmark(50000);
+    }
+    else if (strcmp(command, "--test-mdf4") == 0) {
+        return mdf4_benchmark(1000000);
+    }
+    else if (strcmp(command, "--test-csv") == 0) {
+        return csv_export_benchmark(1000000);
+    }
+    else if (strcmp(command, "--test-csv-import") == 0) {
+        return csv_import_benchmark(1000000);
+    }
+    else if (strcmp(command, "--test-replay") == 0) {
+        return session_replay_benchmark(1000000);
+    }
     else if (strcmp(command, "--test-voltage") == 0) {
         return diag_verify_voltage_levels();
     }
@@ -51,6 +96,9 @@ int main(int argc, char* argv[]) {
     debug_print_init();
     DEBUG_PRINT(DEBUG_LEVEL_INFO, "OBD2 Diagnostic Tool Starting...");
     
+    /* Discover device backend plugins; they load only when selected */
+    device_plugin_scan(DEVICE_PLUGIN_DEFAULT_DIR);
+    
     /* Check for diagnostic commands */
     if (argc > 1) {
         return handle_diagnostic_command(argv[1]);
@@ -95,7 +143,7 @@ int main(int argc, char* argv[]) {
         DEBUG_PRINT(DEBUG_LEVEL_INFO, "Current RPM: %.2f", value);
 
         /* Log the RPM reading */
-        logEntry.timestamp = (uint32_t)time(NULL);
+        logEntry.timestamp = timebase_now_us();
         logEntry.pid = request.pid;
         logEntry.dataLength = 2;
         logEntry.data[0] = response.data[0];
@@ -112,6 +160,7 @@ int main(int argc, char* argv[]) {
 
     /* Cleanup */
     log_free(&logBuffer);
+    device_plugin_unload_all();
 
     return 0;
 }
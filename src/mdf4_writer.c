@@ -0,0 +1,742 @@
+#include "mdf4_writer.h"
+#include "column_log.h"
+#include "csv_export.h"
+#include "timebase.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define MDF4_ID_SIZE        64
+#define MDF4_HD_OFFSET      64
+#define MDF4_UNFIN_FLAGS    0x0011  // Cycle counters and data lists are written at close
+
+/* Block layouts. Every block starts with a header and its links, then
+ * the fixed data below; blocks start on 8-byte boundaries. */
+typedef struct {
+    char id[4];
+    uint32_t reserved;
+    uint64_t length;           // Header, links and data
+    uint64_t link_count;
+} Mdf4BlockHeader;
+
+typedef struct {
+    char file[8];              // "MDF     ", "UnFinMF " while writing
+    char version[8];
+    char program[8];
+    uint8_t reserved1[4];
+    uint16_t version_number;
+    uint8_t reserved2[30];
+    uint16_t unfinalized;
+    uint16_t custom_unfinalized;
+} Mdf4IdBlock;
+
+typedef struct {
+    uint64_t start_time_ns;    // UTC
+    int16_t tz_offset_min;
+    int16_t dst_offset_min;
+    uint8_t time_flags;
+    uint8_t time_class;
+    uint8_t flags;
+    uint8_t reserved;
+    double start_angle_rad;
+    double start_distance_m;
+} Mdf4HdData;
+
+typedef struct {
+    uint64_t time_ns;
+    int16_t tz_offset_min;
+    int16_t dst_offset_min;
+    uint8_t time_flags;
+    uint8_t reserved[3];
+} Mdf4FhData;
+
+typedef struct {
+    uint64_t record_id;
+    uint64_t cycle_count;      // Patched at close
+    uint16_t flags;
+    uint16_t path_separator;
+    uint8_t reserved[4];
+    uint32_t data_bytes;
+    uint32_t inval_bytes;
+} Mdf4CgData;
+
+typedef struct {
+    uint8_t type;              // 0 = fixed length, 2 = master
+    uint8_t sync_type;         // 1 = time
+    uint8_t data_type;         // 0 = unsigned, 2 = signed, 4 = float, all little endian
+    uint8_t bit_offset;
+    uint32_t byte_offset;
+    uint32_t bit_count;
+    uint32_t flags;
+    uint32_t inval_bit_pos;
+    uint8_t precision;
+    uint8_t reserved;
+    uint16_t attachment_count;
+    double val_range_min;
+    double val_range_max;
+    double limit_min;          // Physical
+    double limit_max;
+    double limit_ext_min;
+    double limit_ext_max;
+} Mdf4CnData;
+
+typedef struct {
+    uint8_t type;              // 1 = linear
+    uint8_t precision;
+    uint16_t flags;
+    uint16_t ref_count;
+    uint16_t val_count;
+    double phy_range_min;
+    double phy_range_max;
+    double values[2];          // Physical = values[1] * raw + values[0]
+} Mdf4CcData;
+
+typedef struct {
+    char org_block_type[2];    // "DT"
+    uint8_t zip_type;          // 1 = transposition + deflate
+    uint8_t reserved;
+    uint32_t zip_parameter;    // Record size for transposition
+    uint64_t org_data_length;
+    uint64_t data_length;
+} Mdf4DzData;
+
+_Static_assert(sizeof(Mdf4BlockHeader) == 24, "MDF4 block header layout");
+_Static_assert(sizeof(Mdf4IdBlock) == MDF4_ID_SIZE, "MDF4 ID block layout");
+_Static_assert(sizeof(Mdf4HdData) == 32, "MDF4 HD block layout");
+_Static_assert(sizeof(Mdf4FhData) == 16, "MDF4 FH block layout");
+_Static_assert(sizeof(Mdf4CgData) == 32, "MDF4 CG block layout");
+_Static_assert(sizeof(Mdf4CnData) == 72, "MDF4 CN block layout");
+_Static_assert(sizeof(Mdf4CcData) == 40, "MDF4 CC block layout");
+_Static_assert(sizeof(Mdf4DzData) == 24, "MDF4 DZ block layout");
+
+#define MDF4_HD_SIZE (sizeof(Mdf4BlockHeader) + 6 * sizeof(uint64_t) + sizeof(Mdf4HdData))
+
+/* One data group: a time master followed by the group's channels */
+typedef struct {
+    float rate_hz;
+    size_t* channels;          // Indexes into the writer's channels
+    uint32_t* offsets;         // Byte offset of each channel in the record
+    size_t channel_count;
+    uint32_t data_bytes;       // Time and values
+    uint32_t inval_bytes;
+    size_t record_size;
+    uint64_t cycles;
+    uint8_t* buffer;           // Allocated with the first record
+    size_t capacity;           // Whole records per block
+    size_t fill;
+    uint64_t* blocks;          // Offsets of written DT/DZ blocks
+    size_t block_count;
+    size_t block_capacity;
+    uint64_t dg_offset;
+    uint64_t cg_offset;
+} Mdf4Group;
+
+struct Mdf4Writer {
+    int fd;
+    char path[256];
+    uint64_t end;              // Where the next block goes
+    ChannelDescriptor* channels;
+    size_t channel_count;
+    Mdf4Group groups[MDF4_MAX_GROUPS];
+    size_t group_count;
+    int64_t start_wall_us;
+    int compression;
+    uint8_t* scratch;          // Transposed block
+    uint8_t* packed;           // Deflated block
+    size_t packed_size;
+    uint8_t appended;
+    int failed;
+};
+
+/* Block output */
+static int mdf_pwrite(Mdf4Writer* writer, const void* data, size_t size, uint64_t offset) {
+    const uint8_t* bytes = data;
+    
+    while (size > 0) {
+        ssize_t n = pwrite(writer->fd, bytes, size, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to write %s: %s", writer->path,
+                        n < 0 ? strerror(errno) : "short write");
+            writer->failed = 1;
+            return -1;
+        }
+        bytes += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+/* Appends a block from up to two data parts; returns its offset, 0 on error */
+static uint64_t mdf_block(Mdf4Writer* writer, const char* id, const uint64_t* links,
+                          size_t link_count, const void* data, size_t size,
+                          const void* payload, size_t payload_size) {
+    static const uint8_t padding[8];
+    Mdf4BlockHeader header = { .link_count = link_count };
+    uint64_t offset = writer->end;
+    
+    memcpy(header.id, id, 4);
+    header.length = sizeof(header) + link_count * sizeof(uint64_t) + size + payload_size;
+    size_t pad = (8 - header.length % 8) % 8;
+    
+    if (writer->failed ||
+        mdf_pwrite(writer, &header, sizeof(header), offset) != 0 ||
+        mdf_pwrite(writer, links, link_count * sizeof(uint64_t), offset + sizeof(header)) != 0 ||
+        mdf_pwrite(writer, data, size, offset + header.length - size - payload_size) != 0 ||
+        mdf_pwrite(writer, payload, payload_size, offset + header.length - payload_size) != 0 ||
+        mdf_pwrite(writer, padding, pad, offset + header.length) != 0) {
+        return 0;
+    }
+    writer->end = offset + header.length + pad;
+    return offset;
+}
+
+/* TX or MD block holding a string; text blocks are padded inside */
+static uint64_t mdf_text(Mdf4Writer* writer, const char* id, const char* text) {
+    uint8_t buffer[512] = {0};
+    size_t length = strlen(text);
+    if (length >= sizeof(buffer)) length = sizeof(buffer) - 1;
+    memcpy(buffer, text, length);
+    
+    // Length plus terminator, rounded so the block needs no outside padding
+    size_t size = (length + 1 + 7) & ~(size_t)7;
+    return mdf_block(writer, id, NULL, 0, buffer, size, NULL, 0);
+}
+
+static uint8_t mdf_data_type(uint8_t type) {
+    switch (type) {
+        case CHANNEL_TYPE_S8:
+        case CHANNEL_TYPE_S16:
+        case CHANNEL_TYPE_S32: return 2;
+        case CHANNEL_TYPE_F32:
+        case CHANNEL_TYPE_F64: return 4;
+        default:               return 0;
+    }
+}
+
+/* Metadata: one DG/CG per group, CN chains with their names, units and
+ * conversions. Groups are written last to first so each next link is
+ * already known; the HD block at the front is filled in at the end. */
+static uint64_t write_group(Mdf4Writer* writer, Mdf4Group* group, uint64_t next_dg) {
+    uint64_t next_cn = 0;
+    
+    for (size_t k = group->channel_count; k-- > 0; ) {
+        const ChannelDescriptor* channel = &writer->channels[group->channels[k]];
+        uint64_t links[8] = { next_cn };
+        Mdf4CnData cn = {
+            .data_type = mdf_data_type(channel->type),
+            .byte_offset = group->offsets[k],
+            .bit_count = (uint32_t)(log_template_channel_size(channel->type) * 8),
+            .flags = 0x02,                     // Invalidation bit valid
+            .inval_bit_pos = (uint32_t)k
+        };
+        if (channel->min < channel->max) {
+            cn.flags |= 0x10;                  // Limit range valid
+            cn.limit_min = channel->min;
+            cn.limit_max = channel->max;
+        }
+    
+        links[2] = mdf_text(writer, "##TX", channel->name);
+        if (channel->unit[0]) links[6] = mdf_text(writer, "##TX", channel->unit);
+        if (channel->factor != 1.0 || channel->offset != 0.0) {
+            uint64_t cc_links[4] = {0};
+            Mdf4CcData cc = {
+                .type = 1,
+                .val_count = 2,
+                .values = { channel->offset, channel->factor }
+            };
+            links[4] = mdf_block(writer, "##CC", cc_links, 4, &cc, sizeof(cc), NULL, 0);
+        }
+        next_cn = mdf_block(writer, "##CN", links, 8, &cn, sizeof(cn), NULL, 0);
+    }
+    
+    // Time master, seconds from the header's start time
+    uint64_t master_links[8] = { next_cn };
+    Mdf4CnData master = {
+        .type = 2,
+        .sync_type = 1,
+        .data_type = 4,
+        .bit_count = 64
+    };
+    master_links[2] = mdf_text(writer, "##TX", "time");
+    master_links[6] = mdf_text(writer, "##TX", "s");
+    uint64_t first_cn = mdf_block(writer, "##CN", master_links, 8, &master, sizeof(master), NULL, 0);
+    
+    uint64_t cg_links[6] = { 0, first_cn };
+    Mdf4CgData cg = {
+        .data_bytes = group->data_bytes,
+        .inval_bytes = group->inval_bytes
+    };
+    if (group->rate_hz > 0) {
+        char name[32];
+        snprintf(name, sizeof(name), "%g Hz", group->rate_hz);
+        cg_links[2] = mdf_text(writer, "##TX", name);
+    }
+    group->cg_offset = mdf_block(writer, "##CG", cg_links, 6, &cg, sizeof(cg), NULL, 0);
+    
+    uint64_t dg_links[4] = { next_dg, group->cg_offset };
+    uint8_t dg_data[8] = {0};                  // No record IDs: sorted
+    group->dg_offset = mdf_block(writer, "##DG", dg_links, 4, dg_data, sizeof(dg_data), NULL, 0);
+    return group->dg_offset;
+}
+
+static int write_header(Mdf4Writer* writer, uint64_t first_dg, int finalized) {
+    Mdf4IdBlock id;
+    memset(&id, 0, sizeof(id));
+    memcpy(id.file, finalized ? "MDF     " : "UnFinMF ", 8);
+    memcpy(id.version, "4.10    ", 8);
+    memcpy(id.program, "OBD2Tool", 8);
+    id.version_number = 410;
+    id.unfinalized = finalized ? 0 : MDF4_UNFIN_FLAGS;
+    if (mdf_pwrite(writer, &id, sizeof(id), 0) != 0) return -1;
+    if (finalized) return 0;
+    
+    // File history is mandatory and needs its XML comment
+    const char* comment =
+        "<FHcomment xmlns=\"http://www.asam.net/mdf/v4\"><TX>Session export</TX>"
+        "<tool_id>obd2_program</tool_id><tool_vendor>OBD2 Diagnostic Tool</tool_vendor>"
+        "<tool_version>1.0</tool_version></FHcomment>";
+    uint64_t fh_links[2] = { 0, mdf_text(writer, "##MD", comment) };
+    Mdf4FhData fh = { .time_ns = (uint64_t)time(NULL) * 1000000000ULL };
+    uint64_t fh_offset = mdf_block(writer, "##FH", fh_links, 2, &fh, sizeof(fh), NULL, 0);
+    
+    Mdf4BlockHeader header = { .length = MDF4_HD_SIZE, .link_count = 6 };
+    uint64_t hd_links[6] = { first_dg, fh_offset };
+    Mdf4HdData hd = {
+        .start_time_ns = writer->start_wall_us > 0 ? (uint64_t)writer->start_wall_us * 1000 : 0
+    };
+    memcpy(header.id, "##HD", 4);
+    if (!fh_offset ||
+        mdf_pwrite(writer, &header, sizeof(header), MDF4_HD_OFFSET) != 0 ||
+        mdf_pwrite(writer, hd_links, sizeof(hd_links), MDF4_HD_OFFSET + sizeof(header)) != 0 ||
+        mdf_pwrite(writer, &hd, sizeof(hd),
+                   MDF4_HD_OFFSET + sizeof(header) + sizeof(hd_links)) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Writer */
+Mdf4Writer* mdf4_writer_create(const char* path, const ChannelDescriptor* channels,
+                               size_t count, int64_t start_wall_us) {
+    if (!path || !channels || count == 0) return NULL;
+    
+    Mdf4Writer* writer = calloc(1, sizeof(Mdf4Writer));
+    if (!writer) return NULL;
+    writer->fd = -1;
+    snprintf(writer->path, sizeof(writer->path), "%s", path);
+    writer->start_wall_us = start_wall_us;
+    writer->channel_count = count;
+    writer->channels = malloc(count * sizeof(ChannelDescriptor));
+    if (!writer->channels) {
+        mdf4_writer_close(writer);
+        return NULL;
+    }
+    memcpy(writer->channels, channels, count * sizeof(ChannelDescriptor));
+    
+    // Group channels by rate, extra rates sharing the last group
+    for (size_t c = 0; c < count; c++) {
+        size_t g = 0;
+        while (g < writer->group_count && writer->groups[g].rate_hz != channels[c].rate_hz) g++;
+        if (g == writer->group_count) {
+            if (g == MDF4_MAX_GROUPS) {
+                g--;
+            } else {
+                writer->groups[g].rate_hz = channels[c].rate_hz;
+                writer->group_count++;
+            }
+        }
+        writer->groups[g].channel_count++;
+    }
+    for (size_t g = 0; g < writer->group_count; g++) {
+        Mdf4Group* group = &writer->groups[g];
+        group->channels = malloc(group->channel_count * sizeof(size_t));
+        group->offsets = malloc(group->channel_count * sizeof(uint32_t));
+        if (!group->channels || !group->offsets) {
+            mdf4_writer_close(writer);
+            return NULL;
+        }
+        group->data_bytes = sizeof(double);
+        group->channel_count = 0;
+    }
+    for (size_t c = 0; c < count; c++) {
+        size_t g = 0;
+        while (g < writer->group_count - 1 && writer->groups[g].rate_hz != channels[c].rate_hz) g++;
+        Mdf4Group* group = &writer->groups[g];
+        group->channels[group->channel_count] = c;
+        group->offsets[group->channel_count++] = group->data_bytes;
+        group->data_bytes += (uint32_t)log_template_channel_size(channels[c].type);
+    }
+    
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create %s: %s", path, strerror(errno));
+        mdf4_writer_close(writer);
+        return NULL;
+    }
+    
+    // ID, then room for HD, then the metadata of every group
+    writer->end = MDF4_HD_OFFSET + MDF4_HD_SIZE;
+    uint64_t first_dg = 0;
+    for (size_t g = writer->group_count; g-- > 0; ) {
+        Mdf4Group* group = &writer->groups[g];
+        group->inval_bytes = (uint32_t)((group->channel_count + 7) / 8);
+        group->record_size = group->data_bytes + group->inval_bytes;
+        group->capacity = MDF4_BLOCK_SIZE / group->record_size;
+        first_dg = write_group(writer, group, first_dg);
+    }
+    if (writer->failed || write_header(writer, first_dg, 0) != 0) {
+        mdf4_writer_close(writer);
+        unlink(path);
+        return NULL;
+    }
+    return writer;
+}
+
+int mdf4_writer_set_compression(Mdf4Writer* writer, int level) {
+    if (!writer || writer->appended || level < 0 || level > 9) return -1;
+
+#ifdef HAVE_ZLIB
+    writer->compression = level;
+    return 0;
+#else
+    if (level > 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Built without zlib, writing uncompressed MDF4 blocks");
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+/* Writes the group's buffered records as one DT or DZ block */
+static int group_flush(Mdf4Writer* writer, Mdf4Group* group) {
+    if (group->fill == 0) return 0;
+    
+    size_t size = group->fill * group->record_size;
+    uint64_t offset = 0;
+
+#ifdef HAVE_ZLIB
+    if (writer->compression) {
+        // Byte planes compress far better than records: byte k of every
+        // record, then byte k+1, as the transposition DZ type defines
+        size_t rows = group->fill;
+        for (size_t k = 0; k < group->record_size; k++) {
+            const uint8_t* in = group->buffer + k;
+            uint8_t* out = writer->scratch + k * rows;
+            for (size_t r = 0; r < rows; r++) out[r] = in[r * group->record_size];
+        }
+    
+        uLongf packed = (uLongf)writer->packed_size;
+        if (compress2(writer->packed, &packed, writer->scratch, (uLong)size,
+                      writer->compression) == Z_OK && packed < size) {
+            Mdf4DzData dz = {
+                .org_block_type = { 'D', 'T' },
+                .zip_type = 1,
+                .zip_parameter = (uint32_t)group->record_size,
+                .org_data_length = size,
+                .data_length = packed
+            };
+            offset = mdf_block(writer, "##DZ", NULL, 0, &dz, sizeof(dz), writer->packed, packed);
+        }
+    }
+#endif
+    if (!offset) offset = mdf_block(writer, "##DT", NULL, 0, NULL, 0, group->buffer, size);
+    if (!offset) return -1;
+    
+    if (group->block_count == group->block_capacity) {
+        size_t capacity = group->block_capacity ? group->block_capacity * 2 : 16;
+        uint64_t* blocks = realloc(group->blocks, capacity * sizeof(uint64_t));
+        if (!blocks) {
+            writer->failed = 1;
+            return -1;
+        }
+        group->blocks = blocks;
+        group->block_capacity = capacity;
+    }
+    group->blocks[group->block_count++] = offset;
+    group->fill = 0;
+    return 0;
+}
+
+int mdf4_writer_append(Mdf4Writer* writer, int64_t wall_us, const float* values) {
+    if (!writer || !values || writer->failed) return -1;
+    
+    double t = (double)(wall_us - writer->start_wall_us) * 1e-6;
+    for (size_t g = 0; g < writer->group_count; g++) {
+        Mdf4Group* group = &writer->groups[g];
+        size_t k = 0;
+        while (k < group->channel_count && isnan(values[group->channels[k]])) k++;
+        if (k == group->channel_count) continue;
+    
+        if (!group->buffer) {
+            group->buffer = malloc(group->capacity * group->record_size);
+            if (!group->buffer) {
+                writer->failed = 1;
+                return -1;
+            }
+        }
+        if (writer->compression && !writer->scratch) {
+            writer->packed_size = MDF4_BLOCK_SIZE;  // Larger output is stored as DT
+            writer->scratch = malloc(MDF4_BLOCK_SIZE);
+            writer->packed = malloc(writer->packed_size);
+            if (!writer->scratch || !writer->packed) {
+                writer->failed = 1;
+                return -1;
+            }
+        }
+        writer->appended = 1;
+    
+        uint8_t* record = group->buffer + group->fill * group->record_size;
+        uint8_t* inval = record + group->data_bytes;
+        memcpy(record, &t, sizeof(t));
+        memset(inval, 0, group->inval_bytes);
+        for (k = 0; k < group->channel_count; k++) {
+            float value = values[group->channels[k]];
+            if (isnan(value)) inval[k / 8] |= (uint8_t)(1u << (k % 8));
+            log_template_encode(&writer->channels[group->channels[k]], value,
+                                record + group->offsets[k]);
+        }
+        group->cycles++;
+        if (++group->fill == group->capacity && group_flush(writer, group) != 0) return -1;
+    }
+    return 0;
+}
+
+/* Points the DG at its data: the block itself, or a DL listing them all.
+ * Every block but the last holds a full buffer, so the list can use the
+ * equal-length form. */
+static int group_finish(Mdf4Writer* writer, Mdf4Group* group) {
+    uint64_t data = group->block_count == 1 ? group->blocks[0] : 0;
+    
+    if (group->block_count > 1) {
+        size_t link_count = group->block_count + 1;
+        uint64_t* links = calloc(link_count, sizeof(uint64_t));
+        if (!links) return -1;
+        memcpy(links + 1, group->blocks, group->block_count * sizeof(uint64_t));
+        struct {
+            uint8_t flags;             // Equal length
+            uint8_t reserved[3];
+            uint32_t count;
+            uint64_t equal_length;
+        } dl = { 1, {0}, (uint32_t)group->block_count, group->capacity * group->record_size };
+        data = mdf_block(writer, "##DL", links, link_count, &dl, sizeof(dl), NULL, 0);
+        free(links);
+        if (!data) return -1;
+    }
+    
+    // dg_data is the third DG link; cg_cycle_count follows cg_record_id
+    return mdf_pwrite(writer, &data, sizeof(data),
+                      group->dg_offset + sizeof(Mdf4BlockHeader) + 2 * sizeof(uint64_t)) != 0 ||
+           mdf_pwrite(writer, &group->cycles, sizeof(group->cycles),
+                      group->cg_offset + sizeof(Mdf4BlockHeader) + 6 * sizeof(uint64_t) +
+                      offsetof(Mdf4CgData, cycle_count)) != 0 ? -1 : 0;
+}
+
+int mdf4_writer_close(Mdf4Writer* writer) {
+    if (!writer) return -1;
+    
+    int status = 0;
+    if (writer->fd >= 0) {
+        for (size_t g = 0; g < writer->group_count && status == 0; g++) {
+            if (group_flush(writer, &writer->groups[g]) != 0 ||
+                group_finish(writer, &writer->groups[g]) != 0) {
+                status = -1;
+            }
+        }
+        if (status == 0 && !writer->failed) status = write_header(writer, 0, 1);
+        if (writer->failed) status = -1;
+        if (close(writer->fd) != 0) status = -1;
+    }
+    
+    for (size_t g = 0; g < writer->group_count; g++) {
+        free(writer->groups[g].channels);
+        free(writer->groups[g].offsets);
+        free(writer->groups[g].buffer);
+        free(writer->groups[g].blocks);
+    }
+    free(writer->channels);
+    free(writer->scratch);
+    free(writer->packed);
+    free(writer);
+    return status;
+}
+
+/* Session export */
+int mdf4_export_log(const char* input_path, const char* output_path,
+                    const char* template_path, int compression) {
+    if (!input_path || !output_path) return -1;
+    
+    if (column_log_is_csv_path(input_path)) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "MDF4 export reads columnar session logs, not %s", input_path);
+        return -1;
+    }
+    ColumnLogReader* reader = column_log_open(input_path);
+    if (!reader) return -1;
+    LogTemplate* tmpl = template_path ? log_template_load(template_path) : NULL;
+    
+    size_t count = column_log_channel_count(reader);
+    ChannelDescriptor* channels = calloc(count ? count : 1, sizeof(ChannelDescriptor));
+    size_t* indexes = malloc((count ? count : 1) * sizeof(size_t));
+    float* row = malloc((count ? count : 1) * sizeof(float));
+    int status = channels && indexes && row && count ? 0 : -1;
+    
+    for (size_t c = 0; c < count && status == 0; c++) {
+        const ColumnLogChannel* source = column_log_channel(reader, c);
+        int match = log_template_find(tmpl, source->name);
+        if (match >= 0) {
+            channels[c] = tmpl->channels[match];
+        } else {
+            snprintf(channels[c].name, sizeof(channels[c].name), "%s", source->name);
+            snprintf(channels[c].unit, sizeof(channels[c].unit), "%s", source->unit);
+            channels[c].type = CHANNEL_TYPE_F32;
+            channels[c].factor = 1.0;
+            channels[c].pid = CHANNEL_NO_PID;
+        }
+        indexes[c] = c;
+    }
+    
+    // Wall time of the first row anchors the file
+    TimebaseAnchor anchor;
+    ColumnChunkInfo info;
+    column_log_get_anchor(reader, &anchor);
+    int64_t start_wall_us = anchor.wall_us;
+    if (column_log_chunk_count(reader) > 0 && column_log_chunk_info(reader, 0, &info) == 0) {
+        start_wall_us += (int64_t)(info.t_min - anchor.monotonic_us);
+    }
+    
+    Mdf4Writer* writer = status == 0 ? mdf4_writer_create(output_path, channels, count,
+                                                          start_wall_us) : NULL;
+    if (!writer || (compression && mdf4_writer_set_compression(writer, compression) != 0)) {
+        status = -1;
+    }
+    
+    ColumnLogIterator* iter = status == 0 ? column_log_iter_open(reader, 0, UINT64_MAX, indexes,
+                                                                 count) : NULL;
+    if (status == 0 && !iter) status = -1;
+    
+    const uint64_t* timestamps;
+    const float* const* columns;
+    size_t rows;
+    while (status == 0 && (rows = column_log_iter_next(iter, &timestamps, &columns)) > 0) {
+        for (size_t r = 0; r < rows && status == 0; r++) {
+            for (size_t c = 0; c < count; c++) row[c] = columns[c][r];
+            int64_t wall_us = anchor.wall_us + (int64_t)(timestamps[r] - anchor.monotonic_us);
+            status = mdf4_writer_append(writer, wall_us, row);
+        }
+    }
+    
+    column_log_iter_close(iter);
+    if (writer && mdf4_writer_close(writer) != 0) status = -1;
+    if (status == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Exported %s to %s", input_path, output_path);
+    } else if (writer) {
+        unlink(output_path);
+    }
+    free(row);
+    free(indexes);
+    free(channels);
+    log_template_free(tmpl);
+    column_log_reader_close(reader);
+    return status;
+}
+
+/* Benchmark */
+#define MDF4_BENCH_LOG "mdf4_bench.clog"
+#define MDF4_BENCH_CSV "mdf4_bench.csv"
+#define MDF4_BENCH_MF4 "mdf4_bench.mf4"
+#define MDF4_BENCH_TEMPLATE "logger.a2l"
+
+static double bench_seconds(const struct timespec* t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+static long long bench_file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_size : 0;
+}
+
+int mdf4_benchmark(size_t rows) {
+    static const char* const names[] = {
+        "RPM", "Speed", "VE", "MAF", "Torque", "Boost", "AFR", "IAT", "TPS", "G-Force"
+    };
+    const size_t count = sizeof(names) / sizeof(names[0]);
+    ColumnLogChannel channels[10];
+    float values[10];
+    
+    memset(channels, 0, sizeof(channels));
+    for (size_t c = 0; c < count; c++) {
+        snprintf(channels[c].name, sizeof(channels[c].name), "%s", names[c]);
+        channels[c].type = COLUMN_TYPE_F32;
+    }
+    ColumnLog* log = column_log_create(MDF4_BENCH_LOG, channels, count, 0);
+    if (!log) return -1;
+    
+    // A 100 Hz drive: slow signals with a little noise on each
+    uint64_t t0 = timebase_now_us();
+    uint32_t noise = 12345;
+    for (size_t r = 0; r < rows; r++) {
+        double phase = (double)r / 1000.0;
+        for (size_t c = 0; c < count; c++) {
+            noise = noise * 1103515245u + 12345u;
+            values[c] = (float)((c + 1) * 100.0 * (1.0 + sin(phase + (double)c)) +
+                                (noise >> 16) % 100 / 100.0);
+        }
+        column_log_append(log, t0 + r * 10000, values);
+    }
+    if (column_log_close(log) != 0) {
+        unlink(MDF4_BENCH_LOG);
+        return -1;
+    }
+    
+    char template_path[PATH_MAX];
+    if (log_template_path(MDF4_BENCH_TEMPLATE, template_path, sizeof(template_path)) != 0) {
+        printf("MDF4 export: template %s not found, set %s\n", MDF4_BENCH_TEMPLATE,
+               LOG_TEMPLATE_DIR_ENV);
+        unlink(MDF4_BENCH_LOG);
+        return -1;
+    }
+    
+    double session_mb = rows * (sizeof(uint64_t) + count * sizeof(float)) / 1e6;
+    printf("MDF4 export: %zu rows x %zu channels, %.1f MB of samples\n", rows, count, session_mb);
+    
+    struct {
+        const char* label;
+        const char* path;
+        int compression;
+    } runs[] = {
+        { "CSV", MDF4_BENCH_CSV, -1 },
+        { "MDF4 DT", MDF4_BENCH_MF4, 0 },
+#ifdef HAVE_ZLIB
+        { "MDF4 DZ", MDF4_BENCH_MF4, MDF4_COMPRESS_DEFAULT },
+#endif
+    };
+    int status = 0;
+    for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]) && status == 0; i++) {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        status = runs[i].compression < 0 ? csv_export_log(MDF4_BENCH_LOG, runs[i].path, NULL) :
+                 mdf4_export_log(MDF4_BENCH_LOG, runs[i].path, template_path,
+                                 runs[i].compression);
+        double seconds = bench_seconds(&start);
+        printf("  %-13s %8.3f s  %8.1f MB/s  %10lld bytes\n", runs[i].label, seconds,
+               seconds > 0 ? session_mb / seconds : 0.0, bench_file_size(runs[i].path));
+        unlink(runs[i].path);
+    }
+    
+    unlink(MDF4_BENCH_LOG);
+    return status;
+}
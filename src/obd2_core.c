@@ -224,3 +224,29 @@ float calculate_o2_voltage(uint8_t raw_value) {
 float calculate_fuel_level(uint8_t raw_value) {
     return (raw_value * 100.0f) / 255.0f;
 }
+
+/* Number of data bytes returned for a Mode 01 PID, 0 if unknown */
+uint8_t obd2_pid_data_length(uint8_t pid) {
+    switch (pid) {
+        case 0x00: case 0x01: case 0x20: case 0x40: case 0x41:
+        case 0x4F: case 0x50: case 0x60:
+            return 4;
+        case 0x02: case 0x03: case 0x0C: case 0x10:
+        case 0x1F: case 0x21: case 0x22: case 0x23:
+        case 0x31: case 0x32: case 0x42: case 0x43:
+        case 0x44: case 0x4D: case 0x4E: case 0x53:
+        case 0x54: case 0x59: case 0x5D: case 0x5E:
+            return 2;
+        default:
+            break;
+    }
+    
+    if (pid >= 0x14 && pid <= 0x1B) return 2;   // O2 sensor voltage/trim
+    if (pid >= 0x24 && pid <= 0x2B) return 4;   // O2 sensor lambda/voltage
+    if (pid >= 0x34 && pid <= 0x3B) return 4;   // O2 sensor lambda/current
+    if (pid >= 0x3C && pid <= 0x3F) return 2;   // Catalyst temperatures
+    if (pid >= 0x55 && pid <= 0x58) return 2;   // Secondary O2 trims
+    if (pid <= 0x5F) return 1;
+    
+    return 0;
+}
@@ -1,7 +1,18 @@
 #include "performance_calc.h"
 #include "device_adapter.h"
+#include "log_sink.h"
+#include "column_log.h"
+#include "session_wal.h"
+#include "expr_engine.h"
+#include "stream_stats.h"
+#include "timebase.h"
+#include "csv_export.h"
+#include "session_replay.h"
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #define MAX_LOG_ENTRIES 10000
@@ -11,9 +22,26 @@
 static PerformanceData performance_log[MAX_LOG_ENTRIES];
 static size_t log_entry_count = 0;
 static uint32_t current_log_interval = 100; // Default 100ms
-static FILE* log_file = NULL;
+static LogSink* log_sink = NULL;
+static ColumnLog* log_columns = NULL;
+static char session_log_path[512];        // Last columnar session log, for export
+static LogSink* wal_sink = NULL;           // Group commit for session_wal
+static SessionWal* session_wal = NULL;
+static LogConfig log_config = {0};
 static uint8_t current_can_bus = 0;
 static float engine_displacement = DISPLACEMENT_LITERS;
+static OverlayConfig overlay_config = { .analysis_config = { .enable_statistics = true } };
+static StreamStats* channel_stats = NULL;
+static uint32_t stats_window_ms = STATS_DEFAULT_WINDOW_MS;
+static SafetyMonitor safety_config = {0};
+static SafetyRuleSet safety_rules;
+static bool safety_initialized = false;
+static bool channels_registered = false;
+static bool channels_dirty = false;
+static uint32_t channels_generation;      // expr_generation() when registered
+static SimulationConfig simulation_config;
+static char simulation_replay_file[512];  // Owned copy of replay_config.replay_file
+static bool simulation_initialized = false;
 
 // VE calculation using speed-density method
 static float calculate_ve(float maf, float rpm, float map, float iat) {
@@ -42,38 +70,95 @@ static float calculate_torque(float maf, float rpm, float spark_advance) {
     return (maf * air_fuel_ratio * torque_factor * timing_factor) / rpm;
 }
 
+/* Columnar log schema, in PERFORMANCE_STAT_* order */
+static const ColumnLogChannel performance_log_channels[PERFORMANCE_STAT_CHANNELS] = {
+    { "RPM", "rpm", COLUMN_TYPE_F32, {0} },
+    { "Speed", "mph", COLUMN_TYPE_F32, {0} },
+    { "VE", "%", COLUMN_TYPE_F32, {0} },
+    { "MAF", "g/s", COLUMN_TYPE_F32, {0} },
+    { "Torque", "Nm", COLUMN_TYPE_F32, {0} },
+    { "Boost", "psi", COLUMN_TYPE_F32, {0} },
+    { "AFR", "", COLUMN_TYPE_F32, {0} },
+    { "IAT", "C", COLUMN_TYPE_F32, {0} },
+    { "TPS", "%", COLUMN_TYPE_F32, {0} },
+    { "G-Force", "g", COLUMN_TYPE_F32, {0} }
+};
+
+/* Log row as queued for the log writer thread; also the columnar row layout */
+typedef struct {
+    uint64_t timestamp;        // Timebase microseconds
+    float values[PERFORMANCE_STAT_CHANNELS]; // Columns after Timestamp, in header order
+} PerformanceLogRecord;
+
+static size_t format_performance_record(const void* record, char* out, size_t size) {
+    const PerformanceLogRecord* r = record;
+    if (size < CSV_NUMBER_MAX * (PERFORMANCE_STAT_CHANNELS + 1) + 1) return 0;
+    
+    size_t length = csv_format_int(timebase_to_wall_us(r->timestamp), out);
+    for (size_t c = 0; c < PERFORMANCE_STAT_CHANNELS; c++) {
+        out[length++] = ',';
+        length += csv_format_float(r->values[c], CSV_DEFAULT_DECIMALS, out + length);
+    }
+    out[length++] = '\n';
+    return length;
+}
+
 static int start_logging_session(uint32_t interval_ms) {
     log_entry_count = 0;
     current_log_interval = interval_ms;
-    
-    if (log_file) {
-        fprintf(log_file, "Timestamp,RPM,Speed,VE,MAF,Torque,Boost,AFR,IAT,TPS,G-Force\n");
-    }
+    stream_stats_reset(channel_stats);
+    timebase_start_session(NULL);
     
     return 0;
 }
 
 static int log_performance_data(const PerformanceData* data) {
-    if (log_entry_count < MAX_LOG_ENTRIES) {
-        performance_log[log_entry_count++] = *data;
-        
-        if (log_file) {
-            fprintf(log_file, "%ld,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f,%0.2f\n",
-                    data->timestamp,
-                    data->engine_rpm,
-                    data->vehicle_speed,
-                    data->volumetric_efficiency,
-                    data->maf_scaled,
-                    data->torque_actual,
-                    data->boost_pressure,
-                    data->air_fuel_ratio,
-                    data->intake_air_temp,
-                    data->throttle_position,
-                    data->acceleration);
+    // Only the in-memory copy is capped; sinks, statistics and safety
+    // checks cover the whole session
+    PerformanceData overflow;
+    PerformanceData* entry = log_entry_count < MAX_LOG_ENTRIES ?
+                             &performance_log[log_entry_count++] : &overflow;
+    *entry = *data;
+    
+    if (safety_initialized && safety_config.safety_checks_enabled) {
+        int warnings = performance_check_safety_limits(data, entry->safety_status.warning_message);
+        entry->safety_status.warning_flags = safety_rules.flags;
+        entry->safety_status.in_safe_range = warnings == 0;
+    }
+    
+    PerformanceLogRecord record = {
+        .timestamp = data->timestamp_us,
+        .values = {
+            data->engine_rpm,
+            data->vehicle_speed,
+            data->volumetric_efficiency,
+            data->maf_scaled,
+            data->torque_actual,
+            data->boost_pressure,
+            data->air_fuel_ratio,
+            data->intake_air_temp,
+            data->throttle_position,
+            data->acceleration
         }
-        return 0;
+    };
+    
+    // Running statistics over the logged channels, O(1) per sample
+    if (overlay_config.analysis_config.enable_statistics) {
+        if (!channel_stats) {
+            channel_stats = stream_stats_create(PERFORMANCE_STAT_CHANNELS, stats_window_ms);
+        }
+        stream_stats_add(channel_stats, record.values, data->timestamp_us / 1000);
     }
-    return -1;
+    
+    if (log_sink) {
+        log_sink_append(log_sink, &record);
+    }
+    // The write-ahead copy is wall clock timed so it outlives this boot
+    if (wal_sink) {
+        record.timestamp = (uint64_t)timebase_to_wall_us(record.timestamp);
+        log_sink_append(wal_sink, &record);
+    }
+    return 0;
 }
 
 static PerformanceInterface perf_interface = {
@@ -93,12 +178,219 @@ PerformanceInterface* performance_get_interface(void) {
     return &perf_interface;
 }
 
+/* Write-ahead log for auto_save. The columnar log only reaches disk a
+ * chunk at a time; the WAL commits every auto_save.interval_ms, which
+ * bounds what a power cut can take. */
+#define PERFORMANCE_WAL_NAME        "performance"
+#define PERFORMANCE_WAL_INTERVAL_MS 1000
+
+typedef struct {
+    const char* directory;
+    ColumnLog* log;
+    int failed;                // A record could not be written out
+} WalRecoveryContext;
+
+static int recover_performance_record(void* context, uint64_t lsn, const void* payload,
+                                      size_t length) {
+    WalRecoveryContext* recovery = context;
+    PerformanceLogRecord record;
+    (void)lsn;
+    
+    if (length != sizeof(record)) return 0;
+    memcpy(&record, payload, sizeof(record));
+    
+    if (!recovery->log) {
+        char path[512];
+        time_t now = time(NULL);
+        struct tm t;
+        
+        localtime_r(&now, &t);
+        snprintf(path, sizeof(path), "%s/recovered_%04d%02d%02d_%02d%02d%02d.clog",
+                 recovery->directory, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
+                 t.tm_hour, t.tm_min, t.tm_sec);
+        recovery->log = column_log_create(path, performance_log_channels,
+                                          PERFORMANCE_STAT_CHANNELS, 0);
+        if (!recovery->log) {
+            recovery->failed = 1;
+            return -1;
+        }
+        
+        // Timestamps are already wall clock microseconds
+        TimebaseAnchor identity = { 0, 0 };
+        column_log_set_anchor(recovery->log, &identity);
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Recovering unfinished session into %s", path);
+    }
+    if (column_log_append(recovery->log, record.timestamp, record.values) != 0) {
+        recovery->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+static void close_session_wal(int clean) {
+    if (wal_sink) {
+        log_sink_close(wal_sink);
+        wal_sink = NULL;
+    }
+    if (session_wal) {
+        session_wal_close(session_wal, clean);
+        session_wal = NULL;
+    }
+}
+
+static int open_session_wal(void) {
+    const char* directory = log_config.auto_save.backup_dir[0] ?
+                            log_config.auto_save.backup_dir : ".";
+    
+    // Whatever a previous run left behind did not end cleanly
+    WalRecoveryContext recovery = { directory, NULL, 0 };
+    SessionWalRecovery result;
+    int recovered = session_wal_recover(directory, PERFORMANCE_WAL_NAME,
+                                        recover_performance_record, &recovery, &result);
+    if (recovered == 0 && result.records) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Recovered %llu logged samples, %llu damaged bytes dropped",
+                    (unsigned long long)result.records,
+                    (unsigned long long)result.truncated_bytes);
+    }
+    if (recovery.log && column_log_close(recovery.log) != 0) recovery.failed = 1;
+    
+    // New segments would number on after unrecovered ones and restart at
+    // LSN 1, and the next recovery would merge both sessions into one log.
+    // Keep the old session intact and run this one without a WAL.
+    if (recovered != 0 || recovery.failed) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Unrecovered session left in %s, not starting a new WAL",
+                    directory);
+        return -1;
+    }
+    session_wal_remove(directory, PERFORMANCE_WAL_NAME);
+    
+    SessionWalConfig wal_config = {
+        .directory = directory,
+        .name = PERFORMANCE_WAL_NAME,
+        .record_size = sizeof(PerformanceLogRecord)
+    };
+    session_wal = session_wal_open(&wal_config);
+    if (!session_wal) return -1;
+    
+    LogSinkConfig sink_config = {
+        .record_size = sizeof(PerformanceLogRecord),
+        .capacity = log_config.buffer_config.buffer_size,
+        .fsync_interval_ms = log_config.auto_save.interval_ms ?
+                             log_config.auto_save.interval_ms : PERFORMANCE_WAL_INTERVAL_MS,
+        .consume = session_wal_consume,
+        .consume_context = session_wal
+    };
+    wal_sink = log_sink_open(&sink_config);
+    if (!wal_sink) {
+        close_session_wal(0);
+        return -1;
+    }
+    return 0;
+}
+
+/* Logging goes through an async sink so file I/O never stalls the caller.
+ * Queue size and fsync interval come from performance_configure_logging.
+ * The file is columnar unless log_path ends in .csv. */
 int performance_init_logging(const char* log_path) {
-    if (log_path) {
-        log_file = fopen(log_path, "w");
-        return log_file ? 0 : -1;
+    if (!log_path) return -1;
+    
+    if (log_sink) {
+        log_sink_close(log_sink);
+        log_sink = NULL;
     }
-    return -1;
+    if (log_columns) {
+        column_log_close(log_columns);
+        log_columns = NULL;
+    }
+    close_session_wal(1);
+    
+    LogSinkConfig sink_config = {
+        .record_size = sizeof(PerformanceLogRecord),
+        .capacity = log_config.buffer_config.buffer_size,
+        .fsync_interval_ms = log_config.buffer_config.flush_interval
+    };
+    if (column_log_is_csv_path(log_path)) {
+        sink_config.path = log_path;
+        sink_config.format = format_performance_record;
+        sink_config.header = "Timestamp,RPM,Speed,VE,MAF,Torque,Boost,AFR,IAT,TPS,G-Force\n";
+    } else {
+        log_columns = column_log_create(log_path, performance_log_channels,
+                                        PERFORMANCE_STAT_CHANNELS, 0);
+        if (!log_columns) return -1;
+        snprintf(session_log_path, sizeof(session_log_path), "%s", log_path);
+        column_log_set_compression(log_columns, log_config.compress_logs);
+        sink_config.consume = column_log_consume;
+        sink_config.consume_context = log_columns;
+    }
+    
+    log_sink = log_sink_open(&sink_config);
+    if (!log_sink && log_columns) {
+        column_log_close(log_columns);
+        log_columns = NULL;
+    }
+    if (!log_sink) return -1;
+    
+    if (log_config.auto_save.enabled && open_session_wal() != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Auto-save unavailable, logging without a WAL");
+    }
+    return 0;
+}
+
+/* CSV copy of a finished columnar log: same name with .csv, in
+ * csv_directory when one is set */
+static int auto_export_session(void) {
+    const char* name = strrchr(session_log_path, '/');
+    name = name ? name + 1 : session_log_path;
+    const char* extension = strrchr(name, '.');
+    int stem = extension ? (int)(extension - name) : (int)strlen(name);
+    char path[768];
+    
+    if (log_config.csv_directory[0]) {
+        snprintf(path, sizeof(path), "%s/%.*s.csv", log_config.csv_directory, stem, name);
+    } else {
+        snprintf(path, sizeof(path), "%.*s.csv", (int)(name - session_log_path) + stem,
+                 session_log_path);
+    }
+    return performance_export_to_csv(session_log_path, path);
+}
+
+/* Completes the log file, then drops the WAL it no longer needs */
+int performance_close_logging(void) {
+    int status = 0;
+    int columnar = log_columns != NULL;
+    
+    if (log_sink && log_sink_close(log_sink) != 0) status = -1;
+    log_sink = NULL;
+    if (log_columns && column_log_close(log_columns) != 0) status = -1;
+    log_columns = NULL;
+    close_session_wal(status == 0);
+    
+    if (status == 0 && columnar && log_config.auto_export_csv && auto_export_session() != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Session log kept, CSV export failed");
+    }
+    return status;
+}
+
+/* session_id is the path of a columnar session log; NULL or empty means
+ * the last one performance_init_logging opened. A log still being
+ * written exports up to its last complete chunk. */
+int performance_export_to_csv(const char* session_id, const char* filepath) {
+    const char* input = session_id && session_id[0] ? session_id : session_log_path;
+    if (!input[0] || !filepath) return -1;
+    
+    CsvExportOptions options = { .decimals = CSV_DEFAULT_DECIMALS };
+    return csv_export_log(input, filepath, &options);
+}
+
+int performance_configure_logging(const LogConfig* config) {
+    if (!config) return -1;
+    
+    log_config = *config;
+    return 0;
+}
+
+int performance_get_log_stats(LogSinkStats* stats) {
+    return log_sink_get_stats(log_sink, stats);
 }
 
 int performance_set_log_interval(uint32_t interval_ms) {
@@ -108,3 +400,347 @@ int performance_set_log_interval(uint32_t interval_ms) {
     }
     return -1;
 }
+
+/* Channel math: live inputs plus derived channels evaluated by the
+ * expression engine. Custom parameters may reference any channel by name
+ * and their own PID as x. The monitor feeds every sample in through
+ * performance_update_channels, so the engine is shared with its thread. */
+static const struct {
+    const char* name;
+    int16_t pid;               // Mode 01 PID the monitor supplies it from, -1 if none
+} base_inputs[] = {
+    { "rpm", 0x0C }, { "speed", 0x0D }, { "maf", 0x10 }, { "map", 0x0B }, { "baro", 0x33 },
+    { "iat", 0x0F }, { "tps", 0x11 }, { "afr", -1 }, { "coolant", 0x05 }, { "oil_pressure", -1 }
+};
+
+static pthread_mutex_t channels_lock = PTHREAD_MUTEX_INITIALIZER;
+static int16_t channel_pids[EXPR_MAX_CHANNELS];     // Source PID of each channel, -1 if none
+static float channel_values[EXPR_MAX_CHANNELS];     // Latest sample, NaN until fed
+
+static int register_base_channels(void) {
+    if (channels_registered && channels_generation == expr_generation()) return 0;
+    if (channels_registered) {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "Expression engine was reset, custom parameters dropped");
+    }
+    
+    expr_reset();
+    channels_generation = expr_generation();
+    for (size_t i = 0; i < sizeof(base_inputs) / sizeof(base_inputs[0]); i++) {
+        if (expr_add_input(base_inputs[i].name) < 0) return -1;
+    }
+    // kPa to PSI
+    if (expr_add_channel("boost", "(map - baro) * 0.145038", -1) < 0) return -1;
+    
+    channels_registered = true;
+    channels_dirty = true;
+    return 0;
+}
+
+/* Inputs are fed by PID: the base inputs' standard PIDs, pid_XX for
+ * custom parameters */
+static void map_channel_pids(void) {
+    for (size_t c = 0; c < expr_channel_count(); c++) {
+        const char* name = expr_channel_name(c);
+        channel_pids[c] = -1;
+        channel_values[c] = NAN;
+        if (strncmp(name, "pid_", 4) == 0) {
+            channel_pids[c] = (int16_t)strtol(name + 4, NULL, 16);
+            continue;
+        }
+        for (size_t i = 0; i < sizeof(base_inputs) / sizeof(base_inputs[0]); i++) {
+            if (strcmp(name, base_inputs[i].name) == 0) channel_pids[c] = base_inputs[i].pid;
+        }
+    }
+}
+
+static int compile_channels(void) {
+    if (register_base_channels() != 0) return -1;
+    
+    if (channels_dirty) {
+        if (expr_compile() != 0) return -1;
+        map_channel_pids();
+        channels_dirty = false;
+    }
+    return 0;
+}
+
+static int add_custom_parameter(const CustomParameter* param) {
+    char source_name[EXPR_MAX_NAME];
+    char formula[EXPR_MAX_FORMULA];
+    int source = -1;
+    
+    if (register_base_channels() != 0) return -1;
+    
+    if (param->pid_code) {
+        snprintf(source_name, sizeof(source_name), "pid_%02X", (unsigned)param->pid_code);
+        source = expr_channel_index(source_name);
+        if (source < 0) source = expr_add_input(source_name);
+        if (source < 0) return -1;
+    }
+    
+    if (param->conversion.formula[0]) {
+        snprintf(formula, sizeof(formula), "%s", param->conversion.formula);
+    } else if (source >= 0) {
+        float scale = param->conversion.scale_factor != 0.0f ? param->conversion.scale_factor : 1.0f;
+        snprintf(formula, sizeof(formula), "x * %.9g + %.9g", scale, param->conversion.offset);
+    } else {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Custom parameter %s has no PID or formula", param->name);
+        return -1;
+    }
+    
+    if (expr_add_channel(param->name, formula, source) < 0) return -1;
+    channels_dirty = true;
+    return 0;
+}
+
+int performance_add_custom_parameter(CustomParameter* param) {
+    if (!param || !param->name[0]) return -1;
+    pthread_mutex_lock(&channels_lock);
+    int status = add_custom_parameter(param);
+    pthread_mutex_unlock(&channels_lock);
+    return status;
+}
+
+int performance_get_channel_index(const char* name) {
+    if (!name) return -1;
+    pthread_mutex_lock(&channels_lock);
+    int index = register_base_channels() == 0 ? expr_channel_index(name) : -1;
+    pthread_mutex_unlock(&channels_lock);
+    return index;
+}
+
+size_t performance_get_channel_count(void) {
+    pthread_mutex_lock(&channels_lock);
+    size_t count = register_base_channels() == 0 ? expr_channel_count() : 0;
+    pthread_mutex_unlock(&channels_lock);
+    return count;
+}
+
+/* Formulas are compiled on the first evaluation after a change, so
+ * parameters may reference channels added after them */
+int performance_evaluate_channels(float* const* columns, size_t count) {
+    pthread_mutex_lock(&channels_lock);
+    int status = compile_channels() == 0 ? expr_evaluate_block(columns, count) : -1;
+    pthread_mutex_unlock(&channels_lock);
+    return status;
+}
+
+/* One monitor sample: inputs whose PID is not in it read NaN */
+int performance_update_channels(const uint8_t* pids, const float* values, size_t count) {
+    static float* columns[EXPR_MAX_CHANNELS];
+    
+    if (!pids || !values) return -1;
+    pthread_mutex_lock(&channels_lock);
+    int status = compile_channels();
+    for (size_t c = 0; status == 0 && c < expr_channel_count(); c++) {
+        columns[c] = &channel_values[c];
+        if (channel_pids[c] < 0) continue;
+        channel_values[c] = NAN;
+        for (size_t i = 0; i < count; i++) {
+            if (pids[i] == channel_pids[c]) channel_values[c] = values[i];
+        }
+    }
+    if (status == 0) status = expr_evaluate_block(columns, 1);
+    pthread_mutex_unlock(&channels_lock);
+    return status;
+}
+
+int performance_get_channel_value(size_t channel, float* value) {
+    if (!value) return -1;
+    pthread_mutex_lock(&channels_lock);
+    int status = channel < expr_channel_count() && !channels_dirty ? 0 : -1;
+    if (status == 0) *value = channel_values[channel];
+    pthread_mutex_unlock(&channels_lock);
+    return status;
+}
+
+/* Safety limits
+ *
+ * The SafetyMonitor limits become hysteresis rules over a small value
+ * vector built from each PerformanceData sample. */
+enum {
+    SAFETY_CH_RPM,
+    SAFETY_CH_BOOST,
+    SAFETY_CH_EGT,
+    SAFETY_CH_COOLANT,
+    SAFETY_CH_OIL_PRESSURE,
+    SAFETY_CHANNELS
+};
+
+static int add_limit_rule(const char* name, uint8_t channel, SafetyDirection direction,
+                          float limit, uint32_t flag) {
+    SafetyRule rule = {0};
+    
+    snprintf(rule.name, sizeof(rule.name), "%s", name);
+    rule.channel = channel;
+    rule.direction = direction;
+    rule.trip = limit;
+    rule.clear = direction == SAFETY_ABOVE ? limit * (1.0f - SAFETY_HYSTERESIS) :
+                                             limit * (1.0f + SAFETY_HYSTERESIS);
+    rule.debounce = 2;  // One noisy sample is not a warning
+    rule.flag = flag;
+    return safety_rules_add(&safety_rules, &rule) < 0 ? -1 : 0;
+}
+
+int performance_init_safety_monitor(SafetyMonitor* config) {
+    if (!config) return -1;
+    
+    safety_config = *config;
+    if (safety_config.rpm_limit <= 0) safety_config.rpm_limit = MAX_SAFE_RPM;
+    if (safety_config.boost_limit <= 0) safety_config.boost_limit = MAX_SAFE_BOOST;
+    if (safety_config.egt_limit <= 0) safety_config.egt_limit = MAX_SAFE_EGT;
+    if (safety_config.coolant_temp_limit <= 0) safety_config.coolant_temp_limit = MAX_SAFE_COOLANT_TEMP;
+    if (safety_config.min_oil_pressure <= 0) safety_config.min_oil_pressure = MIN_SAFE_OIL_PRESSURE;
+    
+    safety_rules_init(&safety_rules);
+    if (add_limit_rule("RPM", SAFETY_CH_RPM, SAFETY_ABOVE,
+                       safety_config.rpm_limit, SAFETY_FLAG_RPM) != 0 ||
+        add_limit_rule("Boost", SAFETY_CH_BOOST, SAFETY_ABOVE,
+                       safety_config.boost_limit, SAFETY_FLAG_BOOST) != 0 ||
+        add_limit_rule("EGT", SAFETY_CH_EGT, SAFETY_ABOVE,
+                       safety_config.egt_limit, SAFETY_FLAG_EGT) != 0 ||
+        add_limit_rule("Coolant", SAFETY_CH_COOLANT, SAFETY_ABOVE,
+                       safety_config.coolant_temp_limit, SAFETY_FLAG_COOLANT) != 0 ||
+        add_limit_rule("Oil pressure", SAFETY_CH_OIL_PRESSURE, SAFETY_BELOW,
+                       safety_config.min_oil_pressure, SAFETY_FLAG_OIL_PRESSURE) != 0) {
+        safety_initialized = false;
+        return -1;
+    }
+    
+    safety_initialized = true;
+    return 0;
+}
+
+/* Extra rules over the same channels, e.g. with a callback attached */
+int performance_add_safety_rule(const SafetyRule* rule) {
+    if (!rule || rule->channel >= SAFETY_CHANNELS || !safety_initialized) return -1;
+    return safety_rules_add(&safety_rules, rule) < 0 ? -1 : 0;
+}
+
+/* Returns the number of active warnings and names them in warning_msg,
+ * which must hold 256 bytes like safety_status.warning_message */
+int performance_check_safety_limits(const PerformanceData* data, char* warning_msg) {
+    float values[SAFETY_CHANNELS];
+    
+    if (!data) return -1;
+    if (!safety_initialized) {
+        SafetyMonitor defaults = { .safety_checks_enabled = true };
+        if (performance_init_safety_monitor(&defaults) != 0) return -1;
+    }
+    
+    float egt = data->exhaust_temp;
+    for (size_t i = 0; i < 8; i++) {
+        if (data->sensor_data.egt[i] > egt) egt = data->sensor_data.egt[i];
+    }
+    
+    // A zero oil pressure reading means the sensor isn't fitted
+    values[SAFETY_CH_RPM] = data->engine_rpm;
+    values[SAFETY_CH_BOOST] = data->boost_pressure;
+    values[SAFETY_CH_EGT] = egt;
+    values[SAFETY_CH_COOLANT] = data->coolant_temp;
+    values[SAFETY_CH_OIL_PRESSURE] = data->oil_pressure > 0 ? data->oil_pressure : NAN;
+    
+    safety_rules_evaluate(&safety_rules, values, data->timestamp_us);
+    
+    int active = 0;
+    for (size_t i = 0; i < safety_rules.count; i++) active += safety_rules.active[i];
+    
+    if (warning_msg) {
+        if (active) {
+            safety_rules_describe(&safety_rules, warning_msg, 256);
+        } else {
+            warning_msg[0] = '\0';
+        }
+    }
+    return active;
+}
+
+/* Statistics over the logged channels (PERFORMANCE_STAT_*) */
+int performance_set_overlay_config(OverlayConfig* config) {
+    if (!config) return -1;
+    
+    overlay_config = *config;
+    if (!config->analysis_config.enable_statistics && channel_stats) {
+        stream_stats_destroy(channel_stats);
+        channel_stats = NULL;
+    }
+    return 0;
+}
+
+/* Length of the recent window; takes effect on the next session */
+int performance_set_stats_window(uint32_t window_ms) {
+    if (window_ms < STATS_WINDOW_PANES) return -1;
+    
+    stats_window_ms = window_ms;
+    stream_stats_destroy(channel_stats);
+    channel_stats = NULL;
+    return 0;
+}
+
+int performance_new_lap(void) {
+    return stream_stats_new_lap(channel_stats);
+}
+
+int performance_get_channel_stats(size_t channel, StatsWindow window, ChannelStats* stats) {
+    if (!channel_stats) return -1;
+    return stream_stats_get(channel_stats, channel, window, stats);
+}
+
+/* Peak, average and variance of each logged channel over a window */
+int performance_get_analysis(StatsWindow window, AnalysisResults* results) {
+    if (!results || !channel_stats) return -1;
+    
+    for (size_t c = 0; c < PERFORMANCE_STAT_CHANNELS; c++) {
+        ChannelStats stats;
+        if (stream_stats_get(channel_stats, c, window, &stats) != 0) return -1;
+        
+        results->channel_data.peak_values[c] = stats.max;
+        results->channel_data.average_values[c] = stats.mean;
+        results->channel_data.variance_values[c] = stats.variance;
+    }
+    return 0;
+}
+
+/* Simulation: the simulator device, or a recorded session replayed
+ * through the replay device */
+int performance_init_simulation(SimulationConfig* config) {
+    if (!config) return -1;
+    
+    simulation_config = *config;
+    simulation_config.simulation_file = NULL;
+    simulation_config.replay_config.replay_file = NULL;
+    snprintf(simulation_replay_file, sizeof(simulation_replay_file), "%s",
+             config->replay_config.replay_file ? config->replay_config.replay_file : "");
+    simulation_initialized = true;
+    return 0;
+}
+
+int performance_start_simulation(void) {
+    if (!simulation_initialized) return -1;
+    
+    DeviceConfig device = {0};
+    if (simulation_config.replay_config.replay_mode) {
+        // Speed 0 replays as fast as the pipeline runs
+        SessionReplayOptions options = { .speed = simulation_config.replay_config.replay_speed };
+        if (session_replay_open(simulation_replay_file, &options) != 0) return -1;
+        device.type = DEVICE_REPLAY;
+    } else if (simulation_config.simulation_enabled) {
+        device.type = DEVICE_SIMULATOR;
+        device.conn_type = CONN_DEMO;
+        device.device_config.demo.enable_realistic_noise =
+            simulation_config.simulation_params.add_sensor_noise;
+    } else {
+        return -1;
+    }
+    
+    if (device_init(&device) != 0) {
+        session_replay_close();
+        return -1;
+    }
+    return 0;
+}
+
+int performance_stop_simulation(void) {
+    session_replay_close();
+    return 0;
+}
@@ -1,22 +1,14 @@
 #include "obd2_core.h"
 #include "j2534_interface.h"
+#include <string.h>
 
 /* CAN Protocol Constants */
 #define CAN_STD_ID_MASK    0x7FF
 #define CAN_EXT_ID_MASK    0x1FFFFFFF
 #define CAN_MAX_DLC        8
 
-/* CAN Frame Types */
-typedef struct {
-    uint32_t id;
-    uint8_t dlc;
-    uint8_t data[CAN_MAX_DLC];
-    uint8_t is_extended;
-    uint8_t is_remote;
-} CANFrame;
-
 /* CAN Protocol Implementation */
-static int can_init(uint32_t baudrate, uint8_t extended_id) {
+int can_init(uint32_t baudrate, uint8_t extended_id) {
     uint32_t flags = extended_id ? J2534_CAN_29BIT_ID : 0;
     
     DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing CAN protocol: %s ID, %d baud",
@@ -144,3 +136,75 @@ int can_iso_tp_send(uint32_t id, const uint8_t* data, size_t length) {
     
     return 0;
 }
+
+/* Receive an ISO-TP message, sending flow control to fc_id for multi-frame replies */
+int can_iso_tp_receive(uint32_t fc_id, uint8_t* data, size_t* length, uint32_t timeout_ms) {
+    if (!data || !length) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "NULL ISO-TP receive buffer");
+        return -1;
+    }
+    
+    CANFrame frame;
+    if (can_receive_frame(&frame, timeout_ms) != 0) {
+        return -1;
+    }
+    
+    uint8_t pci = frame.data[0] >> 4;
+    if (pci == 0x0) {
+        /* Single frame */
+        size_t size = frame.data[0] & 0x0F;
+        if (size > 7 || size > *length) {
+            return -1;
+        }
+        memcpy(data, &frame.data[1], size);
+        *length = size;
+        return 0;
+    }
+    
+    if (pci != 0x1) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Unexpected ISO-TP frame type %X", pci);
+        return -1;
+    }
+    
+    /* First frame */
+    size_t total = ((size_t)(frame.data[0] & 0x0F) << 8) | frame.data[1];
+    if (total > *length || total < 6) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "ISO-TP message too long: %zu bytes", total);
+        return -1;
+    }
+    memcpy(data, &frame.data[2], 6);
+    size_t received = 6;
+    
+    /* Flow control: continue to send, no block limit, no separation time */
+    CANFrame flow = {
+        .id = fc_id,
+        .dlc = 8,
+        .data = {0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+        .is_extended = (fc_id > CAN_STD_ID_MASK) ? 1 : 0,
+        .is_remote = 0
+    };
+    if (can_send_frame(&flow) != 0) {
+        return -1;
+    }
+    
+    /* Consecutive frames */
+    uint8_t sequence = 1;
+    while (received < total) {
+        if (can_receive_frame(&frame, timeout_ms) != 0) {
+            return -1;
+        }
+        
+        if ((frame.data[0] >> 4) != 0x2 || (frame.data[0] & 0x0F) != sequence) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "ISO-TP sequence error");
+            return -1;
+        }
+        
+        size_t block_size = (total - received) > 7 ? 7 : (total - received);
+        memcpy(&data[received], &frame.data[1], block_size);
+        received += block_size;
+        sequence = (sequence + 1) & 0x0F;
+    }
+    
+    *length = total;
+    return 0;
+}
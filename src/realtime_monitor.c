@@ -1,60 +1,478 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np, CPU_SET
 #include "realtime_monitor.h"
+#include "log_sink.h"
+#include "column_log.h"
+#include "timebase.h"
+#include "log_template.h"
+#include "csv_export.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <math.h>
+
+#define NSEC_PER_SEC 1000000000LL
+#define MONITOR_LOG_DECIMALS 6  // CSV value digits, as "%f" wrote them
+
+static float process_pid_data(uint8_t pid, const uint8_t* data, size_t length);
+static int monitor_collect_data(uint64_t tick);
+static size_t format_log_event(const void* record, char* out, size_t size);
+static int monitor_load_channels(void);
+static ColumnLog* monitor_create_column_log(const char* path, uint32_t chunk_rows);
+static void format_dtc(const uint8_t* data, char* dtc);
+static void monitor_watch_dtc(const struct timespec* deadline);
+static void monitor_check_triggers(const MonitorSample* sample, const float* values);
+static void* capture_thread(void* arg);
+
+/* Seqlocked slots. seq is 2*index+1 while entry index is being written and
+ * 2*index+2 once it is complete, so a reader can tell both a torn read and
+ * a slot that the writer has since lapped. */
+typedef struct {
+    atomic_uint_fast64_t seq;
+    MonitorSample sample;
+} HistorySlot;
+
+typedef struct {
+    atomic_uint_fast64_t seq;
+    MonitorEvent event;
+} EventSlot;
+
+/* Columnar log row: one per tick, NaN where a channel was not logged */
+typedef struct {
+    uint64_t timestamp;
+    float values[32];
+} MonitorLogRow;
 
 /* Monitor state */
 static struct {
     MonitorConfig config;
-    MonitorSample* history;
-    size_t history_size;
-    size_t history_head;
-    FILE* log_file;
+    HistorySlot* history;      // Single writer (sampler), lock-free readers
+    atomic_uint_fast64_t published;  // Samples published since init
+    atomic_uint_fast64_t base;       // First index visible after a clear
+    EventSlot* events;         // Sparse event stream, same scheme as history
+    size_t event_capacity;
+    atomic_uint_fast64_t events_published;
+    EventSlot channels[32];    // Last-value cache, index = update count
+    MonitorEvent last[32];     // Sampler's private copy of the cache
+    LogSink* log;              // Written by its own thread, never blocks sampling
+    ColumnLog* columns;        // Columnar file behind the log sink, NULL for CSV
+    ColumnLogChannel log_channels[32]; // Name and unit of each channel in logs
+    volatile uint8_t running;
+    DeviceInterface* device;
+    pthread_t thread;
+    pthread_mutex_t lock;      // Guards stats against the sampler
+    MonitorStats stats;
+    uint32_t tick_ms;          // GCD of all channel periods
+    uint64_t period_ticks[32]; // Channel period in ticks
+    uint64_t next_tick[32];    // Tick at which each channel is next due
+    PIDQuery queries[32];      // One query per channel, built once from config
+    PIDQuery due_queries[32];  // Channels due in the current tick
+    PIDResult results[32];
+    uint8_t due_channels[32];
+    SafetyRuleSet safety;      // Owned by the sampler while running
+    uint32_t safety_ns;        // Rule evaluation time of the last tick
+    uint16_t dtcs[3][MONITOR_MAX_DTCS]; // Last code set per watched mode, under lock
+    size_t dtc_count[3];
+    MonitorDTCEvent dtc_events[MONITOR_DTC_EVENTS]; // Ring, under lock
+    uint64_t dtc_events_published;
+    struct timespec dtc_next;  // When the next background poll is due
+    size_t dtc_mode;           // Mode polled next, index into dtc_modes
+    int64_t dtc_cost_ns;       // Moving average of a DTC read
+    uint64_t logged_at[32];    // Timestamp of each channel's last logged row
+    MonitorTrigger triggers[MONITOR_MAX_TRIGGERS];
+    size_t trigger_count;
+    SafetyRuleSet trigger_rules; // Trigger conditions, flag bit = trigger index
+    uint32_t trigger_flags;    // Conditions active after the last tick
+    uint32_t warning_flags;    // Safety flags after the last tick
+    atomic_uint fire_requests; // Manual fires, bit = trigger index
+} monitor_state = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* Capture writer. The sampler only claims a slot when a trigger fires;
+ * the capture thread copies the window out of the event ring and does all
+ * file I/O. */
+typedef struct {
+    uint8_t active;
+    size_t trigger;
+    uint64_t fired_at;         // Timestamp of the sample that fired
+    uint64_t cursor;           // Next event to copy, 0 = not started
+    FILE* file;                // CSV capture
+    ColumnLog* columns;        // Columnar capture
+    MonitorLogRow row;         // Row being assembled from events
+    uint32_t row_channels;     // Channels already in row
+} CaptureSlot;
+
+static struct {
+    CaptureSlot slots[MONITOR_MAX_CAPTURES];
+    pthread_t thread;
+    pthread_mutex_t lock;      // Guards slots between sampler and writer
+    pthread_cond_t wake;
     uint8_t running;
-} monitor_state = {0};
+} capture_state = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER };
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
 
 /* Initialize monitoring */
 int monitor_init(const MonitorConfig* config) {
     if (!config) return -1;
     
-    // Copy configuration
+    if (config->pid_count > 32 || config->buffer_size == 0 || config->sample_rate_ms == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Invalid monitor configuration");
+        return -1;
+    }
+    
+    monitor_state.device = device_get_active();
+    if (!monitor_state.device) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "No active device for monitoring");
+        return -1;
+    }
+    
+    // Copy configuration, taking the channel list from the template if one is set
     monitor_state.config = *config;
+    if (monitor_load_channels() != 0) return -1;
+    config = &monitor_state.config;
+    
+    // Build the channel queries and a tick that lands on every channel period
+    monitor_state.tick_ms = config->pid_count ? 0 : config->sample_rate_ms;
+    for (size_t i = 0; i < config->pid_count; i++) {
+        uint32_t period = config->pid_rate_ms[i] ? config->pid_rate_ms[i] : config->sample_rate_ms;
+        monitor_state.tick_ms = gcd_u32(monitor_state.tick_ms, period);
+        monitor_state.queries[i].mode = OBD_MODE_SHOW_CURRENT_DATA;
+        monitor_state.queries[i].pid = config->pids[i];
+        monitor_state.queries[i].length = 0;
+    }
+    for (size_t i = 0; i < config->pid_count; i++) {
+        uint32_t period = config->pid_rate_ms[i] ? config->pid_rate_ms[i] : config->sample_rate_ms;
+        monitor_state.period_ticks[i] = period / monitor_state.tick_ms;
+        monitor_state.next_tick[i] = 0;
+        atomic_init(&monitor_state.channels[i].seq, 0);
+        memset(&monitor_state.last[i], 0, sizeof(MonitorEvent));
+        monitor_state.last[i].channel = (uint8_t)i;
+    }
     
-    // Allocate history buffer
-    monitor_state.history = malloc(sizeof(MonitorSample) * config->buffer_size);
-    if (!monitor_state.history) {
+    // Allocate history and event buffers
+    free(monitor_state.history);
+    free(monitor_state.events);
+    monitor_state.event_capacity = config->event_buffer_size ? config->event_buffer_size :
+                                   config->buffer_size * (config->pid_count ? config->pid_count : 1);
+    monitor_state.history = calloc(config->buffer_size, sizeof(HistorySlot));
+    monitor_state.events = calloc(monitor_state.event_capacity, sizeof(EventSlot));
+    atomic_init(&monitor_state.published, 0);
+    atomic_init(&monitor_state.base, 0);
+    atomic_init(&monitor_state.events_published, 0);
+    if (!monitor_state.history || !monitor_state.events) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to allocate monitor history");
+        free(monitor_state.history);
+        free(monitor_state.events);
+        monitor_state.history = NULL;
+        monitor_state.events = NULL;
         return -1;
     }
     
     // Open log file if needed
+    if (monitor_state.log) {
+        log_sink_close(monitor_state.log);
+        monitor_state.log = NULL;
+    }
+    if (monitor_state.columns) {
+        column_log_close(monitor_state.columns);
+        monitor_state.columns = NULL;
+    }
     if (config->log_to_file) {
-        monitor_state.log_file = fopen(config->log_file, "w");
-        if (!monitor_state.log_file) {
+        LogSinkConfig log_config = {
+            .capacity = monitor_state.event_capacity,
+            .fsync_interval_ms = config->log_fsync_ms
+        };
+        
+        if (column_log_is_csv_path(config->log_file)) {
+            // Sparse text log: one row per sampled PID
+            log_config.path = config->log_file;
+            log_config.record_size = sizeof(MonitorEvent);
+            log_config.format = format_log_event;
+            log_config.header = "Timestamp,PID,Value\n";
+        } else {
+            // One column per PID, one row per tick
+            monitor_state.columns = monitor_create_column_log(config->log_file, 0);
+            log_config.record_size = COLUMN_LOG_ROW_SIZE(config->pid_count);
+            log_config.consume = column_log_consume;
+            log_config.consume_context = monitor_state.columns;
+        }
+        
+        monitor_state.log = monitor_state.columns || !log_config.consume ?
+                            log_sink_open(&log_config) : NULL;
+        if (!monitor_state.log) {
+            if (monitor_state.columns) {
+                column_log_close(monitor_state.columns);
+                monitor_state.columns = NULL;
+            }
             DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open monitor log file");
             free(monitor_state.history);
+            free(monitor_state.events);
+            monitor_state.history = NULL;
+            monitor_state.events = NULL;
             return -1;
         }
+    }
+    
+    return 0;
+}
+
+/* Units of the PIDs process_pid_data scales */
+static const char* pid_unit(uint8_t pid) {
+    switch (pid) {
+        case 0x04: return "%";
+        case 0x05: return "C";
+        case 0x0C: return "rpm";
+        case 0x0D: return "km/h";
+        case 0x0F: return "C";
+        case 0x11: return "%";
+        default:   return "";
+    }
+}
+
+/* Channel names and units for logs. With a template the PIDs and their
+ * periods come from its OBD-mapped channels, in template order. */
+static int monitor_load_channels(void) {
+    MonitorConfig* config = &monitor_state.config;
+    LogTemplate* tmpl = NULL;
+    
+    memset(monitor_state.log_channels, 0, sizeof(monitor_state.log_channels));
+    if (config->channel_template[0]) {
+        tmpl = log_template_load(config->channel_template);
+        if (!tmpl) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to load channel template %s",
+                        config->channel_template);
+            return -1;
+        }
+        config->pid_count = log_template_pids(tmpl, config->pids, config->pid_rate_ms, 32);
+    }
+    
+    size_t next = 0;
+    for (size_t i = 0; i < config->pid_count; i++) {
+        ColumnLogChannel* channel = &monitor_state.log_channels[i];
+        channel->type = COLUMN_TYPE_F32;
         
-        // Write header
-        fprintf(monitor_state.log_file, "Timestamp");
-        for (size_t i = 0; i < config->pid_count; i++) {
-            fprintf(monitor_state.log_file, ",PID_%02X", config->pids[i]);
+        // log_template_pids keeps template order, so the i-th PID channel matches
+        while (tmpl && next < tmpl->channel_count && tmpl->channels[next].pid == CHANNEL_NO_PID) next++;
+        if (tmpl && next < tmpl->channel_count) {
+            const ChannelDescriptor* source = &tmpl->channels[next++];
+            snprintf(channel->name, sizeof(channel->name), "%s", source->name);
+            snprintf(channel->unit, sizeof(channel->unit), "%s", source->unit);
+        } else {
+            snprintf(channel->name, sizeof(channel->name), "PID_%02X", config->pids[i]);
+            snprintf(channel->unit, sizeof(channel->unit), "%s", pid_unit(config->pids[i]));
         }
-        fprintf(monitor_state.log_file, "\n");
     }
     
+    if (tmpl) {
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Monitoring %zu channels from %s",
+                    config->pid_count, config->channel_template);
+        log_template_free(tmpl);
+    }
     return 0;
 }
 
+static ColumnLog* monitor_create_column_log(const char* path, uint32_t chunk_rows) {
+    ColumnLog* log = column_log_create(path, monitor_state.log_channels,
+                                       monitor_state.config.pid_count, chunk_rows);
+    if (log) column_log_set_compression(log, monitor_state.config.compress_log);
+    return log;
+}
+
+/* Monitor log row, formatted on the log writer thread */
+static size_t format_log_event(const void* record, char* out, size_t size) {
+    const MonitorEvent* event = record;
+    const char* name = monitor_state.log_channels[event->channel].name;
+    size_t name_length = strlen(name);
+    if (size < 2 * CSV_NUMBER_MAX + name_length + 3) return 0;
+    
+    size_t length = csv_format_int(timebase_to_wall_us(event->timestamp), out);
+    out[length++] = ',';
+    memcpy(out + length, name, name_length);
+    length += name_length;
+    out[length++] = ',';
+    if (event->status == MONITOR_STATUS_FRESH) {
+        length += csv_format_float(event->value, MONITOR_LOG_DECIMALS, out + length);
+    }
+    out[length++] = '\n';
+    return length;
+}
+
+/* Sampling thread */
+static int64_t timespec_diff_ns(const struct timespec* a, const struct timespec* b) {
+    return (int64_t)(a->tv_sec - b->tv_sec) * NSEC_PER_SEC + (a->tv_nsec - b->tv_nsec);
+}
+
+static void timespec_add_ns(struct timespec* ts, int64_t ns) {
+    ts->tv_sec += ns / NSEC_PER_SEC;
+    ts->tv_nsec += ns % NSEC_PER_SEC;
+    if (ts->tv_nsec >= NSEC_PER_SEC) {
+        ts->tv_sec++;
+        ts->tv_nsec -= NSEC_PER_SEC;
+    }
+}
+
+/* Apply the optional SCHED_FIFO priority and CPU pinning to the sampler */
+static void monitor_configure_thread(void) {
+    const MonitorConfig* config = &monitor_state.config;
+    
+#ifdef __linux__
+    if (config->pin_to_cpu) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(config->cpu_index, &cpus);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_WARN, "Failed to pin sampler to CPU %u: %s",
+                        config->cpu_index, strerror(err));
+        }
+    }
+#endif
+    
+    if (config->realtime_priority) {
+        struct sched_param param = { .sched_priority = config->realtime_priority };
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            // Usually missing CAP_SYS_NICE; keep sampling at normal priority
+            DEBUG_PRINT(DEBUG_LEVEL_WARN, "SCHED_FIFO unavailable: %s", strerror(err));
+        } else {
+            monitor_state.stats.realtime = 1;
+        }
+    }
+}
+
+/* Runs collection on absolute deadlines so sample spacing doesn't drift
+ * with collection time. A tick that runs past later deadlines skips them
+ * instead of bursting to catch up, keeping samples on the period grid.
+ * Free running, the next tick starts as soon as one completes, and falls
+ * back to the period only while the device returns nothing. */
+static void* monitor_thread(void* arg) {
+    (void)arg;
+    const int64_t period_ns = (int64_t)monitor_state.tick_ms * 1000000LL;
+    struct timespec deadline, woke, done;
+    uint64_t tick = 0;
+    int productive = 0;
+    
+    monitor_configure_thread();
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    
+    while (monitor_state.running) {
+        if (!monitor_state.config.free_run || !productive) {
+            int err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+            if (err == EINTR) continue;
+        }
+        if (!monitor_state.running) break;
+        
+        clock_gettime(CLOCK_MONOTONIC, &woke);
+        productive = monitor_collect_data(tick) >= 0;
+        clock_gettime(CLOCK_MONOTONIC, &done);
+        
+        int64_t lateness_ns = timespec_diff_ns(&woke, &deadline);
+        uint32_t jitter_us = lateness_ns > 0 ? (uint32_t)(lateness_ns / 1000) : 0;
+        uint32_t tick_us = (uint32_t)(timespec_diff_ns(&done, &woke) / 1000);
+        
+        timespec_add_ns(&deadline, period_ns);
+        int64_t late_ns = timespec_diff_ns(&done, &deadline);
+        uint64_t missed = late_ns >= 0 ? (uint64_t)(late_ns / period_ns) + 1 : 0;
+        if (monitor_state.config.free_run && productive) {
+            // No deadline to miss: the grid restarts from here
+            deadline = done;
+            missed = 0;
+        }
+        if (missed) {
+            timespec_add_ns(&deadline, (int64_t)missed * period_ns);
+        }
+        tick += 1 + missed;
+        
+        if (monitor_state.config.dtc_interval_ms) {
+            monitor_watch_dtc(&deadline);
+        }
+        
+        pthread_mutex_lock(&monitor_state.lock);
+        MonitorStats* stats = &monitor_state.stats;
+        stats->ticks++;
+        stats->overruns += missed;
+        stats->jitter_last_us = jitter_us;
+        if (jitter_us > stats->jitter_max_us) stats->jitter_max_us = jitter_us;
+        stats->jitter_mean_us += ((double)jitter_us - stats->jitter_mean_us) / (double)stats->ticks;
+        stats->tick_last_us = tick_us;
+        if (tick_us > stats->tick_max_us) stats->tick_max_us = tick_us;
+        stats->safety_last_ns = monitor_state.safety_ns;
+        if (monitor_state.safety_ns > stats->safety_max_ns) stats->safety_max_ns = monitor_state.safety_ns;
+        pthread_mutex_unlock(&monitor_state.lock);
+    }
+    
+    return NULL;
+}
+
 /* Start monitoring */
+/* Rules and triggers may be set before monitor_init; each must name a
+ * sampled channel, or it would be evaluated on values never filled in */
+static int monitor_check_channels(const SafetyRuleSet* set, const char* what) {
+    for (size_t i = 0; i < set->count; i++) {
+        if (set->channel[i] >= monitor_state.config.pid_count) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "%s \"%s\" uses channel %u, only %zu sampled",
+                        what, set->rules[i].name, set->channel[i], monitor_state.config.pid_count);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int monitor_start(void) {
     if (monitor_state.running) return 0;
+    if (!monitor_state.history || monitor_state.config.sample_rate_ms == 0) return -1;
+    if (monitor_check_channels(&monitor_state.safety, "Safety rule") != 0 ||
+        monitor_check_channels(&monitor_state.trigger_rules, "Trigger") != 0) {
+        return -1;
+    }
+    
+    memset(&monitor_state.stats, 0, sizeof(monitor_state.stats));
+    timebase_start_session(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &monitor_state.dtc_next);
+    monitor_state.dtc_mode = 0;
+    monitor_state.dtc_cost_ns = 0;
+    memset(monitor_state.logged_at, 0, sizeof(monitor_state.logged_at));
+    monitor_state.trigger_flags = 0;
+    monitor_state.warning_flags = 0;
+    safety_rules_reset(&monitor_state.trigger_rules);
+    atomic_store(&monitor_state.fire_requests, 0);
+    
+    if (monitor_state.trigger_count) {
+        capture_state.running = 1;
+        if (pthread_create(&capture_state.thread, NULL, capture_thread, NULL) != 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to start capture thread");
+            capture_state.running = 0;
+            return -1;
+        }
+    }
     
     monitor_state.running = 1;
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Real-time monitoring started");
+    if (pthread_create(&monitor_state.thread, NULL, monitor_thread, NULL) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to start sampling thread");
+        monitor_state.running = 0;
+        if (capture_state.running) {
+            pthread_mutex_lock(&capture_state.lock);
+            capture_state.running = 0;
+            pthread_cond_signal(&capture_state.wake);
+            pthread_mutex_unlock(&capture_state.lock);
+            pthread_join(capture_state.thread, NULL);
+        }
+        return -1;
+    }
     
-    // Start monitoring thread or timer here
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Real-time monitoring started (%u ms tick)",
+                monitor_state.tick_ms);
     return 0;
 }
 
@@ -63,18 +481,217 @@ int monitor_stop(void) {
     if (!monitor_state.running) return 0;
     
     monitor_state.running = 0;
-    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Real-time monitoring stopped");
+    pthread_join(monitor_state.thread, NULL);
     
-    // Stop monitoring thread or timer here
+    // The capture thread writes out whatever the open captures have got
+    if (capture_state.running) {
+        pthread_mutex_lock(&capture_state.lock);
+        capture_state.running = 0;
+        pthread_cond_signal(&capture_state.wake);
+        pthread_mutex_unlock(&capture_state.lock);
+        pthread_join(capture_state.thread, NULL);
+    }
+    
+    if (monitor_state.log) {
+        log_sink_flush(monitor_state.log);
+    }
+    
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Real-time monitoring stopped (%llu ticks, %llu overruns, "
+                "max jitter %u us)", (unsigned long long)monitor_state.stats.ticks,
+                (unsigned long long)monitor_state.stats.overruns,
+                monitor_state.stats.jitter_max_us);
+    return 0;
+}
+
+/* Get sampling thread statistics */
+int monitor_get_stats(MonitorStats* stats) {
+    if (!stats) return -1;
+    
+    pthread_mutex_lock(&monitor_state.lock);
+    *stats = monitor_state.stats;
+    pthread_mutex_unlock(&monitor_state.lock);
+    
+    LogSinkStats log_stats;
+    if (monitor_state.log && log_sink_get_stats(monitor_state.log, &log_stats) == 0) {
+        stats->log_queue_depth = log_stats.queue_depth;
+        stats->log_dropped = log_stats.records_dropped;
+    }
     return 0;
 }
 
+/* Replace the safety rules; the sampler owns them while running */
+int monitor_set_safety_rules(const SafetyRule* rules, size_t count) {
+    if (monitor_state.running || (count && !rules)) return -1;
+    
+    safety_rules_init(&monitor_state.safety);
+    for (size_t i = 0; i < count; i++) {
+        if (rules[i].channel >= 32 ||
+            safety_rules_add(&monitor_state.safety, &rules[i]) < 0) {
+            safety_rules_init(&monitor_state.safety);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Replace the capture triggers */
+int monitor_set_triggers(const MonitorTrigger* triggers, size_t count) {
+    if (monitor_state.running || count > MONITOR_MAX_TRIGGERS || (count && !triggers)) return -1;
+    
+    monitor_state.trigger_count = 0;
+    safety_rules_init(&monitor_state.trigger_rules);
+    
+    for (size_t i = 0; i < count; i++) {
+        monitor_state.triggers[i] = triggers[i];
+        if (!triggers[i].use_condition) continue;
+        
+        SafetyRule rule = triggers[i].condition;
+        rule.flag = 1u << i;
+        rule.callback = NULL;
+        if (rule.channel >= 32 || safety_rules_add(&monitor_state.trigger_rules, &rule) < 0) {
+            safety_rules_init(&monitor_state.trigger_rules);
+            return -1;
+        }
+    }
+    monitor_state.trigger_count = count;
+    return 0;
+}
+
+/* Fire a trigger by hand; the sampler acts on it at its next tick */
+int monitor_fire_trigger(size_t index) {
+    if (index >= monitor_state.trigger_count) return -1;
+    atomic_fetch_or(&monitor_state.fire_requests, 1u << index);
+    return 0;
+}
+
+/* Seqlock primitives, single writer */
+static void seqlock_write(atomic_uint_fast64_t* seq, uint64_t index,
+                          void* dst, const void* src, size_t size) {
+    atomic_store_explicit(seq, 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(dst, src, size);
+    atomic_store_explicit(seq, 2 * index + 2, memory_order_release);
+}
+
+/* Copy entry index out of its slot. Returns -1 once the writer has
+ * lapped it, retries while it is mid-write. */
+static int seqlock_read(const atomic_uint_fast64_t* seq, uint64_t index,
+                        void* dst, const void* src, size_t size) {
+    const uint64_t complete = 2 * index + 2;
+    
+    for (;;) {
+        uint64_t before = atomic_load_explicit(seq, memory_order_acquire);
+        if (before > complete) return -1;      // Overwritten by a newer entry
+        if (before != complete) continue;      // Being written right now
+        
+        memcpy(dst, src, size);
+        atomic_thread_fence(memory_order_acquire);
+        
+        if (atomic_load_explicit(seq, memory_order_relaxed) == before) return 0;
+    }
+}
+
+/* History ring */
+static void history_publish(const MonitorSample* sample) {
+    uint64_t index = atomic_load_explicit(&monitor_state.published, memory_order_relaxed);
+    HistorySlot* slot = &monitor_state.history[index % monitor_state.config.buffer_size];
+    
+    seqlock_write(&slot->seq, index, &slot->sample, sample, sizeof(*sample));
+    atomic_store_explicit(&monitor_state.published, index + 1, memory_order_release);
+}
+
+static int history_read(uint64_t index, MonitorSample* out) {
+    HistorySlot* slot = &monitor_state.history[index % monitor_state.config.buffer_size];
+    return seqlock_read(&slot->seq, index, out, &slot->sample, sizeof(*out));
+}
+
+/* Event stream and last-value cache */
+static void event_publish(const MonitorEvent* event) {
+    uint64_t index = atomic_load_explicit(&monitor_state.events_published, memory_order_relaxed);
+    EventSlot* slot = &monitor_state.events[index % monitor_state.event_capacity];
+    
+    seqlock_write(&slot->seq, index, &slot->event, event, sizeof(*event));
+    atomic_store_explicit(&monitor_state.events_published, index + 1, memory_order_release);
+    
+    // The cache slot's index is simply how often the channel was updated
+    EventSlot* cache = &monitor_state.channels[event->channel];
+    uint64_t updates = atomic_load_explicit(&cache->seq, memory_order_relaxed) / 2;
+    seqlock_write(&cache->seq, updates, &cache->event, event, sizeof(*event));
+}
+
+/* Copy events from *cursor onwards, advancing it. Events overwritten
+ * before the caller got to them are skipped. */
+int monitor_get_events(uint64_t* cursor, MonitorEvent* events, size_t* count) {
+    if (!monitor_state.events || !cursor || !events || !count) return -1;
+    
+    uint64_t published = atomic_load_explicit(&monitor_state.events_published, memory_order_acquire);
+    uint64_t oldest = published > monitor_state.event_capacity ?
+                      published - monitor_state.event_capacity : 0;
+    size_t copied = 0;
+    
+    if (*cursor < oldest) *cursor = oldest;
+    
+    while (*cursor < published && copied < *count) {
+        EventSlot* slot = &monitor_state.events[*cursor % monitor_state.event_capacity];
+        if (seqlock_read(&slot->seq, *cursor, &events[copied], &slot->event,
+                         sizeof(MonitorEvent)) == 0) {
+            copied++;
+        }
+        (*cursor)++;
+    }
+    
+    *count = copied;
+    return 0;
+}
+
+/* Last value seen on a channel, -1 if it was never sampled */
+int monitor_get_channel(size_t channel, MonitorEvent* latest) {
+    if (channel >= monitor_state.config.pid_count || !latest) return -1;
+    
+    EventSlot* cache = &monitor_state.channels[channel];
+    for (;;) {
+        uint64_t seq = atomic_load_explicit(&cache->seq, memory_order_acquire);
+        if (seq == 0) return -1;
+        if (seq & 1) continue;
+        if (seqlock_read(&cache->seq, seq / 2 - 1, latest, &cache->event, sizeof(*latest)) == 0) {
+            return 0;
+        }
+    }
+}
+
 /* Get latest sample */
 int monitor_get_latest(MonitorSample* sample) {
-    if (!monitor_state.running || !sample) return -1;
+    if (!monitor_state.history || !sample) return -1;
+    
+    for (;;) {
+        uint64_t published = atomic_load_explicit(&monitor_state.published, memory_order_acquire);
+        if (published == 0 ||
+            published <= atomic_load_explicit(&monitor_state.base, memory_order_relaxed)) {
+            return -1;
+        }
+        if (history_read(published - 1, sample) == 0) return 0;
+    }
+}
+
+/* Copy up to *count of the most recent samples, oldest first.
+ * Samples the writer overwrites during the copy are left out. */
+int monitor_get_history(MonitorSample* samples, size_t* count) {
+    if (!monitor_state.history || !samples || !count) return -1;
     
-    size_t idx = (monitor_state.history_head - 1) % monitor_state.config.buffer_size;
-    *sample = monitor_state.history[idx];
+    uint64_t published = atomic_load_explicit(&monitor_state.published, memory_order_acquire);
+    uint64_t base = atomic_load_explicit(&monitor_state.base, memory_order_relaxed);
+    uint64_t available = published > base ? published - base : 0;
+    uint64_t wanted = *count;
+    
+    if (available > monitor_state.config.buffer_size) available = monitor_state.config.buffer_size;
+    if (wanted > available) wanted = available;
+    
+    size_t copied = 0;
+    for (uint64_t index = published - wanted; index < published; index++) {
+        if (history_read(index, &samples[copied]) == 0) copied++;
+    }
+    
+    *count = copied;
     return 0;
 }
 
@@ -108,55 +725,117 @@ int monitor_get_dtc_description(const char* code, char* desc, size_t size) {
     return -1;
 }
 
-static void monitor_collect_data(void) {
-    if (!monitor_state.running) return;
-    
-    MonitorSample* sample = &monitor_state.history[monitor_state.history_head];
-    sample->timestamp = time(NULL);
+/* Sample the channels due in this tick, publish one event per channel
+ * and a dense snapshot built from the last-value cache. Returns -1 when
+ * the device answered none of the due channels. */
+static int monitor_collect_data(uint64_t tick) {
+    if (!monitor_state.running) return -1;
     
-    // Request data for each configured PID
+    size_t due = 0;
     for (size_t i = 0; i < monitor_state.config.pid_count; i++) {
-        uint8_t data[8];
-        size_t length = sizeof(data);
-        uint8_t pid = monitor_state.config.pids[i];
+        if (tick < monitor_state.next_tick[i]) continue;
+        
+        // Stay on the channel's grid even if overruns skipped ticks
+        uint64_t period = monitor_state.period_ticks[i];
+        monitor_state.next_tick[i] += period * ((tick - monitor_state.next_tick[i]) / period + 1);
+        monitor_state.due_queries[due] = monitor_state.queries[i];
+        monitor_state.due_channels[due++] = (uint8_t)i;
+    }
+    if (due == 0) return 0;
+    
+    // Request the due PIDs in one batch
+    uint64_t requested = timebase_now_us();
+    int decoded = device_read_pids(monitor_state.device, monitor_state.due_queries,
+                                   monitor_state.results, due);
+    
+    // Events carry the transport's receive time; failed reads the request time
+    uint64_t timestamp = requested;
+    MonitorLogRow row;
+    int row_used = 0;
+    for (size_t d = 0; d < due; d++) {
+        const PIDResult* result = &monitor_state.results[d];
+        uint8_t channel = monitor_state.due_channels[d];
+        MonitorEvent* event = &monitor_state.last[channel];
         
-        if (monitor_state.device->read_pid(0x01, pid, data, &length) == 0) {
+        event->timestamp = requested;
+        if (decoded >= 0 && result->status == 0 && result->length > 0) {
+            if (result->timestamp_us) event->timestamp = result->timestamp_us;
+            if (event->timestamp > timestamp) timestamp = event->timestamp;
             // Process the data based on PID type
-            float value = process_pid_data(pid, data, length);
-            sample->values[i] = value;
-            sample->status[i] = 1;  // Valid data
-            
-            // Log to file if enabled
-            if (monitor_state.log_file) {
-                if (i == 0) {
-                    fprintf(monitor_state.log_file, "%u", sample->timestamp);
-                }
-                fprintf(monitor_state.log_file, ",%f", value);
-            }
+            event->value = process_pid_data(monitor_state.config.pids[channel],
+                                            result->data, result->length);
+            event->status = MONITOR_STATUS_FRESH;
         } else {
-            sample->values[i] = 0.0f;
-            sample->status[i] = 0;  // Invalid/no data
-            if (monitor_state.log_file && i == 0) {
-                fprintf(monitor_state.log_file, "%u,ERROR", sample->timestamp);
+            event->value = 0.0f;
+            event->status = MONITOR_STATUS_INVALID;
+        }
+        event_publish(event);
+        
+        // Log to file if enabled, thinned to log_interval_ms; a full queue
+        // drops the row, not the sample
+        if (monitor_state.log && (event->timestamp - monitor_state.logged_at[channel] >=
+                                  (uint64_t)monitor_state.config.log_interval_ms * 1000 ||
+                                  monitor_state.logged_at[channel] == 0)) {
+            monitor_state.logged_at[channel] = event->timestamp;
+            if (!monitor_state.columns) {
+                log_sink_append(monitor_state.log, event);
+            } else {
+                if (!row_used) {
+                    for (size_t i = 0; i < monitor_state.config.pid_count; i++) row.values[i] = NAN;
+                    row_used = 1;
+                }
+                row.values[channel] = event->status == MONITOR_STATUS_FRESH ? event->value : NAN;
             }
         }
     }
+    if (row_used) {
+        row.timestamp = timestamp;
+        log_sink_append(monitor_state.log, &row);
+    }
     
-    if (monitor_state.log_file) {
-        fprintf(monitor_state.log_file, "\n");
-        fflush(monitor_state.log_file);
+    // Channels not due this tick carry their cached value forward
+    MonitorSample sample = {0};
+    sample.timestamp = timestamp;
+    for (size_t i = 0; i < monitor_state.config.pid_count; i++) {
+        const MonitorEvent* last = &monitor_state.last[i];
+        sample.values[i] = last->value;
+        sample.status[i] = last->status == MONITOR_STATUS_FRESH ? MONITOR_STATUS_HELD : last->status;
+    }
+    for (size_t d = 0; d < due; d++) {
+        uint8_t channel = monitor_state.due_channels[d];
+        sample.status[channel] = monitor_state.last[channel].status;
     }
     
-    // Update history head
-    monitor_state.history_head = (monitor_state.history_head + 1) % monitor_state.config.buffer_size;
-    if (monitor_state.history_size < monitor_state.config.buffer_size) {
-        monitor_state.history_size++;
+    // Check limits before publishing so readers see the flags with the sample
+    float values[32];
+    for (size_t i = 0; i < monitor_state.config.pid_count; i++) {
+        values[i] = sample.status[i] == MONITOR_STATUS_INVALID ? NAN : sample.values[i];
     }
+    if (monitor_state.safety.count) {
+        struct timespec start, end;
+        
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        sample.warning_flags = safety_rules_evaluate(&monitor_state.safety, values, timestamp);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        monitor_state.safety_ns = (uint32_t)timespec_diff_ns(&end, &start);
+    }
+    
+    history_publish(&sample);
+    
+    // Derived channels and custom parameters follow the live sample
+    performance_update_channels(monitor_state.config.pids, values, monitor_state.config.pid_count);
+    
+    if (monitor_state.trigger_count) {
+        monitor_check_triggers(&sample, values);
+    }
+    return decoded > 0 ? decoded : -1;
 }
 
 static float process_pid_data(uint8_t pid, const uint8_t* data, size_t length) {
     float result = 0.0f;
     
+    if (length < obd2_pid_data_length(pid)) return 0.0f;
+    
     switch (pid) {
         case 0x04:  // Calculated engine load
             result = (float)data[0] * 100.0f / 255.0f;
@@ -188,32 +867,403 @@ static float process_pid_data(uint8_t pid, const uint8_t* data, size_t length) {
 int monitor_clear_history(void) {
     if (!monitor_state.history) return -1;
     
-    memset(monitor_state.history, 0, 
-           sizeof(MonitorSample) * monitor_state.config.buffer_size);
-    monitor_state.history_head = 0;
-    monitor_state.history_size = 0;
+    // Hide everything published so far; the sampler keeps writing undisturbed
+    atomic_store_explicit(&monitor_state.base,
+                          atomic_load_explicit(&monitor_state.published, memory_order_acquire),
+                          memory_order_relaxed);
     
     return 0;
 }
 
-int monitor_check_dtc(void) {
-    uint8_t data[32];
+/* Triggered captures */
+static void capture_start(size_t trigger, uint64_t fired_at) {
+    pthread_mutex_lock(&capture_state.lock);
+    
+    // A trigger that is still capturing doesn't start a second window
+    CaptureSlot* free_slot = NULL;
+    for (size_t i = 0; i < MONITOR_MAX_CAPTURES; i++) {
+        CaptureSlot* slot = &capture_state.slots[i];
+        if (slot->active && slot->trigger == trigger) {
+            pthread_mutex_unlock(&capture_state.lock);
+            return;
+        }
+        if (!slot->active && !free_slot) free_slot = slot;
+    }
+    
+    if (free_slot) {
+        free_slot->active = 1;
+        free_slot->trigger = trigger;
+        free_slot->fired_at = fired_at;
+        free_slot->cursor = 0;
+        free_slot->file = NULL;
+        free_slot->columns = NULL;
+        pthread_cond_signal(&capture_state.wake);
+    }
+    pthread_mutex_unlock(&capture_state.lock);
+    
+    if (free_slot) {
+        pthread_mutex_lock(&monitor_state.lock);
+        monitor_state.stats.captures_started++;
+        pthread_mutex_unlock(&monitor_state.lock);
+    } else {
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "No free capture slot for trigger %s",
+                    monitor_state.triggers[trigger].name);
+    }
+}
+
+/* Called by the sampler after each snapshot; fires on rising edges only */
+static void monitor_check_triggers(const MonitorSample* sample, const float* values) {
+    uint32_t fired = atomic_exchange(&monitor_state.fire_requests, 0);
+    
+    if (monitor_state.trigger_rules.count) {
+        uint32_t flags = safety_rules_evaluate(&monitor_state.trigger_rules, values,
+                                               sample->timestamp);
+        fired |= flags & ~monitor_state.trigger_flags;
+        monitor_state.trigger_flags = flags;
+    }
+    
+    uint32_t raised = sample->warning_flags & ~monitor_state.warning_flags;
+    monitor_state.warning_flags = sample->warning_flags;
+    
+    for (size_t i = 0; i < monitor_state.trigger_count; i++) {
+        if ((fired & (1u << i)) || (raised & monitor_state.triggers[i].safety_mask)) {
+            DEBUG_PRINT(DEBUG_LEVEL_INFO, "Trigger %s fired", monitor_state.triggers[i].name);
+            capture_start(i, sample->timestamp);
+        }
+    }
+}
+
+static int capture_open(CaptureSlot* slot) {
+    const MonitorTrigger* trigger = &monitor_state.triggers[slot->trigger];
+    const char* dir = monitor_state.config.capture_dir[0] ? monitor_state.config.capture_dir : ".";
+    int64_t wall_us = timebase_to_wall_us(slot->fired_at);
+    time_t wall = (time_t)(wall_us / 1000000);
+    struct tm t;
+    char path[512];
+    
+    localtime_r(&wall, &t);
+    // Captures follow the main log's format
+    int csv = monitor_state.log && !monitor_state.columns;
+    snprintf(path, sizeof(path), "%s/capture_%s_%04d%02d%02d_%02d%02d%02d_%03d.%s",
+             dir, trigger->name[0] ? trigger->name : "trigger",
+             t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+             (int)(wall_us / 1000 % 1000), csv ? "csv" : "clog");
+    
+    slot->row_channels = 0;
+    if (!csv) {
+        slot->columns = monitor_create_column_log(path, 1024);
+        if (!slot->columns) return -1;
+        return 0;
+    }
+    
+    slot->file = fopen(path, "w");
+    if (!slot->file) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create capture file %s", path);
+        return -1;
+    }
+    setvbuf(slot->file, NULL, _IOFBF, 64 * 1024);
+    fputs("Timestamp,PID,Value\n", slot->file);
+    return 0;
+}
+
+/* Events of one tick are grouped into one row; a channel seen twice
+ * starts the next row */
+static void capture_write_event(CaptureSlot* slot, const MonitorEvent* event) {
+    if (slot->file) {
+        char line[LOG_SINK_MAX_LINE];
+        size_t length = format_log_event(event, line, sizeof(line));
+        fwrite(line, 1, length, slot->file);
+        return;
+    }
+    
+    uint32_t bit = 1u << event->channel;
+    if (slot->row_channels & bit) {
+        column_log_append(slot->columns, slot->row.timestamp, slot->row.values);
+        slot->row_channels = 0;
+    }
+    if (slot->row_channels == 0) {
+        for (size_t i = 0; i < monitor_state.config.pid_count; i++) slot->row.values[i] = NAN;
+        slot->row.timestamp = event->timestamp;
+    }
+    slot->row.values[event->channel] = event->status == MONITOR_STATUS_FRESH ? event->value : NAN;
+    slot->row_channels |= bit;
+}
+
+static int capture_close(CaptureSlot* slot) {
+    int status = 0;
+    
+    if (slot->file) {
+        status = fclose(slot->file) == 0 ? 0 : -1;
+        slot->file = NULL;
+    } else if (slot->columns) {
+        if (slot->row_channels) {
+            column_log_append(slot->columns, slot->row.timestamp, slot->row.values);
+        }
+        status = column_log_close(slot->columns);
+        slot->columns = NULL;
+    } else {
+        return -1;
+    }
+    return status;
+}
+
+/* Copy what the ring has of a capture window. Returns 1 once the window
+ * is complete, or when the sampler has stopped and nothing more will come. */
+static int capture_drain(CaptureSlot* slot) {
+    const MonitorTrigger* trigger = &monitor_state.triggers[slot->trigger];
+    uint64_t start = slot->fired_at > (uint64_t)trigger->pre_ms * 1000 ?
+                     slot->fired_at - (uint64_t)trigger->pre_ms * 1000 : 0;
+    uint64_t end = slot->fired_at + (uint64_t)trigger->post_ms * 1000;
+    MonitorEvent events[256];
+    uint64_t lost = 0;
+    int done = 0;
+    
+    if (!slot->file && !slot->columns) {
+        if (capture_open(slot) != 0) return 1;
+    }
+    
+    while (!done) {
+        size_t count = sizeof(events) / sizeof(events[0]);
+        uint64_t before = slot->cursor;
+        
+        monitor_get_events(&slot->cursor, events, &count);
+        // Entries the ring overwrote are skipped; before the window they don't matter
+        if (slot->cursor - before > count && before != 0) lost += slot->cursor - before - count;
+        if (count == 0) break;
+        
+        for (size_t i = 0; i < count; i++) {
+            const MonitorEvent* event = &events[i];
+            if (event->timestamp < start) continue;
+            if (event->timestamp > end) {
+                done = 1;
+                break;
+            }
+            capture_write_event(slot, event);
+        }
+    }
+    
+    if (lost) {
+        pthread_mutex_lock(&monitor_state.lock);
+        monitor_state.stats.capture_lost += lost;
+        pthread_mutex_unlock(&monitor_state.lock);
+    }
+    return done || !monitor_state.running;
+}
+
+/* Polls active captures every 10 ms, sleeps while there are none */
+static void* capture_thread(void* arg) {
+    (void)arg;
+    
+    pthread_mutex_lock(&capture_state.lock);
+    for (;;) {
+        uint32_t active = 0;
+        for (size_t i = 0; i < MONITOR_MAX_CAPTURES; i++) {
+            if (capture_state.slots[i].active) active |= 1u << i;
+        }
+        
+        if (active == 0) {
+            if (!capture_state.running) break;
+            pthread_cond_wait(&capture_state.wake, &capture_state.lock);
+            continue;
+        }
+        
+        // The sampler never touches an active slot, so work on them unlocked
+        int stopping = !capture_state.running;
+        pthread_mutex_unlock(&capture_state.lock);
+        
+        for (size_t i = 0; i < MONITOR_MAX_CAPTURES; i++) {
+            CaptureSlot* slot = &capture_state.slots[i];
+            if (!(active & (1u << i))) continue;
+            if (capture_drain(slot) || stopping) {
+                if (capture_close(slot) == 0) {
+                    pthread_mutex_lock(&monitor_state.lock);
+                    monitor_state.stats.captures_written++;
+                    pthread_mutex_unlock(&monitor_state.lock);
+                }
+                pthread_mutex_lock(&capture_state.lock);
+                slot->active = 0;
+                pthread_mutex_unlock(&capture_state.lock);
+            }
+        }
+        
+        if (!stopping) {
+            struct timespec pause = { 0, 10000000 };
+            nanosleep(&pause, NULL);
+        }
+        pthread_mutex_lock(&capture_state.lock);
+    }
+    pthread_mutex_unlock(&capture_state.lock);
+    
+    return NULL;
+}
+
+/* DTC watch */
+static const uint8_t dtc_modes[3] = {
+    OBD_MODE_READ_TROUBLE_CODES,   // Stored
+    0x07,                          // Pending
+    0x0A                           // Permanent
+};
+
+static int dtc_mode_index(uint8_t mode) {
+    for (int i = 0; i < 3; i++) {
+        if (dtc_modes[i] == mode) return i;
+    }
+    return -1;
+}
+
+static int dtc_contains(const uint16_t* codes, size_t count, uint16_t code) {
+    for (size_t i = 0; i < count; i++) {
+        if (codes[i] == code) return 1;
+    }
+    return 0;
+}
+
+/* Called with the lock held */
+static void dtc_publish(uint8_t mode, uint16_t raw_code, uint8_t set, uint64_t timestamp) {
+    MonitorDTCEvent* event = &monitor_state.dtc_events[monitor_state.dtc_events_published %
+                                                       MONITOR_DTC_EVENTS];
+    uint8_t bytes[2] = { (uint8_t)(raw_code >> 8), (uint8_t)raw_code };
+    
+    event->timestamp = timestamp;
+    event->mode = mode;
+    event->set = set;
+    event->raw_code = raw_code;
+    format_dtc(bytes, event->code);
+    monitor_state.dtc_events_published++;
+    
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "DTC %s %s (mode %02X)", event->code,
+                set ? "set" : "cleared", mode);
+}
+
+/* Read one DTC mode and publish the difference from the previous read */
+static int dtc_scan(size_t index) {
+    uint8_t data[2 * MONITOR_MAX_DTCS];
     size_t length = sizeof(data);
+    uint16_t codes[MONITOR_MAX_DTCS];
+    size_t count = 0;
+    uint8_t mode = dtc_modes[index];
     
-    // Mode 03: Request trouble codes
-    if (monitor_state.device->read_pid(0x03, 0x00, data, &length) != 0) {
+    if (!monitor_state.device || !monitor_state.device->read_pid ||
+        monitor_state.device->read_pid(mode, 0x00, data, &length) != 0) {
         return -1;
     }
     
-    // Process and store DTCs
-    size_t dtc_count = length / 2;  // Each DTC is 2 bytes
-    for (size_t i = 0; i < dtc_count; i++) {
-        char dtc[6];
-        format_dtc(data + (i * 2), dtc);
-        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Found DTC: %s", dtc);
+    // Each DTC is 2 bytes; zero pairs are padding
+    for (size_t i = 0; i + 1 < length && count < MONITOR_MAX_DTCS; i += 2) {
+        uint16_t code = (uint16_t)((data[i] << 8) | data[i + 1]);
+        if (code != 0 && !dtc_contains(codes, count, code)) codes[count++] = code;
+    }
+    
+    uint64_t timestamp = timebase_now_us();
+    uint16_t* previous = monitor_state.dtcs[index];
+    size_t previous_count = monitor_state.dtc_count[index];
+    
+    pthread_mutex_lock(&monitor_state.lock);
+    for (size_t i = 0; i < count; i++) {
+        if (!dtc_contains(previous, previous_count, codes[i])) {
+            dtc_publish(mode, codes[i], 1, timestamp);
+        }
+    }
+    for (size_t i = 0; i < previous_count; i++) {
+        if (!dtc_contains(codes, count, previous[i])) {
+            dtc_publish(mode, previous[i], 0, timestamp);
+        }
     }
+    memcpy(previous, codes, count * sizeof(uint16_t));
+    monitor_state.dtc_count[index] = count;
+    pthread_mutex_unlock(&monitor_state.lock);
     
-    return dtc_count;
+    return (int)count;
+}
+
+/* Poll the next DTC mode if one is due and the tick left enough slack
+ * before the next deadline. A poll deferred for four periods runs anyway
+ * so a saturated sampler can't starve it. */
+static void monitor_watch_dtc(const struct timespec* deadline) {
+    const int64_t step_ns = (int64_t)monitor_state.config.dtc_interval_ms * 1000000LL / 3;
+    struct timespec now, done;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t overdue_ns = timespec_diff_ns(&now, &monitor_state.dtc_next);
+    if (overdue_ns < 0) return;
+    
+    int64_t slack_ns = timespec_diff_ns(deadline, &now);
+    int64_t needed_ns = monitor_state.dtc_cost_ns ? monitor_state.dtc_cost_ns * 3 / 2 :
+                        (int64_t)monitor_state.tick_ms * 500000LL;  // Half a tick until measured
+    if (slack_ns < needed_ns && overdue_ns < 4 * step_ns) {
+        pthread_mutex_lock(&monitor_state.lock);
+        monitor_state.stats.dtc_deferred++;
+        pthread_mutex_unlock(&monitor_state.lock);
+        return;
+    }
+    
+    dtc_scan(monitor_state.dtc_mode);
+    monitor_state.dtc_mode = (monitor_state.dtc_mode + 1) % 3;
+    
+    clock_gettime(CLOCK_MONOTONIC, &done);
+    int64_t cost_ns = timespec_diff_ns(&done, &now);
+    monitor_state.dtc_cost_ns = monitor_state.dtc_cost_ns ?
+                                (monitor_state.dtc_cost_ns * 7 + cost_ns) / 8 : cost_ns;
+    
+    monitor_state.dtc_next = done;
+    timespec_add_ns(&monitor_state.dtc_next, step_ns);
+    
+    pthread_mutex_lock(&monitor_state.lock);
+    monitor_state.stats.dtc_polls++;
+    monitor_state.stats.dtc_cost_us = (uint32_t)(monitor_state.dtc_cost_ns / 1000);
+    pthread_mutex_unlock(&monitor_state.lock);
+}
+
+/* Stored DTC count. While the sampler runs it owns the bus, so this
+ * reports the watcher's last Mode 03 result instead of reading. */
+int monitor_check_dtc(void) {
+    if (monitor_state.running) {
+        if (!monitor_state.config.dtc_interval_ms) return -1;
+        
+        pthread_mutex_lock(&monitor_state.lock);
+        int count = (int)monitor_state.dtc_count[0];
+        pthread_mutex_unlock(&monitor_state.lock);
+        return count;
+    }
+    
+    // Mode 03: Request trouble codes
+    return dtc_scan(0);
+}
+
+/* Copy DTC change events from *cursor onwards, advancing it */
+int monitor_get_dtc_events(uint64_t* cursor, MonitorDTCEvent* events, size_t* count) {
+    if (!cursor || !events || !count) return -1;
+    
+    size_t copied = 0;
+    
+    pthread_mutex_lock(&monitor_state.lock);
+    uint64_t published = monitor_state.dtc_events_published;
+    if (published > MONITOR_DTC_EVENTS && *cursor < published - MONITOR_DTC_EVENTS) {
+        *cursor = published - MONITOR_DTC_EVENTS;
+    }
+    while (*cursor < published && copied < *count) {
+        events[copied++] = monitor_state.dtc_events[*cursor % MONITOR_DTC_EVENTS];
+        (*cursor)++;
+    }
+    pthread_mutex_unlock(&monitor_state.lock);
+    
+    *count = copied;
+    return 0;
+}
+
+/* Codes currently reported for a mode (0x03, 0x07 or 0x0A) */
+int monitor_get_dtcs(uint8_t mode, uint16_t* codes, size_t* count) {
+    int index = dtc_mode_index(mode);
+    if (index < 0 || !codes || !count) return -1;
+    
+    pthread_mutex_lock(&monitor_state.lock);
+    size_t n = monitor_state.dtc_count[index];
+    if (n > *count) n = *count;
+    memcpy(codes, monitor_state.dtcs[index], n * sizeof(uint16_t));
+    pthread_mutex_unlock(&monitor_state.lock);
+    
+    *count = n;
+    return 0;
 }
 
 int monitor_clear_dtc(void) {
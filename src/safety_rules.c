@@ -0,0 +1,176 @@
+#include "safety_rules.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+void safety_rules_init(SafetyRuleSet* set) {
+    if (!set) return;
+    memset(set, 0, sizeof(*set));
+}
+
+int safety_rules_add(SafetyRuleSet* set, const SafetyRule* rule) {
+    if (!set || !rule) return -1;
+    if (set->count >= SAFETY_MAX_RULES) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Too many safety rules");
+        return -1;
+    }
+    
+    float sign = rule->direction == SAFETY_BELOW ? -1.0f : 1.0f;
+    float trip = rule->trip * sign;
+    float clear = rule->clear * sign;
+    
+    // Clearing must require backing off from trip, or the rule would chatter
+    if (isnan(trip) || isnan(clear) || clear > trip) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Safety rule %s: clear level is past trip", rule->name);
+        return -1;
+    }
+    
+    size_t i = set->count++;
+    set->rules[i] = *rule;
+    set->channel[i] = rule->channel;
+    set->sign[i] = sign;
+    set->trip[i] = trip;
+    set->clear[i] = clear;
+    set->debounce[i] = rule->debounce ? rule->debounce : 1;
+    set->pending[i] = 0;
+    set->active[i] = 0;
+    return (int)i;
+}
+
+/* Forget active warnings and debounce progress, keeping the rules */
+void safety_rules_reset(SafetyRuleSet* set) {
+    if (!set) return;
+    memset(set->pending, 0, sizeof(set->pending));
+    memset(set->active, 0, sizeof(set->active));
+    set->flags = 0;
+}
+
+static void rule_transition(SafetyRuleSet* set, size_t i, float value, uint64_t timestamp) {
+    const SafetyRule* rule = &set->rules[i];
+    
+    set->active[i] ^= 1;
+    set->transitions++;
+    
+    // Flags may be shared between rules, so rebuild rather than toggle
+    uint32_t flags = 0;
+    for (size_t r = 0; r < set->count; r++) {
+        if (set->active[r]) flags |= set->rules[r].flag;
+    }
+    set->flags = flags;
+    
+    if (rule->callback) {
+        rule->callback(rule, value, set->active[i], timestamp, rule->user_data);
+    }
+}
+
+/* Check one sample. The common case, nothing changing, is a compare per
+ * rule over flat arrays with no branches into the rule descriptors. */
+uint32_t safety_rules_evaluate(SafetyRuleSet* set, const float* values, uint64_t timestamp) {
+    if (!set || !values) return 0;
+    
+    for (size_t i = 0; i < set->count; i++) {
+        float v = values[set->channel[i]] * set->sign[i];
+        
+        if (set->active[i]) {
+            if (v < set->clear[i]) {
+                set->pending[i] = 0;
+                rule_transition(set, i, v * set->sign[i], timestamp);
+            }
+        } else if (v > set->trip[i]) {
+            if (++set->pending[i] >= set->debounce[i]) {
+                rule_transition(set, i, v * set->sign[i], timestamp);
+            }
+        } else {
+            set->pending[i] = 0;
+        }
+    }
+    return set->flags;
+}
+
+/* Comma separated names of the active rules */
+size_t safety_rules_describe(const SafetyRuleSet* set, char* out, size_t size) {
+    size_t length = 0;
+    
+    if (!out || size == 0) return 0;
+    out[0] = '\0';
+    if (!set) return 0;
+    
+    for (size_t i = 0; i < set->count && length < size - 1; i++) {
+        if (!set->active[i]) continue;
+        int n = snprintf(out + length, size - length, "%s%s", length ? ", " : "",
+                         set->rules[i].name);
+        if (n < 0) break;
+        length += (size_t)n < size - length ? (size_t)n : size - length - 1;
+    }
+    return length;
+}
+
+/* Benchmark */
+static void benchmark_callback(const SafetyRule* rule, float value, bool active,
+                               uint64_t timestamp, void* user_data) {
+    (void)rule; (void)value; (void)active; (void)timestamp;
+    (*(uint64_t*)user_data)++;
+}
+
+/* Time rule_count rules over samples synthetic samples of 32 channels that
+ * cross their thresholds now and then, and report the cost per sample */
+int safety_rules_benchmark(size_t rule_count, size_t samples) {
+    const size_t channels = 32;
+    SafetyRuleSet* set = malloc(sizeof(SafetyRuleSet));
+    float* values = malloc(samples * channels * sizeof(float));
+    uint64_t callbacks = 0;
+    uint32_t flags_seen = 0;
+    struct timespec start, end;
+    
+    if (!set || !values || rule_count == 0 || samples == 0) {
+        free(set);
+        free(values);
+        return -1;
+    }
+    if (rule_count > SAFETY_MAX_RULES) rule_count = SAFETY_MAX_RULES;
+    
+    safety_rules_init(set);
+    for (size_t r = 0; r < rule_count; r++) {
+        SafetyRule rule = {0};
+        snprintf(rule.name, sizeof(rule.name), "rule%zu", r);
+        rule.channel = (uint8_t)(r % channels);
+        rule.direction = (r & 1) ? SAFETY_BELOW : SAFETY_ABOVE;
+        rule.trip = (r & 1) ? 10.0f : 90.0f;
+        rule.clear = (r & 1) ? 15.0f : 85.0f;
+        rule.debounce = (uint16_t)(r % 3);
+        rule.flag = 1u << (r % 32);
+        rule.callback = benchmark_callback;
+        rule.user_data = &callbacks;
+        safety_rules_add(set, &rule);
+    }
+    
+    // Slow triangle waves between 0 and 100, phase shifted per channel
+    for (size_t s = 0; s < samples; s++) {
+        for (size_t c = 0; c < channels; c++) {
+            size_t phase = (s + c * 37) % 2000;
+            values[s * channels + c] = (phase < 1000 ? phase : 2000 - phase) / 10.0f;
+        }
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t s = 0; s < samples; s++) {
+        flags_seen |= safety_rules_evaluate(set, &values[s * channels], s);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    double per_sample_ns = elapsed_ns / samples;
+    
+    printf("Safety rules: %zu rules x %zu samples in %.2f ms\n",
+           rule_count, samples, elapsed_ns / 1e6);
+    printf("  %.1f ns per sample, %llu transitions, flags seen 0x%08X\n",
+           per_sample_ns, (unsigned long long)callbacks, flags_seen);
+    printf("  %s (budget 1000 ns per sample)\n", per_sample_ns < 1000.0 ? "PASS" : "FAIL");
+    
+    free(set);
+    free(values);
+    return per_sample_ns < 1000.0 ? 0 : -1;
+}
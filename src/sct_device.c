@@ -1,42 +1,506 @@
 #include "sct_device.h"
+#include "sct_emulator.h"
 #include "device_adapter.h"
+#include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "SCT stream samples are read in place and assume a little-endian host"
+#endif
+
+_Static_assert(sizeof(SCTPacketHeader) == 9, "SCT header must match the wire layout");
+_Static_assert(sizeof(SCTSample) == 24, "SCTSample must match the wire layout");
+
+#define SCT_DEFAULT_TIMEOUT_MS 1000
+#define SCT_FIRMWARE_CHUNK     (SCT_MAX_PAYLOAD - 4)
 
 static SCTDeviceInterface sct_interface;
-static DeviceConfig* current_config;
+static DeviceInterface sct_device_interface;
+
+static struct {
+    int fd;
+    DeviceConfig config;
+    uint16_t timeout_ms;
+    uint32_t sequence;
+    uint16_t sample_rate;        // Active logging rate, 0 = stopped
+    uint8_t emulated;            // Connected to the in-process emulator
+    uint32_t stream_dropped;     // Stream samples discarded during requests
+    uint8_t scratch[SCT_MAX_PAYLOAD];
+} sct_state = { .fd = -1 };
+
+static int verify_fuel_parameters(const SCTAdvancedTuning* tuning);
+static int verify_boost_parameters(const SCTAdvancedTuning* tuning);
+
+/* Transport */
+static int sct_wait_readable(uint32_t timeout_ms) {
+    struct pollfd pfd = { .fd = sct_state.fd, .events = POLLIN };
+    int ready;
+    
+    do {
+        ready = poll(&pfd, 1, (int)timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+    
+    return ready > 0 ? 1 : ready;
+}
+
+/* Fill every iovec completely, resuming after partial reads */
+static int sct_readv_exact(struct iovec* iov, int iovcnt) {
+    while (iovcnt > 0) {
+        if (sct_wait_readable(sct_state.timeout_ms) <= 0) return -1;
+        
+        ssize_t n = readv(sct_state.fd, iov, iovcnt);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+        if (n <= 0) return -1;
+        
+        while (n > 0) {
+            if ((size_t)n >= iov->iov_len) {
+                n -= (ssize_t)iov->iov_len;
+                iov++;
+                iovcnt--;
+            } else {
+                iov->iov_base = (uint8_t*)iov->iov_base + n;
+                iov->iov_len -= (size_t)n;
+                n = 0;
+            }
+        }
+    }
+    return 0;
+}
+
+static int sct_read_exact(void* buf, size_t len) {
+    struct iovec iov = { buf, len };
+    return len ? sct_readv_exact(&iov, 1) : 0;
+}
+
+static int sct_read_header(SCTPacketHeader* header) {
+    if (sct_read_exact(header, sizeof(*header)) != 0) return -1;
+    
+    if (header->version != SCT_PROTOCOL_VERSION || header->length > SCT_MAX_PAYLOAD) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Bad SCT frame (version %u, length %u)",
+                    header->version, header->length);
+        return -1;
+    }
+    return 0;
+}
+
+static int sct_send(uint8_t command, const void* payload, uint16_t length, uint32_t* sequence) {
+    SCTPacketHeader header = {
+        .version = SCT_PROTOCOL_VERSION,
+        .command = command,
+        .length = length,
+        .sequence = ++sct_state.sequence,
+        .flags = 0
+    };
+    struct iovec iov[2] = {
+        { &header, sizeof(header) },
+        { (void*)payload, length }
+    };
+    struct iovec* cur = iov;
+    int iovcnt = length ? 2 : 1;
+    
+    while (iovcnt > 0) {
+        ssize_t n = writev(sct_state.fd, cur, iovcnt);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT write failed: %s", strerror(errno));
+            return -1;
+        }
+        
+        while (n > 0) {
+            if ((size_t)n >= cur->iov_len) {
+                n -= (ssize_t)cur->iov_len;
+                cur++;
+                iovcnt--;
+            } else {
+                cur->iov_base = (uint8_t*)cur->iov_base + n;
+                cur->iov_len -= (size_t)n;
+                n = 0;
+            }
+        }
+    }
+    
+    *sequence = header.sequence;
+    return 0;
+}
+
+/* Send a request and wait for its response. Logging frames that arrive
+ * in between can't be delivered anywhere and are counted as dropped. */
+static int sct_transact(uint8_t command, const void* payload, uint16_t length,
+                        void* response, size_t* response_len) {
+    uint32_t sequence;
+    size_t capacity = response_len ? *response_len : 0;
+    
+    if (sct_state.fd < 0) return -1;
+    if (sct_send(command, payload, length, &sequence) != 0) return -1;
+    
+    for (;;) {
+        SCTPacketHeader header;
+        if (sct_read_header(&header) != 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "No SCT response to command 0x%02X", command);
+            return -1;
+        }
+        
+        int match = (header.flags & SCT_FLAG_RESPONSE) && header.sequence == sequence;
+        if (!match || header.length > capacity) {
+            if (sct_read_exact(sct_state.scratch, header.length) != 0) return -1;
+            if (header.flags & SCT_FLAG_STREAM) {
+                sct_state.stream_dropped += header.length / sizeof(SCTSample);
+            }
+            if (!match) continue;
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT response to 0x%02X too large", command);
+            return -1;
+        }
+        
+        if (sct_read_exact(response, header.length) != 0) return -1;
+        if (response_len) *response_len = header.length;
+        
+        if (header.flags & SCT_FLAG_ERROR) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT rejected command 0x%02X", command);
+            return -1;
+        }
+        return 0;
+    }
+}
+
+/* Read one page into a fixed size structure */
+static int sct_read_page(uint8_t page, void* data, size_t size) {
+    size_t length = size;
+    if (sct_transact(SCT_CMD_READ_PARAMS, &page, 1, data, &length) != 0) return -1;
+    return length == size ? 0 : -1;
+}
+
+static int sct_write_page(uint8_t page, const void* data, size_t size) {
+    if (size + 1 > SCT_MAX_PAYLOAD) return -1;
+    
+    uint8_t payload[SCT_MAX_PAYLOAD];
+    payload[0] = page;
+    memcpy(payload + 1, data, size);
+    return sct_transact(SCT_CMD_WRITE_PARAMS, payload, (uint16_t)(size + 1), NULL, NULL);
+}
+
+/* Basic SCT functions */
+static int sct_get_parameters(SCTParameters* params) {
+    if (!params) return -1;
+    return sct_read_page(SCT_PAGE_LIVE, params, sizeof(*params));
+}
+
+static int sct_set_parameters(const SCTParameters* params) {
+    if (!params) return -1;
+    return sct_write_page(SCT_PAGE_LIVE, params, sizeof(*params));
+}
+
+/* Advanced tuning */
+static int sct_get_advanced_tuning(SCTAdvancedTuning* tuning) {
+    size_t length = sizeof(*tuning);
+    if (!tuning) return -1;
+    if (sct_transact(SCT_CMD_READ_TUNE, NULL, 0, tuning, &length) != 0) return -1;
+    return length == sizeof(*tuning) ? 0 : -1;
+}
+
+static int sct_set_advanced_tuning(const SCTAdvancedTuning* tuning) {
+    if (!tuning) return -1;
+    return sct_transact(SCT_CMD_WRITE_TUNE, tuning, sizeof(*tuning), NULL, NULL);
+}
+
+/* Tuning profiles are device tunes saved to <name>.tune */
+static int sct_save_tuning_profile(const char* name) {
+    SCTAdvancedTuning tuning;
+    char path[256];
+    
+    if (!name || sct_get_advanced_tuning(&tuning) != 0) return -1;
+    
+    snprintf(path, sizeof(path), "%s.tune", name);
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return -1;
+    
+    size_t written = fwrite(&tuning, sizeof(tuning), 1, fp);
+    fclose(fp);
+    return written == 1 ? 0 : -1;
+}
+
+static int sct_load_tuning_profile(const char* name) {
+    SCTAdvancedTuning tuning;
+    char path[256];
+    
+    if (!name) return -1;
+    
+    snprintf(path, sizeof(path), "%s.tune", name);
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return -1;
+    
+    size_t read = fread(&tuning, sizeof(tuning), 1, fp);
+    fclose(fp);
+    if (read != 1) return -1;
+    
+    if (verify_fuel_parameters(&tuning) != 0 || verify_boost_parameters(&tuning) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Tuning profile %s failed verification", name);
+        return -1;
+    }
+    return sct_set_advanced_tuning(&tuning);
+}
+
+/* Real-time monitoring */
+static int sct_start_monitoring(uint16_t sample_rate) {
+    uint32_t max_rate = sct_state.config.device_config.sct.max_sample_rate;
+    
+    if (sample_rate == 0) return -1;
+    if (max_rate && sample_rate > max_rate) sample_rate = (uint16_t)max_rate;
+    
+    if (sct_transact(SCT_CMD_START_LOGGING, &sample_rate, sizeof(sample_rate), NULL, NULL) != 0) {
+        return -1;
+    }
+    
+    sct_state.sample_rate = sample_rate;
+    sct_state.stream_dropped = 0;
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "SCT logging at %u Hz", sample_rate);
+    return 0;
+}
+
+static int sct_stop_monitoring(void) {
+    if (!sct_state.sample_rate) return 0;
+    
+    sct_state.sample_rate = 0;
+    return sct_transact(SCT_CMD_STOP_LOGGING, NULL, 0, NULL, NULL);
+}
+
+/* Read one stream payload straight into the ring's free slots */
+static int sct_stream_into_ring(SCTSampleRing* ring, uint16_t length) {
+    uint32_t count = length / sizeof(SCTSample);
+    uint32_t space = ring->capacity - (ring->head - ring->tail);
+    uint32_t take = count < space ? count : space;
+    uint32_t start = ring->head & (ring->capacity - 1);
+    uint32_t first = take < ring->capacity - start ? take : ring->capacity - start;
+    struct iovec iov[3];
+    int iovcnt = 0;
+    
+    if (first) {
+        iov[iovcnt].iov_base = &ring->slots[start];
+        iov[iovcnt++].iov_len = first * sizeof(SCTSample);
+    }
+    if (take > first) {
+        iov[iovcnt].iov_base = &ring->slots[0];
+        iov[iovcnt++].iov_len = (take - first) * sizeof(SCTSample);
+    }
+    if (take < count) {
+        iov[iovcnt].iov_base = sct_state.scratch;
+        iov[iovcnt++].iov_len = (count - take) * sizeof(SCTSample);
+    }
+    
+    if (iovcnt && sct_readv_exact(iov, iovcnt) != 0) return -1;
+    
+    ring->head += take;
+    ring->dropped += count - take;
+    return 0;
+}
+
+/* Drain pending logging frames into the caller's ring. Waits up to the
+ * link timeout for the first frame, then takes whatever is queued. */
+static int sct_get_monitoring_data(void* data, size_t* size) {
+    SCTSampleRing* ring = data;
+    
+    if (!ring || !size || !ring->slots || ring->capacity == 0 ||
+        (ring->capacity & (ring->capacity - 1)) != 0) {
+        return -1;
+    }
+    if (sct_state.fd < 0 || !sct_state.sample_rate) return -1;
+    
+    uint32_t before = ring->head;
+    uint32_t wait_ms = sct_state.timeout_ms;
+    
+    while (ring->head - ring->tail < ring->capacity) {
+        int ready = sct_wait_readable(wait_ms);
+        if (ready < 0) return -1;
+        if (ready == 0) break;
+        wait_ms = 0;
+        
+        SCTPacketHeader header;
+        if (sct_read_header(&header) != 0) return -1;
+        
+        if ((header.flags & SCT_FLAG_STREAM) && header.length % sizeof(SCTSample) == 0) {
+            if (sct_stream_into_ring(ring, header.length) != 0) return -1;
+        } else if (sct_read_exact(sct_state.scratch, header.length) != 0) {
+            return -1;
+        }
+    }
+    
+    ring->dropped += sct_state.stream_dropped;
+    sct_state.stream_dropped = 0;
+    *size = ring->head - before;
+    return 0;
+}
+
+/* Safety systems */
+static int sct_get_safety_limits(void* limits, size_t* size) {
+    if (!limits || !size) return -1;
+    
+    uint8_t page = SCT_PAGE_SAFETY_LIMITS;
+    return sct_transact(SCT_CMD_READ_PARAMS, &page, 1, limits, size);
+}
+
+static int sct_set_safety_limits(const void* limits, size_t size) {
+    if (!limits) return -1;
+    return sct_write_page(SCT_PAGE_SAFETY_LIMITS, limits, size);
+}
+
+static int sct_check_safety_status(void) {
+    uint8_t status[5];
+    
+    if (sct_read_page(SCT_PAGE_SAFETY_STATUS, status, sizeof(status)) != 0) return -1;
+    if (status[0] != 0) {
+        uint32_t event_id;
+        memcpy(&event_id, &status[1], sizeof(event_id));
+        DEBUG_PRINT(DEBUG_LEVEL_WARN, "SCT safety event 0x%08X pending", event_id);
+        return -1;
+    }
+    return 0;
+}
+
+/* Acknowledge a safety event; logging is stopped until the caller restarts it */
+static int sct_handle_safety_event(uint32_t event_id) {
+    DEBUG_PRINT(DEBUG_LEVEL_WARN, "Handling SCT safety event 0x%08X", event_id);
+    
+    sct_stop_monitoring();
+    return sct_write_page(SCT_PAGE_SAFETY_STATUS, &event_id, sizeof(event_id));
+}
+
+/* Firmware management */
+static int sct_check_firmware_version(char* version, size_t size) {
+    if (!version || size == 0) return -1;
+    
+    size_t length = size - 1;
+    if (sct_transact(SCT_CMD_HANDSHAKE, NULL, 0, version, &length) != 0) return -1;
+    version[length] = '\0';
+    return 0;
+}
+
+/* Image is sent as (u32 offset, data) chunks; an empty request asks the
+ * device to verify what it received */
+static int sct_update_firmware(const uint8_t* data, size_t size) {
+    uint8_t payload[SCT_MAX_PAYLOAD];
+    
+    if (!data || size == 0) return -1;
+    sct_stop_monitoring();
+    
+    for (size_t offset = 0; offset < size; offset += SCT_FIRMWARE_CHUNK) {
+        size_t chunk = size - offset < SCT_FIRMWARE_CHUNK ? size - offset : SCT_FIRMWARE_CHUNK;
+        uint32_t wire_offset = (uint32_t)offset;
+        
+        memcpy(payload, &wire_offset, sizeof(wire_offset));
+        memcpy(payload + 4, data + offset, chunk);
+        if (sct_transact(SCT_CMD_FLASH_FIRMWARE, payload, (uint16_t)(chunk + 4), NULL, NULL) != 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT firmware transfer failed at offset %zu", offset);
+            return -1;
+        }
+    }
+    
+    return sct_interface.verify_firmware();
+}
+
+static int sct_verify_firmware(void) {
+    uint8_t result = 0xFF;
+    size_t length = sizeof(result);
+    
+    if (sct_transact(SCT_CMD_FLASH_FIRMWARE, NULL, 0, &result, &length) != 0) return -1;
+    return (length == 1 && result == 0) ? 0 : -1;
+}
+
+/* Connection */
+static int sct_open(const DeviceConfig* config) {
+    switch (config->conn_type) {
+        case CONN_SERIAL:
+        case CONN_USB:
+        case CONN_BLUETOOTH:
+            sct_state.emulated = 0;
+            return device_serial_open(config->conn_config.port, config->conn_config.baudrate);
+            
+        case CONN_DEMO: {
+            int fd;
+            if (sct_emulator_start(&fd) != 0) return -1;
+            sct_state.emulated = 1;
+            return fd;
+        }
+            
+        default:
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Unsupported SCT connection type: %d", config->conn_type);
+            return -1;
+    }
+}
+
+static int sct_disconnect(void) {
+    if (sct_state.fd < 0) return 0;
+    
+    sct_stop_monitoring();
+    close(sct_state.fd);
+    sct_state.fd = -1;
+    
+    if (sct_state.emulated) {
+        sct_emulator_stop();
+        sct_state.emulated = 0;
+    }
+    return 0;
+}
+
+static int sct_get_status(uint8_t* status) {
+    if (!status) return -1;
+    *status = sct_state.fd >= 0 ? 1 : 0;
+    return 0;
+}
 
 /* Initialize SCT device interface */
-int sct_init_device(const DeviceConfig* config) {
-    current_config = (DeviceConfig*)config;
+static int sct_init_device(const DeviceConfig* config) {
+    if (!config) return -1;
     
-    /* Initialize SCT protocol */
-    if (sct_test_communication() != 0) {
-        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to initialize SCT device");
+    sct_disconnect();
+    sct_state.config = *config;
+    sct_state.timeout_ms = config->conn_config.timeout_ms ?
+                           config->conn_config.timeout_ms : SCT_DEFAULT_TIMEOUT_MS;
+    sct_state.sequence = 0;
+    sct_state.sample_rate = 0;
+    
+    sct_state.fd = sct_open(config);
+    if (sct_state.fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to open SCT device");
         return -1;
     }
     
-    /* Check device compatibility */
+    /* Check device compatibility, the handshake doubles as link test */
     if (sct_check_compatibility() != 0) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT device compatibility check failed");
+        sct_disconnect();
+        return -1;
+    }
+    
+    /* Initialize SCT protocol */
+    if (sct_test_communication() != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to initialize SCT device");
+        sct_disconnect();
         return -1;
     }
     
     /* Setup monitoring system if enabled */
     if (config->device_config.sct.high_speed_logging) {
-        if (sct_interface.start_monitoring(config->device_config.sct.max_sample_rate) != 0) {
+        uint32_t rate = config->device_config.sct.max_sample_rate;
+        if (rate == 0 || rate > UINT16_MAX ||
+            sct_interface.start_monitoring((uint16_t)rate) != 0) {
             DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to start SCT monitoring");
+            sct_disconnect();
             return -1;
         }
     }
     
     /* Initialize safety systems if enabled */
     if (config->device_config.sct.safety_features) {
-        size_t limits_size;
         uint8_t default_limits[256];
+        size_t limits_size = sizeof(default_limits);
         
         if (sct_interface.get_safety_limits(default_limits, &limits_size) == 0) {
             if (sct_interface.set_safety_limits(default_limits, limits_size) != 0) {
                 DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to initialize SCT safety systems");
+                sct_disconnect();
                 return -1;
             }
         }
@@ -74,7 +538,8 @@ int sct_check_compatibility(void) {
     }
     
     /* Check minimum required version */
-    if (major < 2 || (major == 2 && minor < 9)) {
+    if (major < SCT_MIN_FIRMWARE_MAJOR ||
+        (major == SCT_MIN_FIRMWARE_MAJOR && minor < SCT_MIN_FIRMWARE_MINOR)) {
         DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT firmware version too old");
         return -1;
     }
@@ -92,8 +557,8 @@ int sct_verify_tuning(void) {
     }
     
     /* Verify tuning parameters */
-    if (verify_fuel_parameters(&tuning.fuelManagement) != 0 ||
-        verify_boost_parameters(&tuning.boostControl) != 0) {
+    if (verify_fuel_parameters(&tuning) != 0 ||
+        verify_boost_parameters(&tuning) != 0) {
         return -1;
     }
     
@@ -102,46 +567,96 @@ int sct_verify_tuning(void) {
 
 /* Check logging system status */
 int sct_check_logging_status(void) {
-    void* buffer;
+    static SCTSample slots[256];
+    SCTSampleRing ring = { .slots = slots, .capacity = 256 };
     size_t size;
     
     /* Try to get monitoring data */
-    if (sct_interface.get_monitoring_data(&buffer, &size) != 0) {
+    if (sct_interface.get_monitoring_data(&ring, &size) != 0 || size == 0) {
         return -1;
     }
     
     return 0;
 }
 
+int sct_run_diagnostics(void) {
+    int status = 0;
+    
+    if (sct_check_compatibility() != 0) status = -1;
+    if (sct_test_communication() != 0) status = -1;
+    if (sct_verify_tuning() != 0) status = -1;
+    if (sct_state.sample_rate && sct_check_logging_status() != 0) status = -1;
+    
+    return status;
+}
+
 /* Internal verification functions */
-static int verify_fuel_parameters(const struct FuelManagement* fuel) {
+static int verify_fuel_parameters(const SCTAdvancedTuning* tuning) {
     /* Check VE table values */
     for (int i = 0; i < 24; i++) {
-        if (fuel->volumetricEfficiency[i] < 0.0f || 
-            fuel->volumetricEfficiency[i] > 2.0f) {
+        if (tuning->fuelManagement.volumetricEfficiency[i] < 0.0f || 
+            tuning->fuelManagement.volumetricEfficiency[i] > 2.0f) {
             return -1;
         }
     }
     
     /* Check AFR targets */
-    if (fuel->afrTargets.idle < 10.0f || fuel->afrTargets.idle > 20.0f ||
-        fuel->afrTargets.wot < 10.0f || fuel->afrTargets.wot > 15.0f) {
+    if (tuning->fuelManagement.afrTargets.idle < 10.0f ||
+        tuning->fuelManagement.afrTargets.idle > 20.0f ||
+        tuning->fuelManagement.afrTargets.wot < 10.0f ||
+        tuning->fuelManagement.afrTargets.wot > 15.0f) {
         return -1;
     }
     
     return 0;
 }
 
-static int verify_boost_parameters(const struct BoostControl* boost) {
+static int verify_boost_parameters(const SCTAdvancedTuning* tuning) {
     /* Check boost limits */
-    if (boost->maxBoost > 60.0f || boost->targetBoost > boost->maxBoost) {
+    if (tuning->boostControl.maxBoost > 60.0f ||
+        tuning->boostControl.targetBoost > tuning->boostControl.maxBoost) {
         return -1;
     }
     
     /* Check safety thresholds */
-    if (boost->safety.cutThreshold <= boost->safety.resumeThreshold) {
+    if (tuning->boostControl.safety.cutThreshold <= tuning->boostControl.safety.resumeThreshold) {
         return -1;
     }
     
     return 0;
 }
+
+/* Interface tables */
+static SCTDeviceInterface sct_interface = {
+    .init = sct_init_device,
+    .get_parameters = sct_get_parameters,
+    .set_parameters = sct_set_parameters,
+    .get_advanced_tuning = sct_get_advanced_tuning,
+    .set_advanced_tuning = sct_set_advanced_tuning,
+    .save_tuning_profile = sct_save_tuning_profile,
+    .load_tuning_profile = sct_load_tuning_profile,
+    .start_monitoring = sct_start_monitoring,
+    .stop_monitoring = sct_stop_monitoring,
+    .get_monitoring_data = sct_get_monitoring_data,
+    .get_safety_limits = sct_get_safety_limits,
+    .set_safety_limits = sct_set_safety_limits,
+    .check_safety_status = sct_check_safety_status,
+    .handle_safety_event = sct_handle_safety_event,
+    .check_firmware_version = sct_check_firmware_version,
+    .update_firmware = sct_update_firmware,
+    .verify_firmware = sct_verify_firmware,
+};
+
+static DeviceInterface sct_device_interface = {
+    .init = sct_init_device,
+    .disconnect = sct_disconnect,
+    .get_status = sct_get_status,
+};
+
+SCTDeviceInterface* get_sct_interface(void) {
+    return &sct_interface;
+}
+
+DeviceInterface* sct_get_device_interface(void) {
+    return &sct_device_interface;
+}
@@ -0,0 +1,345 @@
+#include "sct_emulator.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#define SCT_EMU_TICK_MS         5
+#define SCT_EMU_SAMPLES_PER_FRAME (SCT_MAX_PAYLOAD / sizeof(SCTSample))
+
+static struct {
+    int fd;                          // Device end of the socketpair
+    pthread_t thread;
+    volatile int running;
+    
+    /* Device model */
+    SCTParameters params;
+    SCTAdvancedTuning tuning;
+    uint8_t safety_limits[64];
+    uint16_t safety_limits_len;
+    uint32_t firmware_bytes;         // Received by FLASH_FIRMWARE
+    
+    /* Logging */
+    uint16_t sample_rate;            // 0 = not logging
+    uint64_t samples_sent;
+    struct timespec logging_start;
+    uint32_t stream_sequence;
+    
+    uint8_t payload[SCT_MAX_PAYLOAD];
+} emu = { .fd = -1 };
+
+static double emu_elapsed(const struct timespec* since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - since->tv_sec) +
+           (double)(now.tv_nsec - since->tv_nsec) / 1e9;
+}
+
+static int emu_read_exact(void* buf, size_t len) {
+    uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = read(emu.fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int emu_send(uint8_t command, uint32_t sequence, uint8_t flags,
+                    const void* payload, uint16_t length) {
+    SCTPacketHeader header = {
+        .version = SCT_PROTOCOL_VERSION,
+        .command = command,
+        .length = length,
+        .sequence = sequence,
+        .flags = flags
+    };
+    struct iovec iov[2] = {
+        { &header, sizeof(header) },
+        { (void*)payload, length }
+    };
+    size_t total = sizeof(header) + length;
+    
+    while (total > 0) {
+        ssize_t n = writev(emu.fd, iov, length ? 2 : 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        total -= (size_t)n;
+        
+        // Partial write: advance the iovecs and retry
+        for (int i = 0; i < 2 && n > 0; i++) {
+            size_t step = (size_t)n < iov[i].iov_len ? (size_t)n : iov[i].iov_len;
+            iov[i].iov_base = (uint8_t*)iov[i].iov_base + step;
+            iov[i].iov_len -= step;
+            n -= (ssize_t)step;
+        }
+    }
+    return 0;
+}
+
+static void emu_fill_sample(SCTSample* sample, uint64_t index) {
+    double t = (double)index / emu.sample_rate;
+    
+    sample->timestamp_us = (uint32_t)(index * 1000000ULL / emu.sample_rate);
+    sample->flags = 0;
+    sample->params = emu.params;
+    sample->params.engineRPM = (uint16_t)(3000 + 2200 * sin(t * 0.8));
+    sample->params.throttlePosition = (uint16_t)(50 + 45 * sin(t * 0.8));
+    sample->params.boostPressure = (uint16_t)(120 + 100 * sin(t * 0.8));
+}
+
+/* Emit every sample that is due since logging started */
+static int emu_stream(void) {
+    uint64_t due = (uint64_t)(emu_elapsed(&emu.logging_start) * emu.sample_rate);
+    
+    while (emu.samples_sent < due) {
+        SCTSample* samples = (SCTSample*)emu.payload;
+        uint64_t count = due - emu.samples_sent;
+        if (count > SCT_EMU_SAMPLES_PER_FRAME) count = SCT_EMU_SAMPLES_PER_FRAME;
+        
+        for (uint64_t i = 0; i < count; i++) {
+            emu_fill_sample(&samples[i], emu.samples_sent + i);
+        }
+        if (emu_send(SCT_CMD_START_LOGGING, emu.stream_sequence++, SCT_FLAG_STREAM,
+                     samples, (uint16_t)(count * sizeof(SCTSample))) != 0) {
+            return -1;
+        }
+        emu.samples_sent += count;
+    }
+    return 0;
+}
+
+static int emu_handle(const SCTPacketHeader* req, const uint8_t* payload) {
+    uint8_t reply[SCT_MAX_PAYLOAD];
+    uint16_t reply_len = 0;
+    uint8_t flags = SCT_FLAG_RESPONSE;
+    uint8_t page = req->length > 0 ? payload[0] : 0xFF;
+    
+    switch (req->command) {
+        case SCT_CMD_HANDSHAKE:
+            reply_len = (uint16_t)(strlen(SCT_EMULATOR_FIRMWARE) + 1);
+            memcpy(reply, SCT_EMULATOR_FIRMWARE, reply_len);
+            break;
+            
+        case SCT_CMD_READ_TUNE:
+            memcpy(reply, &emu.tuning, sizeof(emu.tuning));
+            reply_len = sizeof(emu.tuning);
+            break;
+            
+        case SCT_CMD_WRITE_TUNE:
+            if (req->length != sizeof(emu.tuning)) {
+                flags |= SCT_FLAG_ERROR;
+                break;
+            }
+            memcpy(&emu.tuning, payload, sizeof(emu.tuning));
+            break;
+            
+        case SCT_CMD_READ_PARAMS:
+            if (page == SCT_PAGE_LIVE) {
+                memcpy(reply, &emu.params, sizeof(emu.params));
+                reply_len = sizeof(emu.params);
+            } else if (page == SCT_PAGE_SAFETY_LIMITS) {
+                memcpy(reply, emu.safety_limits, emu.safety_limits_len);
+                reply_len = emu.safety_limits_len;
+            } else if (page == SCT_PAGE_SAFETY_STATUS) {
+                memset(reply, 0, 5);   // OK, no pending event
+                reply_len = 5;
+            } else {
+                flags |= SCT_FLAG_ERROR;
+            }
+            break;
+            
+        case SCT_CMD_WRITE_PARAMS:
+            if (page == SCT_PAGE_LIVE && req->length == 1 + sizeof(emu.params)) {
+                memcpy(&emu.params, payload + 1, sizeof(emu.params));
+            } else if (page == SCT_PAGE_SAFETY_LIMITS &&
+                       req->length - 1u <= sizeof(emu.safety_limits)) {
+                emu.safety_limits_len = (uint16_t)(req->length - 1);
+                memcpy(emu.safety_limits, payload + 1, emu.safety_limits_len);
+            } else if (page != SCT_PAGE_SAFETY_STATUS) {
+                flags |= SCT_FLAG_ERROR;
+            }
+            break;
+            
+        case SCT_CMD_START_LOGGING:
+            if (req->length < 2) {
+                flags |= SCT_FLAG_ERROR;
+                break;
+            }
+            memcpy(&emu.sample_rate, payload, sizeof(emu.sample_rate));
+            emu.samples_sent = 0;
+            clock_gettime(CLOCK_MONOTONIC, &emu.logging_start);
+            break;
+            
+        case SCT_CMD_STOP_LOGGING:
+            emu.sample_rate = 0;
+            break;
+            
+        case SCT_CMD_FLASH_FIRMWARE:
+            // Empty payload asks for the verification result
+            if (req->length > 4) {
+                emu.firmware_bytes += req->length - 4u;
+            } else {
+                reply[0] = emu.firmware_bytes > 0 ? 0 : 1;
+                reply_len = 1;
+            }
+            break;
+            
+        default:
+            flags |= SCT_FLAG_ERROR;
+            break;
+    }
+    
+    return emu_send(req->command, req->sequence, flags, reply, reply_len);
+}
+
+static void* emu_thread(void* arg) {
+    (void)arg;
+    
+    while (emu.running) {
+        struct pollfd pfd = { .fd = emu.fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, emu.sample_rate ? SCT_EMU_TICK_MS : 50);
+        if (ready < 0 && errno != EINTR) break;
+        
+        if (ready > 0) {
+            if (pfd.revents & (POLLHUP | POLLERR)) break;
+            
+            SCTPacketHeader req;
+            if (emu_read_exact(&req, sizeof(req)) != 0) break;
+            if (req.length > SCT_MAX_PAYLOAD ||
+                (req.length && emu_read_exact(emu.payload, req.length) != 0)) {
+                break;
+            }
+            if (req.version != SCT_PROTOCOL_VERSION) continue;
+            if (emu_handle(&req, emu.payload) != 0) break;
+        }
+        
+        if (emu.sample_rate && emu_stream() != 0) break;
+    }
+    
+    emu.running = 0;
+    return NULL;
+}
+
+int sct_emulator_start(int* host_fd) {
+    int fds[2];
+    
+    if (!host_fd || emu.running) return -1;
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT emulator socketpair failed: %s", strerror(errno));
+        return -1;
+    }
+    
+    memset(&emu.params, 0, sizeof(emu.params));
+    memset(&emu.tuning, 0, sizeof(emu.tuning));
+    for (int i = 0; i < 24; i++) {
+        emu.tuning.fuelManagement.volumetricEfficiency[i] = 0.85f;
+    }
+    emu.tuning.fuelManagement.injectorScaling = 1.0f;
+    emu.tuning.fuelManagement.afrTargets.idle = 14.7f;
+    emu.tuning.fuelManagement.afrTargets.cruise = 14.3f;
+    emu.tuning.fuelManagement.afrTargets.wot = 12.5f;
+    emu.tuning.fuelManagement.afrTargets.acceleration = 12.0f;
+    emu.tuning.fuelManagement.afrTargets.deceleration = 15.0f;
+    emu.tuning.boostControl.maxBoost = 22.0f;
+    emu.tuning.boostControl.targetBoost = 18.0f;
+    emu.tuning.boostControl.safety.cutThreshold = 24.0f;
+    emu.tuning.boostControl.safety.resumeThreshold = 20.0f;
+    emu.safety_limits_len = 16;
+    memset(emu.safety_limits, 0, sizeof(emu.safety_limits));
+    emu.firmware_bytes = 0;
+    emu.sample_rate = 0;
+    emu.stream_sequence = 0;
+    
+    emu.fd = fds[0];
+    emu.running = 1;
+    if (pthread_create(&emu.thread, NULL, emu_thread, NULL) != 0) {
+        emu.running = 0;
+        close(fds[0]);
+        close(fds[1]);
+        emu.fd = -1;
+        return -1;
+    }
+    
+    *host_fd = fds[1];
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "SCT emulator running, firmware %s", SCT_EMULATOR_FIRMWARE);
+    return 0;
+}
+
+void sct_emulator_stop(void) {
+    if (emu.fd < 0) return;
+    
+    emu.running = 0;
+    shutdown(emu.fd, SHUT_RDWR);
+    pthread_join(emu.thread, NULL);
+    close(emu.fd);
+    emu.fd = -1;
+}
+
+int sct_emulator_self_test(uint16_t sample_rate, uint32_t duration_ms) {
+    static SCTSample slots[4096];
+    SCTSampleRing ring = { .slots = slots, .capacity = 4096 };
+    DeviceConfig config;
+    
+    memset(&config, 0, sizeof(config));
+    config.type = DEVICE_SCT;
+    config.conn_type = CONN_DEMO;
+    config.conn_config.timeout_ms = 500;
+    config.device_config.sct.max_sample_rate = sample_rate;
+    config.device_config.sct.high_speed_logging = true;
+    
+    DeviceInterface* device = sct_get_device_interface();
+    SCTDeviceInterface* sct = get_sct_interface();
+    if (device->init(&config) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT emulator: init failed");
+        return -1;
+    }
+    
+    uint32_t period_us = 1000000u / sample_rate;
+    uint64_t received = 0;
+    uint32_t gaps = 0;
+    uint32_t last_ts = 0;
+    int status = 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    while (emu_elapsed(&start) * 1000.0 < duration_ms) {
+        size_t added = 0;
+        if (sct->get_monitoring_data(&ring, &added) != 0) {
+            status = -1;
+            break;
+        }
+        
+        // Consume in place, samples are never copied out of the ring
+        for (; ring.tail != ring.head; ring.tail++) {
+            const SCTSample* sample = &ring.slots[ring.tail & (ring.capacity - 1)];
+            uint32_t delta = sample->timestamp_us - last_ts;
+            if (received > 0 && (delta < period_us || delta > period_us + 1)) gaps++;
+            last_ts = sample->timestamp_us;
+            received++;
+        }
+    }
+    
+    double elapsed = emu_elapsed(&start);
+    sct->stop_monitoring();
+    device->disconnect();
+    
+    double expected = elapsed * sample_rate;
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "SCT emulator: %llu samples in %.2f s (expected %.0f), "
+                "%u gaps, %u dropped", (unsigned long long)received, elapsed,
+                expected, gaps, ring.dropped);
+    
+    if (status != 0 || gaps > 0 || ring.dropped > 0 || received < expected * 0.9) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "SCT emulator streaming check failed");
+        return -1;
+    }
+    return 0;
+}
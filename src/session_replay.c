@@ -0,0 +1,742 @@
+#include "session_replay.h"
+#include "column_log.h"
+#include "csv_import.h"
+#include "log_template.h"
+#include "realtime_monitor.h"
+#include "timebase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stddef.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define KMH_PER_MPH        1.609344f
+#define KPA_PER_PSI        6.894757f
+#define ATMOSPHERE_KPA     101.325f
+
+/* Mode 01 scaling, physical = raw * factor + offset (SAE J1979). PIDs
+ * not listed are sent as their raw first byte, as the monitor reads them. */
+typedef struct {
+    uint8_t pid;
+    float factor;
+    float offset;
+} PidScaling;
+
+static const PidScaling pid_scalings[] = {
+    { 0x04, 100.0f / 255.0f, 0.0f },     // Calculated load, %
+    { 0x05, 1.0f, -40.0f },              // Coolant, C
+    { 0x06, 100.0f / 128.0f, -100.0f },  // Fuel trims, %
+    { 0x07, 100.0f / 128.0f, -100.0f },
+    { 0x08, 100.0f / 128.0f, -100.0f },
+    { 0x09, 100.0f / 128.0f, -100.0f },
+    { 0x0A, 3.0f, 0.0f },                // Fuel pressure, kPa
+    { 0x0B, 1.0f, 0.0f },                // Manifold pressure, kPa
+    { 0x0C, 0.25f, 0.0f },               // RPM
+    { 0x0D, 1.0f, 0.0f },                // Speed, km/h
+    { 0x0E, 0.5f, -64.0f },              // Timing advance, degrees
+    { 0x0F, 1.0f, -40.0f },              // Intake air, C
+    { 0x10, 0.01f, 0.0f },               // MAF, g/s
+    { 0x11, 100.0f / 255.0f, 0.0f },     // Throttle, %
+    { 0x1F, 1.0f, 0.0f },                // Run time, s
+    { 0x2F, 100.0f / 255.0f, 0.0f },     // Fuel level, %
+    { 0x33, 1.0f, 0.0f },                // Barometric pressure, kPa
+    { 0x42, 0.001f, 0.0f },              // Module voltage, V
+    { 0x46, 1.0f, -40.0f },              // Ambient air, C
+    { 0x5C, 1.0f, -40.0f }               // Oil temperature, C
+};
+
+/* Log channel names from the performance, telemetry and MAUI loggers */
+static const struct {
+    const char* name;
+    uint8_t pid;
+} named_pids[] = {
+    { "RPM", 0x0C }, { "Speed", 0x0D }, { "Vehicle Speed", 0x0D }, { "TPS", 0x11 },
+    { "Throttle", 0x11 }, { "IAT", 0x0F }, { "Intake", 0x0F }, { "MAF", 0x10 },
+    { "Load", 0x04 }, { "Coolant", 0x05 }, { "MAP", 0x0B }, { "Boost", 0x0B },
+    { "Timing", 0x0E }
+};
+
+/* PerformanceData fields filled from PID values (in PID units) */
+static const struct {
+    uint8_t pid;
+    size_t field;
+    float factor;
+    float offset;
+} pid_fields[] = {
+    { 0x0C, offsetof(PerformanceData, engine_rpm), 1.0f, 0.0f },
+    { 0x0D, offsetof(PerformanceData, vehicle_speed), 1.0f / KMH_PER_MPH, 0.0f },
+    { 0x11, offsetof(PerformanceData, throttle_position), 1.0f, 0.0f },
+    { 0x0F, offsetof(PerformanceData, intake_air_temp), 1.0f, 0.0f },
+    { 0x10, offsetof(PerformanceData, maf_scaled), 1.0f, 0.0f },
+    { 0x05, offsetof(PerformanceData, coolant_temp), 1.0f, 0.0f },
+    { 0x0B, offsetof(PerformanceData, boost_pressure), 1.0f / KPA_PER_PSI, -ATMOSPHERE_KPA / KPA_PER_PSI }
+};
+
+/* ...and from channels with no PID, as recorded */
+static const struct {
+    const char* name;
+    size_t field;
+} named_fields[] = {
+    { "VE", offsetof(PerformanceData, volumetric_efficiency) },
+    { "Torque", offsetof(PerformanceData, torque_actual) },
+    { "AFR", offsetof(PerformanceData, air_fuel_ratio) },
+    { "G-Force", offsetof(PerformanceData, acceleration) },
+    { "g_force", offsetof(PerformanceData, acceleration) },
+    { "Acceleration", offsetof(PerformanceData, acceleration) },
+    { "Oil Pressure", offsetof(PerformanceData, oil_pressure) },
+    { "Fuel Pressure", offsetof(PerformanceData, fuel_pressure) }
+};
+
+#define REPLAY_NO_FIELD ((size_t)-1)
+
+/* Replayed channel: a source column, the PID it answers and how its
+ * recorded unit converts to the PID's */
+typedef struct {
+    size_t source;             // Column in the log or import
+    int16_t pid;               // CHANNEL_NO_PID when only in PerformanceData
+    float factor;              // Recorded to PID units
+    float offset;
+    size_t field;              // PerformanceData field for unmapped channels
+} ReplayChannel;
+
+static struct {
+    pthread_mutex_t lock;      // Device reads against seek and speed changes
+    uint8_t open;
+    float speed;
+    ColumnLogReader* reader;   // .clog source
+    ColumnLogIterator* iter;
+    CsvImport* import;         // CSV source, held in memory
+    ReplayChannel channels[SESSION_REPLAY_MAX_CHANNELS];
+    size_t channel_count;
+    size_t pid_count;
+    uint8_t pids[SESSION_REPLAY_MAX_CHANNELS];
+    const uint64_t* run_timestamps; // Rows read but not yet replayed
+    const float* const* run_columns;
+    const float* import_columns[SESSION_REPLAY_MAX_CHANNELS];
+    size_t run_rows;
+    size_t run_next;
+    float held[SESSION_REPLAY_MAX_CHANNELS]; // Last value of each channel, NaN before one
+    uint64_t held_at;          // Recorded time of the last row replayed
+    uint64_t first_us;         // Recorded time of the first and last rows
+    uint64_t last_us;
+    uint64_t segment_us;       // Recorded time the current stretch started from
+    uint64_t origin_us;        // Timebase time that stretch is stamped from
+    uint64_t stamped_us;       // Last stamp given, stamps never go back
+    uint64_t clock_position_us; // Timed replay: position at clock_base_us
+    uint64_t clock_base_us;
+    uint64_t rows;
+    uint8_t finished;
+} replay_state = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* Channel mapping */
+static const PidScaling* pid_scaling(uint8_t pid) {
+    for (size_t i = 0; i < sizeof(pid_scalings) / sizeof(pid_scalings[0]); i++) {
+        if (pid_scalings[i].pid == pid) return &pid_scalings[i];
+    }
+    return NULL;
+}
+
+static int channel_pid(const ColumnLogChannel* channel, const LogTemplate* tmpl) {
+    unsigned pid;
+    char tail;
+    
+    int index = log_template_find(tmpl, channel->name);
+    if (index >= 0) return tmpl->channels[index].pid;
+    if (sscanf(channel->name, "PID_%2x%c", &pid, &tail) == 1) return (int)pid;
+    for (size_t i = 0; i < sizeof(named_pids) / sizeof(named_pids[0]); i++) {
+        if (strcasecmp(channel->name, named_pids[i].name) == 0) return named_pids[i].pid;
+    }
+    return CHANNEL_NO_PID;
+}
+
+static size_t channel_field(const ColumnLogChannel* channel) {
+    for (size_t i = 0; i < sizeof(named_fields) / sizeof(named_fields[0]); i++) {
+        if (strcasecmp(channel->name, named_fields[i].name) == 0) return named_fields[i].field;
+    }
+    return REPLAY_NO_FIELD;
+}
+
+/* Recorded units the PIDs don't use: mph, Fahrenheit, psi of boost */
+static void channel_conversion(ReplayChannel* replay, const ColumnLogChannel* channel) {
+    const char* unit = channel->unit;
+    size_t length = strlen(unit);
+    
+    replay->factor = 1.0f;
+    replay->offset = 0.0f;
+    if (strcasecmp(unit, "mph") == 0) {
+        replay->factor = KMH_PER_MPH;
+    } else if (length && unit[length - 1] == 'F' && (length == 1 || (unit[length - 2] & 0x80))) {
+        replay->factor = 1.0f / 1.8f;
+        replay->offset = -32.0f / 1.8f;
+    } else if (replay->pid == 0x0B && strcasecmp(unit, "psi") == 0) {
+        replay->factor = KPA_PER_PSI;
+        replay->offset = ATMOSPHERE_KPA;
+    }
+}
+
+static int map_channels(const ColumnLogChannel* (*channel_at)(size_t), size_t count,
+                        const char* template_path) {
+    LogTemplate* tmpl = NULL;
+    if (template_path && template_path[0]) {
+        tmpl = log_template_load(template_path);
+        if (!tmpl) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to load channel template %s", template_path);
+            return -1;
+        }
+    }
+    
+    replay_state.channel_count = 0;
+    replay_state.pid_count = 0;
+    for (size_t c = 0; c < count && replay_state.channel_count < SESSION_REPLAY_MAX_CHANNELS; c++) {
+        const ColumnLogChannel* channel = channel_at(c);
+        ReplayChannel* replay = &replay_state.channels[replay_state.channel_count];
+        replay->source = c;
+        replay->pid = (int16_t)channel_pid(channel, tmpl);
+        replay->field = REPLAY_NO_FIELD;
+    
+        // The first channel for a PID answers it, e.g. MAP before Boost
+        for (size_t p = 0; replay->pid != CHANNEL_NO_PID && p < replay_state.pid_count; p++) {
+            if (replay_state.pids[p] == replay->pid) replay->pid = CHANNEL_NO_PID;
+        }
+        if (replay->pid == CHANNEL_NO_PID) {
+            replay->field = channel_field(channel);
+            if (replay->field == REPLAY_NO_FIELD) continue;
+        } else {
+            replay_state.pids[replay_state.pid_count++] = (uint8_t)replay->pid;
+        }
+        channel_conversion(replay, channel);
+        replay_state.channel_count++;
+    }
+    
+    log_template_free(tmpl);
+    if (replay_state.pid_count == 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "No channel in the recording maps to a PID");
+        return -1;
+    }
+    return 0;
+}
+
+static const ColumnLogChannel* reader_channel(size_t index) {
+    return column_log_channel(replay_state.reader, index);
+}
+
+static const ColumnLogChannel* import_channel(size_t index) {
+    return &replay_state.import->channels[index];
+}
+
+/* Row source: iterator runs over a log, or one run over an import */
+static int replay_start_at(uint64_t t) {
+    replay_state.run_rows = 0;
+    replay_state.run_next = 0;
+    
+    if (replay_state.reader) {
+        size_t sources[SESSION_REPLAY_MAX_CHANNELS];
+        for (size_t c = 0; c < replay_state.channel_count; c++) {
+            sources[c] = replay_state.channels[c].source;
+        }
+        column_log_iter_close(replay_state.iter);
+        replay_state.iter = column_log_iter_open(replay_state.reader, t, UINT64_MAX, sources,
+                                                 replay_state.channel_count);
+        return replay_state.iter ? 0 : -1;
+    }
+    
+    const CsvImport* import = replay_state.import;
+    size_t low = 0, high = import->rows;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (import->timestamps[mid] < t) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (size_t c = 0; c < replay_state.channel_count; c++) {
+        replay_state.import_columns[c] = import->columns[replay_state.channels[c].source] + low;
+    }
+    replay_state.run_timestamps = import->timestamps + low;
+    replay_state.run_columns = replay_state.import_columns;
+    replay_state.run_rows = import->rows - low;
+    return 0;
+}
+
+static int replay_has_row(void) {
+    if (replay_state.run_next < replay_state.run_rows) return 1;
+    if (!replay_state.iter) return 0;
+    
+    replay_state.run_next = 0;
+    replay_state.run_rows = column_log_iter_next(replay_state.iter, &replay_state.run_timestamps,
+                                                 &replay_state.run_columns);
+    return replay_state.run_rows > 0;
+}
+
+static void replay_take_row(void) {
+    size_t row = replay_state.run_next++;
+    for (size_t c = 0; c < replay_state.channel_count; c++) {
+        float value = replay_state.run_columns[c][row];
+        if (!isnan(value)) replay_state.held[c] = value;
+    }
+    replay_state.held_at = replay_state.run_timestamps[row];
+    replay_state.rows++;
+}
+
+/* Timed replay: position on the recording from the timebase */
+static uint64_t replay_clock_position(void) {
+    uint64_t elapsed = timebase_now_us() - replay_state.clock_base_us;
+    return replay_state.clock_position_us + (uint64_t)((double)elapsed * replay_state.speed);
+}
+
+/* Brings the held values up to now, or one row on at full speed.
+ * Under lock. Returns -1 once the recording is exhausted. */
+static int replay_advance(void) {
+    if (replay_state.finished) return -1;
+    
+    if (replay_state.speed <= SESSION_REPLAY_FASTEST) {
+        if (!replay_has_row()) {
+            replay_state.finished = 1;
+            return -1;
+        }
+        replay_take_row();
+        return 0;
+    }
+    
+    uint64_t target = replay_state.first_us + replay_clock_position();
+    while (replay_has_row() && replay_state.run_timestamps[replay_state.run_next] <= target) {
+        replay_take_row();
+    }
+    if (target > replay_state.last_us && !replay_has_row()) replay_state.finished = 1;
+    return 0;
+}
+
+static uint64_t replay_stamp(void) {
+    uint64_t stamp = replay_state.origin_us;
+    if (replay_state.held_at > replay_state.segment_us) {
+        stamp += replay_state.held_at - replay_state.segment_us;
+    }
+    if (stamp <= replay_state.stamped_us) stamp = replay_state.stamped_us + 1;
+    replay_state.stamped_us = stamp;
+    return stamp;
+}
+
+/* Physical to raw, big-endian as the ECU sends it */
+static int replay_encode(uint8_t pid, float value, uint8_t* data, size_t size) {
+    uint8_t length = obd2_pid_data_length(pid);
+    if (length == 0 || length > size) return -1;
+    
+    const PidScaling* scaling = pid_scaling(pid);
+    double raw = scaling ? (value - scaling->offset) / scaling->factor : value;
+    double max = length == 1 ? 255.0 : 65535.0;
+    raw = raw < 0.0 ? 0.0 : (raw > max ? max : floor(raw + 0.5));
+    
+    memset(data, 0, length);
+    uint32_t bits = (uint32_t)raw;
+    if (length == 1 || !scaling) {
+        data[0] = (uint8_t)bits;
+    } else {
+        data[0] = (uint8_t)(bits >> 8);
+        data[1] = (uint8_t)bits;
+    }
+    return length;
+}
+
+static int replay_value(uint8_t pid, float* value) {
+    for (size_t c = 0; c < replay_state.channel_count; c++) {
+        const ReplayChannel* channel = &replay_state.channels[c];
+        if (channel->pid != pid) continue;
+        if (isnan(replay_state.held[c])) return -1;
+        *value = replay_state.held[c] * channel->factor + channel->offset;
+        return 0;
+    }
+    return -1;
+}
+
+/* Device backend */
+static int replay_device_init(const DeviceConfig* config) {
+    (void)config;
+    if (!replay_state.open) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Replay device selected with no recording open");
+        return -1;
+    }
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "Initializing replay device");
+    return 0;
+}
+
+static int replay_read_pid_locked(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length) {
+    if (mode == OBD_MODE_READ_TROUBLE_CODES) {
+        *length = 0;   // Recordings carry no codes
+        return 0;
+    }
+    
+    float value;
+    if (mode != OBD_MODE_SHOW_CURRENT_DATA || replay_value(pid, &value) != 0) return -1;
+    int size = replay_encode(pid, value, data, *length);
+    if (size < 0) return -1;
+    *length = (size_t)size;
+    return 0;
+}
+
+static int replay_read_pid(uint8_t mode, uint8_t pid, uint8_t* data, size_t* length) {
+    if (!data || !length) return -1;
+    
+    pthread_mutex_lock(&replay_state.lock);
+    int status = -1;
+    if (replay_state.open && !replay_state.finished) {
+        // A single read only moves a timed replay; full speed moves per batch
+        if (replay_state.speed > SESSION_REPLAY_FASTEST) replay_advance();
+        status = replay_read_pid_locked(mode, pid, data, length);
+    }
+    pthread_mutex_unlock(&replay_state.lock);
+    return status;
+}
+
+static int replay_read_pids(const PIDQuery* queries, PIDResult* results, size_t count) {
+    if (!queries || !results || count > DEVICE_MAX_BATCH) return -1;
+    
+    pthread_mutex_lock(&replay_state.lock);
+    int decoded = 0;
+    int live = replay_state.open && replay_advance() == 0;
+    uint64_t stamp = live ? replay_stamp() : 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = sizeof(results[i].data);
+        results[i].status = live ? replay_read_pid_locked(queries[i].mode, (uint8_t)queries[i].pid,
+                                                          results[i].data, &length) : -1;
+        results[i].length = results[i].status == 0 ? (uint8_t)length : 0;
+        results[i].timestamp_us = results[i].status == 0 ? stamp : 0;
+        if (results[i].status == 0) decoded++;
+    }
+    pthread_mutex_unlock(&replay_state.lock);
+    return decoded;
+}
+
+static int replay_get_performance_data(PerformanceData* data) {
+    if (!data) return -1;
+    
+    pthread_mutex_lock(&replay_state.lock);
+    if (!replay_state.open) {
+        pthread_mutex_unlock(&replay_state.lock);
+        return -1;
+    }
+    if (replay_state.speed > SESSION_REPLAY_FASTEST) replay_advance();
+    
+    memset(data, 0, sizeof(*data));
+    for (size_t c = 0; c < replay_state.channel_count; c++) {
+        const ReplayChannel* channel = &replay_state.channels[c];
+        float value = replay_state.held[c];
+        if (isnan(value)) continue;
+    
+        if (channel->field != REPLAY_NO_FIELD) {
+            *(float*)((char*)data + channel->field) = value;
+            continue;
+        }
+        value = value * channel->factor + channel->offset;
+        for (size_t f = 0; f < sizeof(pid_fields) / sizeof(pid_fields[0]); f++) {
+            if (pid_fields[f].pid == channel->pid) {
+                *(float*)((char*)data + pid_fields[f].field) =
+                    value * pid_fields[f].factor + pid_fields[f].offset;
+            }
+        }
+    }
+    data->boost_actual = data->boost_pressure;
+    data->timestamp_us = replay_state.origin_us + (replay_state.held_at > replay_state.segment_us ?
+                                                   replay_state.held_at - replay_state.segment_us : 0);
+    data->timestamp = (time_t)(timebase_to_wall_us(data->timestamp_us) / 1000000);
+    data->validation.data_valid = replay_state.rows > 0;
+    pthread_mutex_unlock(&replay_state.lock);
+    return 0;
+}
+
+static int replay_get_status(uint8_t* status) {
+    if (!status) return -1;
+    *status = replay_state.open && !replay_state.finished;
+    return 0;
+}
+
+static DeviceInterface replay_interface = {
+    .init = replay_device_init,
+    .get_status = replay_get_status,
+    .read_pid = replay_read_pid,
+    .read_pids = replay_read_pids,
+    .get_performance_data = replay_get_performance_data,
+};
+
+DeviceInterface* session_replay_get_device_interface(void) {
+    return &replay_interface;
+}
+
+/* Replay control */
+static void replay_release(void) {
+    column_log_iter_close(replay_state.iter);
+    column_log_reader_close(replay_state.reader);
+    csv_import_free(replay_state.import);
+    replay_state.iter = NULL;
+    replay_state.reader = NULL;
+    replay_state.import = NULL;
+    replay_state.open = 0;
+}
+
+/* Under lock: restart the stretch of replay at position */
+static int replay_reset(uint64_t position_us) {
+    for (size_t c = 0; c < SESSION_REPLAY_MAX_CHANNELS; c++) replay_state.held[c] = NAN;
+    replay_state.finished = 0;
+    replay_state.segment_us = replay_state.first_us + position_us;
+    replay_state.held_at = replay_state.segment_us;
+    
+    uint64_t now = timebase_now_us();
+    replay_state.origin_us = now > replay_state.stamped_us ? now : replay_state.stamped_us + 1;
+    replay_state.clock_position_us = position_us;
+    replay_state.clock_base_us = now;
+    return replay_start_at(replay_state.segment_us);
+}
+
+int session_replay_open(const char* path, const SessionReplayOptions* options) {
+    if (!path) return -1;
+    
+    session_replay_close();
+    pthread_mutex_lock(&replay_state.lock);
+    const char* template_path = options ? options->channel_template : NULL;
+    int status = -1;
+    
+    if (column_log_is_csv_path(path)) {
+        replay_state.import = csv_import(path, NULL);
+        if (replay_state.import && replay_state.import->rows > 0 &&
+            map_channels(import_channel, replay_state.import->channel_count, template_path) == 0) {
+            replay_state.first_us = replay_state.import->timestamps[0];
+            replay_state.last_us = replay_state.import->timestamps[replay_state.import->rows - 1];
+            status = 0;
+        }
+    } else {
+        replay_state.reader = column_log_open(path);
+        size_t chunks = replay_state.reader ? column_log_chunk_count(replay_state.reader) : 0;
+        ColumnChunkInfo first, last;
+        if (chunks > 0 &&
+            column_log_chunk_info(replay_state.reader, 0, &first) == 0 &&
+            column_log_chunk_info(replay_state.reader, chunks - 1, &last) == 0 &&
+            map_channels(reader_channel, column_log_channel_count(replay_state.reader),
+                         template_path) == 0) {
+            replay_state.first_us = first.t_min;
+            replay_state.last_us = last.t_max;
+            status = 0;
+        }
+    }
+    
+    replay_state.speed = options ? options->speed : 1.0f;
+    replay_state.rows = 0;
+    replay_state.stamped_us = 0;
+    if (status == 0) status = replay_reset(0);
+    if (status == 0) {
+        replay_state.open = 1;
+        DEBUG_PRINT(DEBUG_LEVEL_INFO, "Replaying %s: %zu PIDs, %.1f s at %s", path,
+                    replay_state.pid_count, (replay_state.last_us - replay_state.first_us) / 1e6,
+                    replay_state.speed > SESSION_REPLAY_FASTEST ? "recorded pace" : "full speed");
+    } else {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Cannot replay %s", path);
+        replay_release();
+    }
+    pthread_mutex_unlock(&replay_state.lock);
+    return status;
+}
+
+void session_replay_close(void) {
+    pthread_mutex_lock(&replay_state.lock);
+    replay_release();
+    pthread_mutex_unlock(&replay_state.lock);
+}
+
+int session_replay_seek(uint64_t position_us) {
+    pthread_mutex_lock(&replay_state.lock);
+    int status = -1;
+    if (replay_state.open) {
+        uint64_t duration = replay_state.last_us - replay_state.first_us;
+        status = replay_reset(position_us < duration ? position_us : duration);
+    }
+    pthread_mutex_unlock(&replay_state.lock);
+    return status;
+}
+
+int session_replay_set_speed(float speed) {
+    if (isnan(speed) || speed < 0.0f) return -1;
+    
+    pthread_mutex_lock(&replay_state.lock);
+    if (replay_state.speed > SESSION_REPLAY_FASTEST) {
+        replay_state.clock_position_us = replay_clock_position();
+    } else {
+        replay_state.clock_position_us = replay_state.held_at - replay_state.first_us;
+    }
+    replay_state.clock_base_us = timebase_now_us();
+    replay_state.speed = speed;
+    pthread_mutex_unlock(&replay_state.lock);
+    return 0;
+}
+
+int session_replay_get_status(SessionReplayStatus* status) {
+    if (!status) return -1;
+    
+    pthread_mutex_lock(&replay_state.lock);
+    if (!replay_state.open) {
+        pthread_mutex_unlock(&replay_state.lock);
+        return -1;
+    }
+    memset(status, 0, sizeof(*status));
+    status->duration_us = replay_state.last_us - replay_state.first_us;
+    status->position_us = replay_state.speed > SESSION_REPLAY_FASTEST ? replay_clock_position() :
+                          replay_state.held_at - replay_state.first_us;
+    if (status->position_us > status->duration_us) status->position_us = status->duration_us;
+    status->rows = replay_state.rows;
+    status->speed = replay_state.speed;
+    status->finished = replay_state.finished;
+    status->pid_count = replay_state.pid_count;
+    memcpy(status->pids, replay_state.pids, replay_state.pid_count);
+    pthread_mutex_unlock(&replay_state.lock);
+    return 0;
+}
+
+/* Benchmark */
+#define REPLAY_BENCH_LOG "replay_bench.clog"
+#define REPLAY_BENCH_OUT "replay_bench_out.clog"
+
+static double bench_elapsed(const struct timespec* t0) {
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0->tv_sec) + (t1.tv_nsec - t0->tv_nsec) * 1e-9;
+}
+
+static void bench_sleep_ms(long ms) {
+    struct timespec delay = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&delay, NULL);
+}
+
+static int bench_wait_finished(double timeout_s) {
+    struct timespec start;
+    SessionReplayStatus status;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (session_replay_get_status(&status) == 0 && !status.finished) {
+        if (bench_elapsed(&start) > timeout_s) return -1;
+        bench_sleep_ms(1);
+    }
+    return 0;
+}
+
+int session_replay_benchmark(size_t rows) {
+    // A monitor-style recording at 100 Hz, one channel a row at half rate
+    static const ColumnLogChannel channels[] = {
+        { "PID_0C", "rpm", COLUMN_TYPE_F32, {0} },
+        { "PID_0D", "km/h", COLUMN_TYPE_F32, {0} },
+        { "PID_05", "C", COLUMN_TYPE_F32, {0} },
+        { "PID_11", "%", COLUMN_TYPE_F32, {0} },
+        { "PID_0F", "C", COLUMN_TYPE_F32, {0} },
+        { "PID_04", "%", COLUMN_TYPE_F32, {0} }
+    };
+    const size_t count = sizeof(channels) / sizeof(channels[0]);
+    if (rows < 200) return -1;
+    
+    ColumnLog* log = column_log_create(REPLAY_BENCH_LOG, channels, count, 0);
+    uint64_t t0 = timebase_now_us();
+    for (size_t r = 0; log && r < rows; r++) {
+        float phase = (float)r * 0.001f;
+        float values[6] = {
+            3000.0f + 2500.0f * sinf(phase), 60.0f + 40.0f * sinf(phase), 90.0f,
+            50.0f + 50.0f * sinf(phase * 3.0f), 30.0f, r % 2 ? NAN : 40.0f
+        };
+        column_log_append(log, t0 + r * 10000, values);
+    }
+    if (!log || column_log_close(log) != 0) {
+        unlink(REPLAY_BENCH_LOG);
+        return -1;
+    }
+    
+    // Full speed through device, decoder, safety rules, events and log
+    SessionReplayOptions options = { .speed = SESSION_REPLAY_FASTEST };
+    DeviceConfig device = { .type = DEVICE_REPLAY };
+    SessionReplayStatus status = {0};
+    if (session_replay_open(REPLAY_BENCH_LOG, &options) != 0 || device_init(&device) != 0 ||
+        session_replay_get_status(&status) != 0) {
+        session_replay_close();
+        unlink(REPLAY_BENCH_LOG);
+        return -1;
+    }
+    int result = 0;
+    
+    MonitorConfig monitor = {
+        .sample_rate_ms = 10,
+        .buffer_size = 1024,
+        .log_to_file = 1,
+        .free_run = 1
+    };
+    snprintf(monitor.log_file, sizeof(monitor.log_file), "%s", REPLAY_BENCH_OUT);
+    monitor.pid_count = status.pid_count;
+    memcpy(monitor.pids, status.pids, status.pid_count);
+    SafetyRule over_rev = {
+        .name = "RPM", .channel = 0, .direction = SAFETY_ABOVE,
+        .trip = 5000.0f, .clear = 4800.0f, .debounce = 2, .flag = 1
+    };
+    
+    struct timespec start;
+    double seconds = 0.0;
+    MonitorStats stats = {0};
+    if (monitor_init(&monitor) == 0 && monitor_set_safety_rules(&over_rev, 1) == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (monitor_start() != 0 || bench_wait_finished(120.0) != 0) result = -1;
+        seconds = bench_elapsed(&start);
+        monitor_stop();
+        monitor_get_stats(&stats);
+        session_replay_get_status(&status);
+    } else {
+        result = -1;
+    }
+    
+    // Every recorded row comes back out of the monitor's log; ticks after
+    // the end log as dropouts
+    ColumnLogReader* reader = result == 0 ? column_log_open(REPLAY_BENCH_OUT) : NULL;
+    size_t logged = 0;
+    float first_rpm = NAN;
+    for (size_t c = 0; reader && c < column_log_chunk_count(reader); c++) {
+        ColumnChunkInfo info;
+        if (column_log_chunk_info(reader, c, &info) != 0) break;
+        float* rpm = malloc(info.rows * sizeof(float));
+        if (rpm && column_log_read_floats(reader, c, 0, rpm, info.rows) == info.rows) {
+            for (size_t r = 0; r < info.rows; r++) {
+                if (isnan(rpm[r])) continue;
+                if (logged++ == 0) first_rpm = rpm[r];
+            }
+        }
+        free(rpm);
+    }
+    column_log_reader_close(reader);
+    printf("Replay, full speed: %zu rows in %.3f s, %.0f rows/s, %llu ticks, %zu logged, "
+           "first RPM %.1f\n", (size_t)status.rows, seconds,
+           seconds > 0 ? status.rows / seconds : 0.0, (unsigned long long)stats.ticks,
+           logged, first_rpm);
+    if (result == 0 && (status.rows != rows || logged != rows || first_rpm != 3000.0f)) result = -1;
+    
+    // Recorded pace, scaled: 2 s of recording at 20x is 100 ms
+    session_replay_seek(0);
+    session_replay_set_speed(20.0f);
+    PIDQuery query = { OBD_MODE_SHOW_CURRENT_DATA, 0x0C, 0 };
+    PIDResult response;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (result == 0 && bench_elapsed(&start) < 0.1) {
+        replay_read_pids(&query, &response, 1);
+        bench_sleep_ms(5);
+    }
+    session_replay_get_status(&status);
+    printf("  paced at 20x: %.3f s of recording in 0.1 s, %llu rows\n",
+           status.position_us / 1e6, (unsigned long long)status.rows);
+    
+    // Seek: the next read answers from the new position
+    uint64_t target = (uint64_t)(rows / 2) * 10000;
+    session_replay_set_speed(SESSION_REPLAY_FASTEST);
+    session_replay_seek(target);
+    replay_read_pids(&query, &response, 1);
+    session_replay_get_status(&status);
+    printf("  seek to %.2f s: at %.2f s, RPM raw %u\n", target / 1e6,
+           status.position_us / 1e6, response.status == 0 ? (response.data[0] << 8 | response.data[1]) : 0);
+    if (result == 0 && (status.position_us != target || response.status != 0)) result = -1;
+    
+    session_replay_close();
+    unlink(REPLAY_BENCH_LOG);
+    unlink(REPLAY_BENCH_OUT);
+    return result;
+}
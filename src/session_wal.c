@@ -0,0 +1,430 @@
+#include "session_wal.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WAL_SEGMENT_MAGIC   "OBDWAL1"
+#define WAL_VERSION         1
+#define WAL_DEFAULT_BUFFER  (64 * 1024)
+
+typedef struct {
+    char magic[8];             // "OBDWAL1\0"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t sequence;         // Segment number, also in the file name
+    uint64_t first_lsn;        // LSN of the first record in the segment
+} WalSegmentHeader;
+
+/* Record framing; crc covers lsn, length and payload */
+typedef struct {
+    uint32_t length;           // Payload bytes
+    uint32_t crc;              // CRC-32C
+    uint64_t lsn;              // Record number, consecutive within a session
+} WalRecordHeader;
+
+struct SessionWal {
+    char directory[256];
+    char name[64];
+    uint32_t segment_size;
+    size_t record_size;
+    int fd;                    // Current segment
+    int dir_dirty;             // Segment created since the directory was synced
+    uint64_t sequence;
+    uint64_t segment_bytes;    // Bytes of the current segment written or buffered
+    uint64_t next_lsn;
+    uint8_t* buffer;           // Records since the last write
+    size_t buffer_size;
+    size_t fill;
+    int failed;
+};
+
+/* CRC-32C, reflected, table driven */
+static uint32_t crc_table[256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_init_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0x82F63B78u & -(crc & 1));
+        }
+        crc_table[i] = crc;
+    }
+}
+
+static uint32_t crc32c(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = data;
+    
+    crc = ~crc;
+    while (length--) {
+        crc = (crc >> 8) ^ crc_table[(crc ^ *bytes++) & 0xFF];
+    }
+    return ~crc;
+}
+
+static uint32_t wal_record_crc(const WalRecordHeader* header, const void* payload) {
+    uint32_t crc = crc32c(0, &header->lsn, sizeof(header->lsn));
+    crc = crc32c(crc, &header->length, sizeof(header->length));
+    return crc32c(crc, payload, header->length);
+}
+
+static void wal_segment_path(char* path, size_t size, const char* directory,
+                             const char* name, uint64_t sequence) {
+    snprintf(path, size, "%s/%s-%08llu.wal", directory, name, (unsigned long long)sequence);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Sequence numbers of the existing segments, ascending. Caller frees. */
+static int wal_list_segments(const char* directory, const char* name,
+                             uint64_t** sequences, size_t* count) {
+    DIR* dir = opendir(directory);
+    size_t prefix = strlen(name);
+    size_t capacity = 0;
+    struct dirent* entry;
+    
+    *sequences = NULL;
+    *count = 0;
+    if (!dir) return errno == ENOENT ? 0 : -1;
+    
+    while ((entry = readdir(dir)) != NULL) {
+        const char* file = entry->d_name;
+        unsigned long long sequence;
+        char suffix[8];
+    
+        if (strncmp(file, name, prefix) != 0 || file[prefix] != '-' ||
+            sscanf(file + prefix + 1, "%llu%7s", &sequence, suffix) != 2 ||
+            strcmp(suffix, ".wal") != 0) {
+            continue;
+        }
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            uint64_t* grown = realloc(*sequences, capacity * sizeof(uint64_t));
+            if (!grown) {
+                closedir(dir);
+                free(*sequences);
+                *sequences = NULL;
+                return -1;
+            }
+            *sequences = grown;
+        }
+        (*sequences)[(*count)++] = sequence;
+    }
+    closedir(dir);
+    
+    qsort(*sequences, *count, sizeof(uint64_t), compare_u64);
+    return 0;
+}
+
+static void wal_sync_directory(const char* directory) {
+    int fd = open(directory, O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/* Writer */
+static int wal_write_buffer(SessionWal* wal) {
+    const uint8_t* data = wal->buffer;
+    size_t length = wal->fill;
+    
+    while (length > 0) {
+        ssize_t n = write(wal->fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            DEBUG_PRINT(DEBUG_LEVEL_ERROR, "WAL write to %s failed: %s",
+                        wal->directory, strerror(errno));
+            wal->failed = 1;
+            return -1;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    wal->fill = 0;
+    return 0;
+}
+
+static int wal_open_segment(SessionWal* wal) {
+    char path[512];
+    
+    wal_segment_path(path, sizeof(path), wal->directory, wal->name, wal->sequence);
+    wal->fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (wal->fd < 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create WAL segment %s: %s", path, strerror(errno));
+        return -1;
+    }
+    
+    // The header goes out with the segment's first commit
+    WalSegmentHeader header = { .version = WAL_VERSION, .sequence = wal->sequence,
+                                .first_lsn = wal->next_lsn };
+    memcpy(header.magic, WAL_SEGMENT_MAGIC, sizeof(WAL_SEGMENT_MAGIC));
+    memcpy(wal->buffer, &header, sizeof(header));
+    wal->fill = sizeof(header);
+    wal->segment_bytes = sizeof(header);
+    wal->dir_dirty = 1;
+    return 0;
+}
+
+SessionWal* session_wal_open(const SessionWalConfig* config) {
+    if (!config || !config->directory || !config->name) return NULL;
+    
+    pthread_once(&crc_once, crc_init_table);
+    
+    SessionWal* wal = calloc(1, sizeof(SessionWal));
+    if (!wal) return NULL;
+    
+    snprintf(wal->directory, sizeof(wal->directory), "%s", config->directory);
+    snprintf(wal->name, sizeof(wal->name), "%s", config->name);
+    wal->segment_size = config->segment_size ? config->segment_size : SESSION_WAL_DEFAULT_SEGMENT;
+    wal->record_size = config->record_size;
+    wal->buffer_size = config->buffer_size ? config->buffer_size : WAL_DEFAULT_BUFFER;
+    if (wal->buffer_size < sizeof(WalSegmentHeader) + sizeof(WalRecordHeader) + SESSION_WAL_MAX_RECORD) {
+        wal->buffer_size = sizeof(WalSegmentHeader) + sizeof(WalRecordHeader) + SESSION_WAL_MAX_RECORD;
+    }
+    wal->next_lsn = 1;
+    wal->fd = -1;
+    
+    if (mkdir(wal->directory, 0755) != 0 && errno != EEXIST) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "Failed to create WAL directory %s: %s",
+                    wal->directory, strerror(errno));
+        free(wal);
+        return NULL;
+    }
+    
+    // Continue numbering after whatever an earlier session left
+    uint64_t* sequences;
+    size_t count;
+    if (wal_list_segments(wal->directory, wal->name, &sequences, &count) != 0) {
+        free(wal);
+        return NULL;
+    }
+    wal->sequence = count ? sequences[count - 1] + 1 : 1;
+    free(sequences);
+    
+    wal->buffer = malloc(wal->buffer_size);
+    if (!wal->buffer || wal_open_segment(wal) != 0) {
+        free(wal->buffer);
+        free(wal);
+        return NULL;
+    }
+    return wal;
+}
+
+int session_wal_append(SessionWal* wal, const void* payload, size_t length) {
+    if (!wal || !payload || length == 0 || length > SESSION_WAL_MAX_RECORD) return -1;
+    if (wal->failed) return -1;
+    
+    size_t record = sizeof(WalRecordHeader) + length;
+    
+    // Segments end on a commit so each one is self-contained on disk
+    if (wal->segment_bytes + record > wal->segment_size &&
+        wal->segment_bytes > sizeof(WalSegmentHeader)) {
+        if (session_wal_commit(wal) != 0) return -1;
+        close(wal->fd);
+        wal->sequence++;
+        if (wal_open_segment(wal) != 0) {
+            wal->failed = 1;
+            return -1;
+        }
+    }
+    if (wal->fill + record > wal->buffer_size && wal_write_buffer(wal) != 0) return -1;
+    
+    WalRecordHeader header = { .length = (uint32_t)length, .lsn = wal->next_lsn++ };
+    header.crc = wal_record_crc(&header, payload);
+    memcpy(wal->buffer + wal->fill, &header, sizeof(header));
+    memcpy(wal->buffer + wal->fill + sizeof(header), payload, length);
+    wal->fill += record;
+    wal->segment_bytes += record;
+    return 0;
+}
+
+/* Everything appended so far is on stable storage when this returns 0 */
+int session_wal_commit(SessionWal* wal) {
+    if (!wal || wal->failed) return -1;
+    
+    if (wal->fill && wal_write_buffer(wal) != 0) return -1;
+    if (fdatasync(wal->fd) != 0) {
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "WAL sync failed: %s", strerror(errno));
+        wal->failed = 1;
+        return -1;
+    }
+    if (wal->dir_dirty) {
+        wal_sync_directory(wal->directory);
+        wal->dir_dirty = 0;
+    }
+    return 0;
+}
+
+uint64_t session_wal_last_lsn(const SessionWal* wal) {
+    return wal ? wal->next_lsn - 1 : 0;
+}
+
+/* remove_segments is for a clean shutdown, once the data is safe elsewhere */
+int session_wal_close(SessionWal* wal, int remove_segments) {
+    if (!wal) return -1;
+    
+    int status = session_wal_commit(wal);
+    if (wal->fd >= 0 && close(wal->fd) != 0) status = -1;
+    if (remove_segments && status == 0) {
+        status = session_wal_remove(wal->directory, wal->name);
+    }
+    
+    free(wal->buffer);
+    free(wal);
+    return status;
+}
+
+size_t session_wal_consume(void* context, const void* record) {
+    SessionWal* wal = context;
+    
+    if (!record) {
+        session_wal_commit(wal);
+        return 0;
+    }
+    return session_wal_append(wal, record, wal->record_size) == 0 ?
+           sizeof(WalRecordHeader) + wal->record_size : 0;
+}
+
+/* Recovery */
+
+/* Replay one segment. Returns the offset where intact data ends, which is
+ * the file size when the segment is undamaged, or 0 when it holds nothing
+ * usable. Sets stopped when the replay callback asked to stop. */
+static size_t wal_replay_segment(const uint8_t* data, size_t size, uint64_t sequence,
+                                 SessionWalReplay replay, void* context,
+                                 SessionWalRecovery* result, int* stopped) {
+    const WalSegmentHeader* header = (const WalSegmentHeader*)data;
+    
+    if (size < sizeof(WalSegmentHeader) ||
+        memcmp(header->magic, WAL_SEGMENT_MAGIC, sizeof(WAL_SEGMENT_MAGIC)) != 0 ||
+        header->version != WAL_VERSION || header->sequence != sequence) {
+        return 0;
+    }
+    
+    size_t offset = sizeof(WalSegmentHeader);
+    uint64_t lsn = header->first_lsn;
+    while (offset + sizeof(WalRecordHeader) <= size) {
+        WalRecordHeader record;
+        memcpy(&record, data + offset, sizeof(record));
+        const uint8_t* payload = data + offset + sizeof(record);
+    
+        if (record.length == 0 || record.length > SESSION_WAL_MAX_RECORD ||
+            record.length > size - offset - sizeof(record) || record.lsn != lsn ||
+            record.crc != wal_record_crc(&record, payload)) {
+            break;
+        }
+    
+        result->records++;
+        result->bytes += record.length;
+        offset += sizeof(record) + record.length;
+        lsn++;
+        if (replay && replay(context, record.lsn, payload, record.length) != 0) {
+            *stopped = 1;
+            return size;
+        }
+    }
+    return offset;
+}
+
+/* Replay every intact record, then cut the log at the first damage: the
+ * damaged segment is truncated and any segments after it are removed */
+int session_wal_recover(const char* directory, const char* name, SessionWalReplay replay,
+                        void* context, SessionWalRecovery* result) {
+    SessionWalRecovery local;
+    uint64_t* sequences;
+    size_t count;
+    int damaged = 0, stopped = 0, status = 0;
+    
+    if (!directory || !name) return -1;
+    if (!result) result = &local;
+    memset(result, 0, sizeof(*result));
+    pthread_once(&crc_once, crc_init_table);
+    
+    if (wal_list_segments(directory, name, &sequences, &count) != 0) return -1;
+    result->segments = (uint32_t)count;
+    
+    for (size_t i = 0; i < count && !stopped; i++) {
+        char path[512];
+        struct stat st;
+    
+        wal_segment_path(path, sizeof(path), directory, name, sequences[i]);
+        int fd = open(path, O_RDWR);
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            if (fd >= 0) close(fd);
+            status = -1;
+            continue;
+        }
+        size_t size = (size_t)st.st_size;
+    
+        if (damaged) {
+            // Nothing after a gap can be trusted to follow on
+            result->truncated_bytes += size;
+            result->removed_segments++;
+            close(fd);
+            unlink(path);
+            continue;
+        }
+    
+        size_t valid = 0;
+        if (size > 0) {
+            void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (map == MAP_FAILED) {
+                close(fd);
+                status = -1;
+                continue;
+            }
+            valid = wal_replay_segment(map, size, sequences[i], replay, context, result, &stopped);
+            munmap(map, size);
+        }
+    
+        if (valid < size || valid <= sizeof(WalSegmentHeader)) {
+            damaged = valid < size;
+            result->truncated_bytes += size - valid;
+            if (valid <= sizeof(WalSegmentHeader)) {
+                close(fd);
+                unlink(path);
+                result->removed_segments++;
+                continue;
+            }
+            if (ftruncate(fd, (off_t)valid) != 0 || fdatasync(fd) != 0) status = -1;
+            DEBUG_PRINT(DEBUG_LEVEL_WARN, "WAL segment %s truncated from %zu to %zu bytes",
+                        path, size, valid);
+        }
+        close(fd);
+    }
+    
+    if (result->removed_segments) wal_sync_directory(directory);
+    free(sequences);
+    return status;
+}
+
+int session_wal_remove(const char* directory, const char* name) {
+    uint64_t* sequences;
+    size_t count;
+    int status = 0;
+    
+    if (!directory || !name) return -1;
+    if (wal_list_segments(directory, name, &sequences, &count) != 0) return -1;
+    
+    for (size_t i = 0; i < count; i++) {
+        char path[512];
+        wal_segment_path(path, sizeof(path), directory, name, sequences[i]);
+        if (unlink(path) != 0 && errno != ENOENT) status = -1;
+    }
+    if (count) wal_sync_directory(directory);
+    
+    free(sequences);
+    return status;
+}
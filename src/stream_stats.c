@@ -0,0 +1,303 @@
+#include "stream_stats.h"
+#include "obd2_core.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <pthread.h>
+
+/* Sketch geometry: bucket k holds magnitudes in (gamma^(k-1), gamma^k]
+ * shifted by STATS_SKETCH_MIN_KEY, gamma = (1 + a) / (1 - a) */
+#define STATS_SKETCH_MIN_VALUE 1e-3f
+
+static float sketch_log_gamma;
+static float sketch_min_key;
+static pthread_once_t sketch_once = PTHREAD_ONCE_INIT;
+
+static void sketch_init_constants(void) {
+    float gamma = (1.0f + STATS_SKETCH_ACCURACY) / (1.0f - STATS_SKETCH_ACCURACY);
+    sketch_log_gamma = logf(gamma);
+    sketch_min_key = ceilf(logf(STATS_SKETCH_MIN_VALUE) / sketch_log_gamma);
+}
+
+static inline size_t sketch_key(float magnitude) {
+    float key = ceilf(logf(magnitude) / sketch_log_gamma) - sketch_min_key;
+    if (key < 0.0f) return 0;
+    if (key >= STATS_SKETCH_BUCKETS) return STATS_SKETCH_BUCKETS - 1;
+    return (size_t)key;
+}
+
+/* Midpoint of a bucket in relative terms, so the error is symmetric */
+static float sketch_value(size_t key) {
+    float upper = expf(((float)key + sketch_min_key) * sketch_log_gamma);
+    return upper * 2.0f / (1.0f + expf(sketch_log_gamma));
+}
+
+/* Summary */
+void stats_summary_reset(StatSummary* summary) {
+    if (!summary) return;
+    memset(summary, 0, sizeof(*summary));
+    summary->min = FLT_MAX;
+    summary->max = -FLT_MAX;
+}
+
+/* Sketch position of a value: sign -1/0/1 and bucket key */
+typedef struct {
+    int sign;
+    size_t key;
+} SketchSlot;
+
+static SketchSlot sketch_slot(float value) {
+    SketchSlot slot = { 0, 0 };
+    
+    if (value >= STATS_SKETCH_MIN_VALUE) {
+        slot.sign = 1;
+        slot.key = sketch_key(value);
+    } else if (value <= -STATS_SKETCH_MIN_VALUE) {
+        slot.sign = -1;
+        slot.key = sketch_key(-value);
+    }
+    return slot;
+}
+
+static void summary_insert(StatSummary* summary, float value, SketchSlot slot) {
+    summary->count++;
+    double delta = value - summary->mean;
+    summary->mean += delta / (double)summary->count;
+    summary->m2 += delta * (value - summary->mean);
+    if (value < summary->min) summary->min = value;
+    if (value > summary->max) summary->max = value;
+    
+    if (slot.sign > 0) {
+        summary->positive[slot.key]++;
+    } else if (slot.sign < 0) {
+        summary->negative[slot.key]++;
+    } else {
+        summary->zero_count++;
+    }
+}
+
+void stats_summary_add(StatSummary* summary, float value) {
+    if (!summary) return;
+    pthread_once(&sketch_once, sketch_init_constants);
+    summary_insert(summary, value, sketch_slot(value));
+}
+
+/* Chan et al. pairwise combination; the sketch merges bucket by bucket */
+void stats_summary_merge(StatSummary* into, const StatSummary* from) {
+    if (!into || !from || from->count == 0) return;
+    
+    uint64_t count = into->count + from->count;
+    double delta = from->mean - into->mean;
+    into->m2 += from->m2 + delta * delta * ((double)into->count * from->count / count);
+    into->mean += delta * from->count / count;
+    into->count = count;
+    if (from->min < into->min) into->min = from->min;
+    if (from->max > into->max) into->max = from->max;
+    
+    into->zero_count += from->zero_count;
+    for (size_t k = 0; k < STATS_SKETCH_BUCKETS; k++) {
+        into->positive[k] += from->positive[k];
+        into->negative[k] += from->negative[k];
+    }
+}
+
+float stats_summary_variance(const StatSummary* summary) {
+    if (!summary || summary->count < 2) return 0.0f;
+    return (float)(summary->m2 / (double)(summary->count - 1));
+}
+
+float stats_summary_quantile(const StatSummary* summary, float q) {
+    if (!summary || summary->count == 0) return NAN;
+    pthread_once(&sketch_once, sketch_init_constants);
+    
+    if (q <= 0.0f) return summary->min;
+    if (q >= 1.0f) return summary->max;
+    
+    uint64_t rank = (uint64_t)(q * (float)(summary->count - 1));
+    uint64_t seen = 0;
+    float value = summary->max;
+    int found = 0;
+    
+    // Ascending order: most negative first, then zero, then positive
+    for (size_t k = STATS_SKETCH_BUCKETS; k-- > 0 && !found;) {
+        seen += summary->negative[k];
+        if (seen > rank) { value = -sketch_value(k); found = 1; }
+    }
+    if (!found) {
+        seen += summary->zero_count;
+        if (seen > rank) { value = 0.0f; found = 1; }
+    }
+    for (size_t k = 0; k < STATS_SKETCH_BUCKETS && !found; k++) {
+        seen += summary->positive[k];
+        if (seen > rank) { value = sketch_value(k); found = 1; }
+    }
+    
+    // Bucket midpoints can fall outside what was actually seen
+    if (value < summary->min) value = summary->min;
+    if (value > summary->max) value = summary->max;
+    return value;
+}
+
+/* Per-channel windows. The recent window is a ring of panes, each
+ * covering window_ms / STATS_WINDOW_PANES; a read merges the live ones. */
+typedef struct {
+    StatSummary session;
+    StatSummary lap;
+    StatSummary panes[STATS_WINDOW_PANES];
+} ChannelWindows;
+
+struct StreamStats {
+    size_t channel_count;
+    uint32_t pane_ms;
+    uint64_t pane_id;          // Pane of the newest sample
+    uint8_t has_samples;
+    pthread_mutex_t lock;      // Readers may run on other threads
+    ChannelWindows* channels;
+};
+
+StreamStats* stream_stats_create(size_t channels, uint32_t window_ms) {
+    if (channels == 0) return NULL;
+    
+    StreamStats* stats = calloc(1, sizeof(StreamStats));
+    if (!stats) return NULL;
+    
+    stats->channels = malloc(channels * sizeof(ChannelWindows));
+    if (!stats->channels) {
+        free(stats);
+        return NULL;
+    }
+    
+    stats->channel_count = channels;
+    if (window_ms == 0) window_ms = STATS_DEFAULT_WINDOW_MS;
+    stats->pane_ms = window_ms / STATS_WINDOW_PANES ? window_ms / STATS_WINDOW_PANES : 1;
+    pthread_mutex_init(&stats->lock, NULL);
+    stream_stats_reset(stats);
+    return stats;
+}
+
+void stream_stats_destroy(StreamStats* stats) {
+    if (!stats) return;
+    pthread_mutex_destroy(&stats->lock);
+    free(stats->channels);
+    free(stats);
+}
+
+/* Move the pane ring forward to pane_id, clearing the panes that left the window */
+static void advance_panes(StreamStats* stats, uint64_t pane_id) {
+    uint64_t steps = pane_id - stats->pane_id;
+    if (steps > STATS_WINDOW_PANES) steps = STATS_WINDOW_PANES;
+    
+    for (uint64_t s = 1; s <= steps; s++) {
+        size_t slot = (size_t)((pane_id - steps + s) % STATS_WINDOW_PANES);
+        for (size_t c = 0; c < stats->channel_count; c++) {
+            stats_summary_reset(&stats->channels[c].panes[slot]);
+        }
+    }
+    stats->pane_id = pane_id;
+}
+
+/* One value per channel; NaN marks a channel without data in this sample */
+int stream_stats_add(StreamStats* stats, const float* values, uint64_t timestamp_ms) {
+    if (!stats || !values) return -1;
+    pthread_once(&sketch_once, sketch_init_constants);
+    
+    uint64_t pane_id = timestamp_ms / stats->pane_ms;
+    
+    pthread_mutex_lock(&stats->lock);
+    if (!stats->has_samples) {
+        stats->pane_id = pane_id;
+        stats->has_samples = 1;
+    } else if (pane_id > stats->pane_id) {
+        advance_panes(stats, pane_id);
+    }
+    // Late samples land in the current pane
+    size_t pane = (size_t)(stats->pane_id % STATS_WINDOW_PANES);
+    
+    for (size_t c = 0; c < stats->channel_count; c++) {
+        if (isnan(values[c])) continue;
+        ChannelWindows* channel = &stats->channels[c];
+        SketchSlot slot = sketch_slot(values[c]);
+        summary_insert(&channel->session, values[c], slot);
+        summary_insert(&channel->lap, values[c], slot);
+        summary_insert(&channel->panes[pane], values[c], slot);
+    }
+    pthread_mutex_unlock(&stats->lock);
+    return 0;
+}
+
+int stream_stats_new_lap(StreamStats* stats) {
+    if (!stats) return -1;
+    
+    pthread_mutex_lock(&stats->lock);
+    for (size_t c = 0; c < stats->channel_count; c++) {
+        stats_summary_reset(&stats->channels[c].lap);
+    }
+    pthread_mutex_unlock(&stats->lock);
+    return 0;
+}
+
+int stream_stats_reset(StreamStats* stats) {
+    if (!stats) return -1;
+    
+    pthread_mutex_lock(&stats->lock);
+    for (size_t c = 0; c < stats->channel_count; c++) {
+        ChannelWindows* channel = &stats->channels[c];
+        stats_summary_reset(&channel->session);
+        stats_summary_reset(&channel->lap);
+        for (size_t p = 0; p < STATS_WINDOW_PANES; p++) {
+            stats_summary_reset(&channel->panes[p]);
+        }
+    }
+    stats->has_samples = 0;
+    stats->pane_id = 0;
+    pthread_mutex_unlock(&stats->lock);
+    return 0;
+}
+
+int stream_stats_get_summary(StreamStats* stats, size_t channel, StatsWindow window,
+                             StatSummary* out) {
+    if (!stats || !out || channel >= stats->channel_count || window >= STATS_WINDOW_COUNT) {
+        return -1;
+    }
+    
+    const ChannelWindows* windows = &stats->channels[channel];
+    
+    pthread_mutex_lock(&stats->lock);
+    switch (window) {
+        case STATS_WINDOW_SESSION:
+            *out = windows->session;
+            break;
+        case STATS_WINDOW_LAP:
+            *out = windows->lap;
+            break;
+        default:
+            stats_summary_reset(out);
+            for (size_t p = 0; p < STATS_WINDOW_PANES; p++) {
+                stats_summary_merge(out, &windows->panes[p]);
+            }
+            break;
+    }
+    pthread_mutex_unlock(&stats->lock);
+    return 0;
+}
+
+int stream_stats_get(StreamStats* stats, size_t channel, StatsWindow window, ChannelStats* out) {
+    StatSummary summary;
+    
+    if (!out || stream_stats_get_summary(stats, channel, window, &summary) != 0) return -1;
+    
+    memset(out, 0, sizeof(*out));
+    out->count = summary.count;
+    if (summary.count == 0) return 0;
+    
+    out->min = summary.min;
+    out->max = summary.max;
+    out->mean = (float)summary.mean;
+    out->variance = stats_summary_variance(&summary);
+    out->stddev = sqrtf(out->variance);
+    out->p50 = stats_summary_quantile(&summary, 0.50f);
+    out->p90 = stats_summary_quantile(&summary, 0.90f);
+    out->p99 = stats_summary_quantile(&summary, 0.99f);
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "system_diagnostics.h"
+#include "sct_device.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
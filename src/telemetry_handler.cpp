@@ -1,7 +1,12 @@
 #include "../include/device_adapter.h"
 #include "../include/performance_calc.h"
+#include "../include/column_log.h"
+#include "../include/csv_export.h"
+#include "../include/timebase.h"
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 
 #define MAX_TELEMETRY_BUFFER 1024
@@ -28,14 +33,45 @@ typedef struct {
     float predicted_lap_time;
 } TelemetryFrame;
 
+/* Columnar schema, in TelemetryFrame order after the timestamp */
+#define TELEMETRY_CHANNELS 17
+
+static const ColumnLogChannel telemetry_channels[TELEMETRY_CHANNELS] = {
+    { "lat", "deg", COLUMN_TYPE_F64, {0} },
+    { "lon", "deg", COLUMN_TYPE_F64, {0} },
+    { "speed", "mph", COLUMN_TYPE_F32, {0} },
+    { "rpm", "rpm", COLUMN_TYPE_F32, {0} },
+    { "boost", "psi", COLUMN_TYPE_F32, {0} },
+    { "throttle", "%", COLUMN_TYPE_F32, {0} },
+    { "brake", "%", COLUMN_TYPE_F32, {0} },
+    { "accel_x", "g", COLUMN_TYPE_F32, {0} },
+    { "accel_y", "g", COLUMN_TYPE_F32, {0} },
+    { "accel_z", "g", COLUMN_TYPE_F32, {0} },
+    { "g_force", "g", COLUMN_TYPE_F32, {0} },
+    { "slip_angle", "deg", COLUMN_TYPE_F32, {0} },
+    { "gear", "", COLUMN_TYPE_I32, {0} },
+    { "track_pos", "", COLUMN_TYPE_F32, {0} },
+    { "lap_time", "s", COLUMN_TYPE_F32, {0} },
+    { "sector_time", "s", COLUMN_TYPE_F32, {0} },
+    { "predicted_time", "s", COLUMN_TYPE_F32, {0} }
+};
+
+/* Digits after the point in CSV output, same column order */
+static const int telemetry_decimals[TELEMETRY_CHANNELS] = {
+    6, 6, 2, 0, 2, 2, 2, 3, 3, 3, 2, 2, 0, 2, 3, 3, 3
+};
+
 static TelemetryConfig config;
 static FILE* telemetry_file = NULL;
+static ColumnLog* telemetry_columns = NULL;
 static char buffer[MAX_TELEMETRY_BUFFER];
 
 int telemetry_init(const TelemetryConfig* cfg) {
     memcpy(&config, cfg, sizeof(TelemetryConfig));
     
     if (config.storage_config.save_to_file) {
+        // Columnar unless CSV is asked for by name
+        bool csv = strcasecmp(config.storage_config.output_format, "csv") == 0;
         char filename[512];
         time_t now = time(NULL);
         struct tm* t = localtime(&now);
@@ -45,8 +81,14 @@ int telemetry_init(const TelemetryConfig* cfg) {
                 config.storage_config.output_dir,
                 t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
                 t->tm_hour, t->tm_min, t->tm_sec,
-                config.storage_config.output_format);
-                
+                csv ? "csv" : "clog");
+        
+        if (!csv) {
+            telemetry_columns = column_log_create(filename, telemetry_channels,
+                                                  TELEMETRY_CHANNELS, 0);
+            return telemetry_columns ? 0 : -1;
+        }
+        
         telemetry_file = fopen(filename, "w");
         if (!telemetry_file) return -1;
         
@@ -82,19 +124,26 @@ int telemetry_update(const PerformanceData* data) {
         .predicted_lap_time = data->sensor_data.predicted_lap_time
     };
     
-    if (config.storage_config.save_to_file && telemetry_file) {
-        fprintf(telemetry_file, 
-                "%llu,%.6f,%.6f,%.2f,%.0f,%.2f,%.2f,%.2f,"
-                "%.3f,%.3f,%.3f,%.2f,%.2f,%d,"
-                "%.2f,%.3f,%.3f,%.3f\n",
-                frame.timestamp, frame.lat, frame.lon,
-                frame.speed, frame.rpm, frame.boost,
-                frame.throttle, frame.brake,
-                frame.acceleration_x, frame.acceleration_y,
-                frame.acceleration_z, frame.g_force,
-                frame.slip_angle, frame.gear,
-                frame.track_position, frame.lap_time,
-                frame.sector_time, frame.predicted_lap_time);
+    const float values[TELEMETRY_CHANNELS] = {
+        frame.lat, frame.lon, frame.speed, frame.rpm, frame.boost,
+        frame.throttle, frame.brake,
+        frame.acceleration_x, frame.acceleration_y, frame.acceleration_z,
+        frame.g_force, frame.slip_angle, (float)frame.gear,
+        frame.track_position, frame.lap_time,
+        frame.sector_time, frame.predicted_lap_time
+    };
+    if (config.storage_config.save_to_file && telemetry_columns) {
+        column_log_append(telemetry_columns, frame.timestamp, values);
+    } else if (config.storage_config.save_to_file && telemetry_file) {
+        char line[CSV_NUMBER_MAX * (TELEMETRY_CHANNELS + 1) + 1];
+        // Wall-clock µs, like the performance log, so imports line up with other logs
+        size_t length = csv_format_int(timebase_to_wall_us(frame.timestamp), line);
+        for (size_t c = 0; c < TELEMETRY_CHANNELS; c++) {
+            line[length++] = ',';
+            length += csv_format_float(values[c], telemetry_decimals[c], line + length);
+        }
+        line[length++] = '\n';
+        fwrite(line, 1, length, telemetry_file);
     }
     
     if (config.enable_live_streaming) {
@@ -106,6 +155,10 @@ int telemetry_update(const PerformanceData* data) {
 }
 
 void telemetry_close(void) {
+    if (telemetry_columns) {
+        column_log_close(telemetry_columns);
+        telemetry_columns = NULL;
+    }
     if (telemetry_file) {
         fclose(telemetry_file);
         telemetry_file = NULL;
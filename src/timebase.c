@@ -0,0 +1,57 @@
+#include "timebase.h"
+#include <time.h>
+#include <pthread.h>
+
+static struct {
+    TimebaseAnchor anchor;
+    uint8_t anchored;
+    pthread_mutex_t lock;
+} timebase_state = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t timespec_to_us(const struct timespec* ts) {
+    return (uint64_t)ts->tv_sec * 1000000ULL + (uint64_t)ts->tv_nsec / 1000ULL;
+}
+
+uint64_t timebase_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return timespec_to_us(&ts);
+}
+
+/* Record a new wall clock anchor. The wall reading is bracketed by two
+ * monotonic reads and paired with their midpoint. */
+void timebase_start_session(TimebaseAnchor* anchor) {
+    struct timespec wall;
+    
+    uint64_t before = timebase_now_us();
+    clock_gettime(CLOCK_REALTIME, &wall);
+    uint64_t after = timebase_now_us();
+    
+    pthread_mutex_lock(&timebase_state.lock);
+    timebase_state.anchor.monotonic_us = before + (after - before) / 2;
+    timebase_state.anchor.wall_us = (int64_t)timespec_to_us(&wall);
+    timebase_state.anchored = 1;
+    if (anchor) *anchor = timebase_state.anchor;
+    pthread_mutex_unlock(&timebase_state.lock);
+}
+
+/* Current anchor, -1 if no session has started */
+int timebase_get_anchor(TimebaseAnchor* anchor) {
+    if (!anchor) return -1;
+    
+    pthread_mutex_lock(&timebase_state.lock);
+    int anchored = timebase_state.anchored;
+    *anchor = timebase_state.anchor;
+    pthread_mutex_unlock(&timebase_state.lock);
+    return anchored ? 0 : -1;
+}
+
+/* Wall clock time of a timebase timestamp; anchors a session on first use */
+int64_t timebase_to_wall_us(uint64_t timestamp_us) {
+    TimebaseAnchor anchor;
+    
+    if (timebase_get_anchor(&anchor) != 0) {
+        timebase_start_session(&anchor);
+    }
+    return anchor.wall_us + ((int64_t)timestamp_us - (int64_t)anchor.monotonic_us);
+}
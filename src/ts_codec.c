@@ -0,0 +1,467 @@
+#include "ts_codec.h"
+#include "obd2_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+/* Values of any block type as 64-bit integers, sign-extended for I32 */
+static inline uint64_t ts_load(const void* values, uint8_t type, size_t i) {
+    switch (type) {
+        case TS_TYPE_I32: return (uint64_t)(int64_t)((const int32_t*)values)[i];
+        case TS_TYPE_U8:  return ((const uint8_t*)values)[i];
+        case TS_TYPE_F32: return ((const uint32_t*)values)[i];
+        default:          return ((const uint64_t*)values)[i];
+    }
+}
+
+static inline void ts_store(void* values, uint8_t type, size_t i, uint64_t value) {
+    switch (type) {
+        case TS_TYPE_I32: ((int32_t*)values)[i] = (int32_t)value; break;
+        case TS_TYPE_U8:  ((uint8_t*)values)[i] = (uint8_t)value; break;
+        case TS_TYPE_F32: ((uint32_t*)values)[i] = (uint32_t)value; break;
+        default:          ((uint64_t*)values)[i] = value; break;
+    }
+}
+
+size_t ts_type_size(uint8_t type) {
+    switch (type) {
+        case TS_TYPE_F64:
+        case TS_TYPE_U64: return 8;
+        case TS_TYPE_U8:  return 1;
+        default:          return 4;
+    }
+}
+
+/* Varints */
+static inline int varint_put(uint8_t* out, size_t capacity, size_t* pos, uint64_t value) {
+    while (value >= 0x80) {
+        if (*pos >= capacity) return -1;
+        out[(*pos)++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    if (*pos >= capacity) return -1;
+    out[(*pos)++] = (uint8_t)value;
+    return 0;
+}
+
+static inline int varint_get(const uint8_t* in, size_t size, size_t* pos, uint64_t* value) {
+    uint64_t result = 0;
+    
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (*pos >= size) return -1;
+        uint8_t byte = in[(*pos)++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* Delta-of-delta: first value, first delta, then changes of the delta */
+static size_t dod_encode(const void* values, size_t count, uint8_t type,
+                         uint8_t* out, size_t capacity) {
+    size_t pos = 0;
+    uint64_t prev = 0;
+    int64_t prev_delta = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = ts_load(values, type, i);
+        int64_t delta = (int64_t)(value - prev);
+        uint64_t code = i == 0 ? value : zigzag(delta - prev_delta);
+    
+        if (varint_put(out, capacity, &pos, code) != 0) return 0;
+        if (i > 0) prev_delta = delta;
+        prev = value;
+    }
+    return pos;
+}
+
+static int dod_decode(const uint8_t* in, size_t size, uint8_t type, void* values, size_t count) {
+    size_t pos = 0;
+    uint64_t value = 0;
+    int64_t delta = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        uint64_t code;
+        if (varint_get(in, size, &pos, &code) != 0) return -1;
+    
+        if (i == 0) {
+            value = code;
+        } else {
+            delta += unzigzag(code);
+            value += (uint64_t)delta;
+        }
+        ts_store(values, type, i, value);
+    }
+    return pos == size ? 0 : -1;
+}
+
+size_t ts_encode_dod(const uint64_t* values, size_t count, uint8_t* out, size_t capacity) {
+    if (!values || !out) return 0;
+    return dod_encode(values, count, TS_TYPE_U64, out, capacity);
+}
+
+int ts_decode_dod(const uint8_t* in, size_t size, uint64_t* values, size_t count) {
+    if (!in || !values) return -1;
+    return dod_decode(in, size, TS_TYPE_U64, values, count);
+}
+
+/* Bit streams, most significant bit first */
+typedef struct {
+    uint8_t* out;
+    size_t capacity;
+    size_t pos;
+    uint64_t acc;
+    unsigned bits;             // Pending bits in acc, always < 8 between calls
+    int overflow;
+} BitWriter;
+
+typedef struct {
+    const uint8_t* in;
+    size_t size;
+    size_t pos;
+    uint64_t acc;
+    unsigned bits;
+    int overflow;
+} BitReader;
+
+static inline void bits_put32(BitWriter* w, uint32_t value, unsigned count) {
+    if (count == 0) return;
+    w->acc = (w->acc << count) | (value & (0xFFFFFFFFu >> (32 - count)));
+    w->bits += count;
+    while (w->bits >= 8) {
+        w->bits -= 8;
+        if (w->pos < w->capacity) {
+            w->out[w->pos++] = (uint8_t)(w->acc >> w->bits);
+        } else {
+            w->overflow = 1;
+        }
+    }
+}
+
+static inline void bits_put(BitWriter* w, uint64_t value, unsigned count) {
+    if (count > 32) {
+        bits_put32(w, (uint32_t)(value >> 32), count - 32);
+        count = 32;
+    }
+    bits_put32(w, (uint32_t)value, count);
+}
+
+static size_t bits_finish(BitWriter* w) {
+    if (w->bits) bits_put32(w, 0, 8 - w->bits);
+    return w->overflow ? 0 : w->pos;
+}
+
+static inline uint32_t bits_get32(BitReader* r, unsigned count) {
+    if (count == 0) return 0;
+    while (r->bits < count) {
+        if (r->pos < r->size) {
+            r->acc = (r->acc << 8) | r->in[r->pos++];
+        } else {
+            r->acc <<= 8;
+            r->overflow = 1;
+        }
+        r->bits += 8;
+    }
+    r->bits -= count;
+    return (uint32_t)(r->acc >> r->bits) & (0xFFFFFFFFu >> (32 - count));
+}
+
+static inline uint64_t bits_get(BitReader* r, unsigned count) {
+    uint64_t high = 0;
+    if (count > 32) {
+        high = (uint64_t)bits_get32(r, count - 32) << 32;
+        count = 32;
+    }
+    return high | bits_get32(r, count);
+}
+
+/* Gorilla XOR. Per value after the first:
+ *   0                          same as previous
+ *   10 <bits>                  changed bits fit the previous window
+ *   11 <lead> <len-1> <bits>   new window
+ * lead and len take 5 bits for 32-bit values and 6 for 64-bit. */
+size_t ts_encode_xor(const void* values, size_t count, unsigned width,
+                     uint8_t* out, size_t capacity) {
+    if (!values || !out || (width != 32 && width != 64)) return 0;
+    
+    BitWriter w = { out, capacity, 0, 0, 0, 0 };
+    const unsigned field = width == 32 ? 5 : 6;
+    const uint8_t type = width == 32 ? TS_TYPE_F32 : TS_TYPE_F64;
+    unsigned lead = width + 1, trail = 0;   // No window yet
+    uint64_t prev = 0;
+    
+    for (size_t i = 0; i < count && !w.overflow; i++) {
+        uint64_t value = ts_load(values, type, i);
+        if (i == 0) {
+            bits_put(&w, value, width);
+            prev = value;
+            continue;
+        }
+    
+        uint64_t x = value ^ prev;
+        prev = value;
+        if (x == 0) {
+            bits_put32(&w, 0, 1);
+            continue;
+        }
+    
+        unsigned new_lead = (unsigned)__builtin_clzll(x) - (64 - width);
+        unsigned new_trail = (unsigned)__builtin_ctzll(x);
+        if (new_lead > (1u << field) - 1) new_lead = (1u << field) - 1;
+    
+        if (lead <= width && new_lead >= lead && new_trail >= trail) {
+            bits_put32(&w, 0x2, 2);
+            bits_put(&w, x >> trail, width - lead - trail);
+        } else {
+            unsigned length = width - new_lead - new_trail;
+            bits_put32(&w, 0x3, 2);
+            bits_put32(&w, new_lead, field);
+            bits_put32(&w, length - 1, field);
+            bits_put(&w, x >> new_trail, length);
+            lead = new_lead;
+            trail = new_trail;
+        }
+    }
+    return bits_finish(&w);
+}
+
+int ts_decode_xor(const uint8_t* in, size_t size, unsigned width, void* values, size_t count) {
+    if (!in || !values || (width != 32 && width != 64)) return -1;
+    
+    BitReader r = { in, size, 0, 0, 0, 0 };
+    const unsigned field = width == 32 ? 5 : 6;
+    const uint8_t type = width == 32 ? TS_TYPE_F32 : TS_TYPE_F64;
+    unsigned lead = 0, trail = 0;
+    int window = 0;
+    uint64_t value = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0) {
+            value = bits_get(&r, width);
+        } else if (bits_get32(&r, 1)) {
+            if (bits_get32(&r, 1)) {
+                lead = bits_get32(&r, field);
+                unsigned length = bits_get32(&r, field) + 1;
+                if (lead + length > width) return -1;
+                trail = width - lead - length;
+                window = 1;
+            } else if (!window) {
+                return -1;
+            }
+            value ^= bits_get(&r, width - lead - trail) << trail;
+        }
+        ts_store(values, type, i, value);
+    }
+    return r.overflow ? -1 : 0;
+}
+
+/* Run-length: varint run, then the value's bytes */
+size_t ts_encode_rle(const void* values, size_t count, size_t value_size,
+                     uint8_t* out, size_t capacity) {
+    if (!values || !out || value_size == 0 || value_size > 8) return 0;
+    
+    const uint8_t* bytes = values;
+    size_t pos = 0;
+    
+    for (size_t i = 0; i < count;) {
+        size_t run = 1;
+        while (i + run < count &&
+               memcmp(bytes + (i + run) * value_size, bytes + i * value_size, value_size) == 0) {
+            run++;
+        }
+        if (varint_put(out, capacity, &pos, run) != 0 || pos + value_size > capacity) return 0;
+        memcpy(out + pos, bytes + i * value_size, value_size);
+        pos += value_size;
+        i += run;
+    }
+    return pos;
+}
+
+int ts_decode_rle(const uint8_t* in, size_t size, size_t value_size, void* values, size_t count) {
+    if (!in || !values || value_size == 0 || value_size > 8) return -1;
+    
+    uint8_t* bytes = values;
+    size_t pos = 0, filled = 0;
+    
+    while (filled < count) {
+        uint64_t run;
+        if (varint_get(in, size, &pos, &run) != 0 || run == 0 || run > count - filled ||
+            pos + value_size > size) {
+            return -1;
+        }
+        for (uint64_t k = 0; k < run; k++) {
+            memcpy(bytes + (filled + k) * value_size, in + pos, value_size);
+        }
+        pos += value_size;
+        filled += run;
+    }
+    return pos == size ? 0 : -1;
+}
+
+/* Slow channels change rarely enough that runs beat everything else */
+#define TS_RLE_MAX_RUN_SHARE 8   // RLE when runs <= count / this
+
+size_t ts_encode_block(const void* values, size_t count, uint8_t type,
+                       uint8_t* out, size_t capacity, uint8_t* codec) {
+    if (!values || !out || !codec) return 0;
+    
+    size_t value_size = ts_type_size(type);
+    size_t raw = count * value_size;
+    size_t runs = count ? 1 : 0;
+    size_t size = 0;
+    
+    if (capacity > raw) capacity = raw;
+    for (size_t i = 1; i < count && runs <= count / TS_RLE_MAX_RUN_SHARE; i++) {
+        if (ts_load(values, type, i) != ts_load(values, type, i - 1)) runs++;
+    }
+    
+    if (runs <= count / TS_RLE_MAX_RUN_SHARE) {
+        *codec = TS_CODEC_RLE;
+        size = ts_encode_rle(values, count, value_size, out, capacity);
+    } else if (type == TS_TYPE_F32 || type == TS_TYPE_F64) {
+        *codec = TS_CODEC_XOR;
+        size = ts_encode_xor(values, count, type == TS_TYPE_F32 ? 32 : 64, out, capacity);
+    } else {
+        *codec = TS_CODEC_DOD;
+        size = dod_encode(values, count, type, out, capacity);
+    }
+    
+    if (size == 0) *codec = TS_CODEC_RAW;
+    return size;
+}
+
+int ts_decode_block(uint8_t codec, uint8_t type, const uint8_t* in, size_t size,
+                    void* values, size_t count) {
+    if (!in || !values) return -1;
+    
+    switch (codec) {
+        case TS_CODEC_RAW:
+            if (size != count * ts_type_size(type)) return -1;
+            memcpy(values, in, size);
+            return 0;
+        case TS_CODEC_DOD:
+            return dod_decode(in, size, type, values, count);
+        case TS_CODEC_XOR:
+            if (type != TS_TYPE_F32 && type != TS_TYPE_F64) return -1;
+            return ts_decode_xor(in, size, type == TS_TYPE_F32 ? 32 : 64, values, count);
+        case TS_CODEC_RLE:
+            return ts_decode_rle(in, size, ts_type_size(type), values, count);
+        default:
+            return -1;
+    }
+}
+
+/* Benchmark */
+#define TS_BENCH_BLOCK    4096
+#define TS_BENCH_CHANNELS 6
+
+static const char* const bench_names[TS_BENCH_CHANNELS] = {
+    "timestamp", "rpm", "speed", "tps", "coolant", "gear"
+};
+static const uint8_t bench_types[TS_BENCH_CHANNELS] = {
+    TS_TYPE_U64, TS_TYPE_F32, TS_TYPE_F32, TS_TYPE_F32, TS_TYPE_F32, TS_TYPE_U8
+};
+
+/* A drive sampled at 100 Hz with receive jitter, values quantised the way
+ * the OBD scalings quantise them */
+static void bench_fill(void* columns[TS_BENCH_CHANNELS], size_t samples) {
+    uint32_t seed = 12345;
+    
+    for (size_t i = 0; i < samples; i++) {
+        seed = seed * 1103515245u + 12345u;
+        double t = i * 0.01;
+        float throttle = 50.0f + 45.0f * (float)sin(t * 0.3);
+    
+        ((uint64_t*)columns[0])[i] = 1000000 + i * 10000 + (seed >> 16) % 400;
+        ((float*)columns[1])[i] = roundf((2500.0f + 2000.0f * (float)sin(t * 0.2)) * 4.0f) / 4.0f;
+        ((float*)columns[2])[i] = roundf(80.0f + 40.0f * (float)sin(t * 0.05));
+        ((float*)columns[3])[i] = roundf(throttle * 2.55f) * 100.0f / 255.0f;
+        ((float*)columns[4])[i] = floorf(85.0f + (float)(i / 3000 % 5));
+        ((uint8_t*)columns[5])[i] = (uint8_t)(1 + i / 2000 % 6);
+    }
+}
+
+int ts_codec_benchmark(size_t samples) {
+    void* columns[TS_BENCH_CHANNELS] = {0};
+    void* decoded = malloc(TS_BENCH_BLOCK * 8);
+    uint8_t* encoded = malloc(TS_BENCH_BLOCK * 8);
+    size_t raw_total = 0, encoded_total = 0;
+    double encode_ns = 0, decode_ns = 0;
+    int status = decoded && encoded && samples ? 0 : -1;
+    
+    for (size_t c = 0; c < TS_BENCH_CHANNELS && status == 0; c++) {
+        columns[c] = malloc(samples * ts_type_size(bench_types[c]));
+        if (!columns[c]) status = -1;
+    }
+    if (status != 0) {
+        for (size_t c = 0; c < TS_BENCH_CHANNELS; c++) free(columns[c]);
+        free(decoded);
+        free(encoded);
+        return -1;
+    }
+    bench_fill(columns, samples);
+    
+    printf("Time-series codec: %zu samples, %d-row blocks\n", samples, TS_BENCH_BLOCK);
+    for (size_t c = 0; c < TS_BENCH_CHANNELS; c++) {
+        size_t value_size = ts_type_size(bench_types[c]);
+        size_t raw = 0, packed = 0;
+        uint8_t codec = TS_CODEC_RAW;
+    
+        for (size_t start = 0; start < samples; start += TS_BENCH_BLOCK) {
+            size_t count = samples - start < TS_BENCH_BLOCK ? samples - start : TS_BENCH_BLOCK;
+            const uint8_t* block = (const uint8_t*)columns[c] + start * value_size;
+            struct timespec t0, t1, t2;
+    
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            size_t size = ts_encode_block(block, count, bench_types[c], encoded,
+                                          count * value_size, &codec);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            if (codec == TS_CODEC_RAW) {
+                memcpy(encoded, block, count * value_size);
+                size = count * value_size;
+            }
+            int decoded_ok = ts_decode_block(codec, bench_types[c], encoded, size, decoded, count);
+            clock_gettime(CLOCK_MONOTONIC, &t2);
+    
+            if (decoded_ok != 0 || memcmp(decoded, block, count * value_size) != 0) {
+                printf("  %s: round trip FAILED at row %zu\n", bench_names[c], start);
+                status = -1;
+                break;
+            }
+            encode_ns += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+            decode_ns += (t2.tv_sec - t1.tv_sec) * 1e9 + (t2.tv_nsec - t1.tv_nsec);
+            raw += count * value_size;
+            packed += size;
+        }
+    
+        static const char* const codec_names[] = { "raw", "dod", "xor", "rle" };
+        printf("  %-10s %-3s %9zu -> %8zu bytes  %6.1fx\n", bench_names[c], codec_names[codec],
+               raw, packed, packed ? (double)raw / packed : 0.0);
+        raw_total += raw;
+        encoded_total += packed;
+    }
+    
+    double ratio = encoded_total ? (double)raw_total / encoded_total : 0.0;
+    printf("  total      %13zu -> %8zu bytes  %6.1fx\n", raw_total, encoded_total, ratio);
+    printf("  encode %.0f MB/s, decode %.0f MB/s\n",
+           encode_ns > 0 ? raw_total / encode_ns * 1e3 : 0.0,
+           decode_ns > 0 ? raw_total / decode_ns * 1e3 : 0.0);
+    
+    for (size_t c = 0; c < TS_BENCH_CHANNELS; c++) free(columns[c]);
+    free(decoded);
+    free(encoded);
+    return status;
+}
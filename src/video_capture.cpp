@@ -1,4 +1,5 @@
 #include "../include/device_adapter.h"
+#include "../include/timebase.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -58,7 +59,8 @@ int start_recording(const char* output_dir) {
     // out = cv2.VideoWriter(filename, fourcc, config.frame_rate,
     //                      (config.resolution_width, config.resolution_height))
     
-    state.start_timestamp = time(NULL) * 1000000ULL;
+    // Same timebase as the telemetry, so frames line up with samples
+    state.start_timestamp = timebase_now_us();
     state.is_recording = true;
     
     // Reset statistics